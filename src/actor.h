@@ -1390,10 +1390,39 @@ private:
 	IDNODE_t _entries[ static_cast<unsigned int>(( std::numeric_limits<unsigned short>::max )( )) + 1];
 	unsigned short _firstFreeID;
 
+	// [ZA] One bit per ID that is set while the ID is free, and one bit per
+	// word of _freeBits that is set while that word has any free ID left.
+	// getNewID finds the next free ID with two count-trailing-zero lookups
+	// instead of scanning _entries.
+	enum
+	{
+		NUM_FREEBITS_WORDS = ( static_cast<unsigned int>(( std::numeric_limits<unsigned short>::max )( )) + 1 ) / 64,
+		NUM_FREEWORDS_WORDS = NUM_FREEBITS_WORDS / 64,
+	};
+
+	QWORD _freeBits[NUM_FREEBITS_WORDS];
+	QWORD _freeWords[NUM_FREEWORDS_WORDS];
+
 	inline bool isIndexValid ( const unsigned short netID ) const
 	{
 		return ( netID > 0 );
 	}
+
+	inline void markFree ( const unsigned short netID )
+	{
+		_freeBits[netID >> 6] |= UCONST64(1) << ( netID & 63 );
+		_freeWords[netID >> 12] |= UCONST64(1) << (( netID >> 6 ) & 63 );
+	}
+
+	inline void markUsed ( const unsigned short netID )
+	{
+		_freeBits[netID >> 6] &= ~( UCONST64(1) << ( netID & 63 ));
+		if ( _freeBits[netID >> 6] == 0 )
+			_freeWords[netID >> 12] &= ~( UCONST64(1) << (( netID >> 6 ) & 63 ));
+	}
+
+	int findFreeID ( const unsigned int start ) const;
+
 public:
 	void clear ( );
 
@@ -1413,6 +1442,7 @@ public:
 		{
 			_entries[netID].bFree = true;
 			_entries[netID].pActor = NULL;
+			markFree ( netID );
 		}
 	}
 
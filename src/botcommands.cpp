@@ -75,6 +75,8 @@
 #include "team.h"
 #include "v_text.h"
 #include "p_acs.h"
+// [ZA] New #includes.
+#include "botitems.h"
 
 //*****************************************************************************
 //	PROTOTYPES
@@ -915,8 +917,8 @@ static void botcmd_StringsAreEqual( CSkullBot *pBot )
 
 //*****************************************************************************
 // [BB] Helperfunction to reduce code duplication.
-template <typename T>
-int botcmd_LookForItemType( CSkullBot *pBot, const char *FunctionName )
+// [ZA] The items come from the bot item index instead of walking every netID.
+int botcmd_LookForItem( CSkullBot *pBot, const ULONG ulCategory, const char *FunctionName )
 {
 	bool visibilityCheck = !!pBot->m_ScriptData.alStack[pBot->m_ScriptData.lStackPosition - 1];
 	pBot->PopStack( );
@@ -926,89 +928,56 @@ int botcmd_LookForItemType( CSkullBot *pBot, const char *FunctionName )
 
 	botcmd_ValidateItemNetID( netID, FunctionName );
 
-	while (( BOTCMD_IgnoreItem( pBot, netID, visibilityCheck )) ||
-		( g_ActorNetIDList.findPointerByID( netID )->GetClass( )->IsDescendantOf( RUNTIME_CLASS( T )) == false ))
-	{
-		if ( netID == ( std::numeric_limits<unsigned short>::max )( ))
-			return -1;
-
-		netID++;
-	}
-
-	return netID;
+	return BOTITEMS_FindItem( pBot, ulCategory, netID, visibilityCheck );
 }
 
 //*****************************************************************************
 //
 static void botcmd_LookForPowerups( CSkullBot *pBot )
 {
-	g_iReturnInt = botcmd_LookForItemType<APowerupGiver> ( pBot, "botcmd_LookForPowerups" );
+	g_iReturnInt = botcmd_LookForItem ( pBot, BOTITEM_POWERUP, "botcmd_LookForPowerups" );
 }
 
 //*****************************************************************************
 //
 static void botcmd_LookForWeapons( CSkullBot *pBot )
 {
-	g_iReturnInt = botcmd_LookForItemType<AWeapon> ( pBot, "botcmd_LookForWeapons" );
+	g_iReturnInt = botcmd_LookForItem ( pBot, BOTITEM_WEAPON, "botcmd_LookForWeapons" );
 }
 
 //*****************************************************************************
 //
 static void botcmd_LookForAmmo( CSkullBot *pBot )
 {
-	g_iReturnInt = botcmd_LookForItemType<AAmmo> ( pBot, "botcmd_LookForAmmo" );
-}
-
-//*****************************************************************************
-// [BB] Helperfunction to reduce code duplication.
-int botcmd_LookForItemWithFlag( CSkullBot *pBot, const int Flag, const char *FunctionName )
-{
-	bool visibilityCheck = !!pBot->m_ScriptData.alStack[pBot->m_ScriptData.lStackPosition - 1];
-	pBot->PopStack( );
-
-	unsigned short netID = static_cast<unsigned short>( pBot->m_ScriptData.alStack[pBot->m_ScriptData.lStackPosition - 1] );
-	pBot->PopStack( );
-
-	botcmd_ValidateItemNetID( netID, FunctionName );
-
-	while (( BOTCMD_IgnoreItem( pBot, netID, visibilityCheck )) ||
-		(( g_ActorNetIDList.findPointerByID( netID )->STFlags & Flag ) == false ))
-	{
-		if ( netID == ( std::numeric_limits<unsigned short>::max )( ))
-			return -1;
-
-		netID++;
-	}
-
-	return netID;
+	g_iReturnInt = botcmd_LookForItem ( pBot, BOTITEM_AMMO, "botcmd_LookForAmmo" );
 }
 
 //*****************************************************************************
 //
 static void botcmd_LookForBaseHealth( CSkullBot *pBot )
 {
-	g_iReturnInt = botcmd_LookForItemWithFlag ( pBot, STFL_BASEHEALTH, "botcmd_LookForBaseHealth" );
+	g_iReturnInt = botcmd_LookForItem ( pBot, BOTITEM_BASEHEALTH, "botcmd_LookForBaseHealth" );
 }
 
 //*****************************************************************************
 //
 static void botcmd_LookForBaseArmor( CSkullBot *pBot )
 {
-	g_iReturnInt = botcmd_LookForItemWithFlag ( pBot, STFL_BASEARMOR, "botcmd_LookForBaseArmor" );
+	g_iReturnInt = botcmd_LookForItem ( pBot, BOTITEM_BASEARMOR, "botcmd_LookForBaseArmor" );
 }
 
 //*****************************************************************************
 //
 static void botcmd_LookForSuperHealth( CSkullBot *pBot )
 {
-	g_iReturnInt = botcmd_LookForItemWithFlag ( pBot, STFL_SUPERHEALTH, "botcmd_LookForSuperHealth" );
+	g_iReturnInt = botcmd_LookForItem ( pBot, BOTITEM_SUPERHEALTH, "botcmd_LookForSuperHealth" );
 }
 
 //*****************************************************************************
 //
 static void botcmd_LookForSuperArmor( CSkullBot *pBot )
 {
-	g_iReturnInt = botcmd_LookForItemWithFlag ( pBot, STFL_SUPERARMOR, "botcmd_LookForSuperArmor" );
+	g_iReturnInt = botcmd_LookForItem ( pBot, BOTITEM_SUPERARMOR, "botcmd_LookForSuperArmor" );
 }
 
 //*****************************************************************************
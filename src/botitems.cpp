@@ -0,0 +1,390 @@
+//-----------------------------------------------------------------------------
+//
+// Zandronum Source
+// Copyright (C) 2026 Zandronum Development Team
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 3. Neither the name of the Zandronum Development Team nor the names of its
+//    contributors may be used to endorse or promote products derived from this
+//    software without specific prior written permission.
+// 4. Redistributions in any form must be accompanied by information on how to
+//    obtain complete source code for the software and any accompanying
+//    software that uses the software. The source code must either be included
+//    in the distribution or be available for no more than the cost of
+//    distribution plus a nominal fee, and must be freely redistributable
+//    under reasonable conditions. For an executable file, complete source
+//    code means the source code for all modules it contains. It does not
+//    include source code for modules or files that typically accompany the
+//    major components of the operating system on which the executable file
+//    runs.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+//
+// Filename: botitems.cpp
+//
+// Description: Index of pickup items, bucketed by category and position, for the bot item searches.
+//
+//-----------------------------------------------------------------------------
+
+
+#include <algorithm>
+#include <math.h>
+#include "a_artifacts.h"
+#include "a_pickups.h"
+#include "actor.h"
+#include "botcommands.h"
+#include "botitems.h"
+#include "bots.h"
+#include "c_cvars.h"
+#include "dthinker.h"
+#include "g_level.h"
+#include "m_fixed.h"
+#include "templates.h"
+
+//*****************************************************************************
+//	DEFINES
+
+// Items are bucketed into cells of (1 << BOTITEMS_CELLSHIFT) map units. The
+// shift grows on huge maps so the grid never exceeds BOTITEMS_MAXCELLS.
+#define	BOTITEMS_CELLSHIFT			( FRACBITS + 9 )
+#define	BOTITEMS_MAXCELLS			4096
+
+//*****************************************************************************
+//	STRUCTURES
+
+typedef struct
+{
+	fixed_t			X;
+	fixed_t			Y;
+	ULONG			ulCategories;
+	unsigned short	NetID;
+
+} BOTITEM_t;
+
+typedef struct
+{
+	double			Distance;
+	unsigned short	NetID;
+
+} BOTITEMCANDIDATE_t;
+
+//*****************************************************************************
+//	VARIABLES
+
+// Every special actor with a netID, sorted by netID.
+static	TArray<BOTITEM_t>			g_Items;
+
+// Indices into g_Items, grouped by cell. Cell i owns the range
+// [g_CellStart[i], g_CellStart[i+1]).
+static	TArray<WORD>				g_CellItems;
+static	TArray<unsigned int>		g_CellStart;
+
+static	fixed_t						g_GridOriginX;
+static	fixed_t						g_GridOriginY;
+static	int							g_lGridWidth;
+static	int							g_lGridHeight;
+static	int							g_lCellShift;
+
+static	TArray<BOTITEMCANDIDATE_t>	g_Candidates;
+static	bool						g_bIndexValid = false;
+
+//*****************************************************************************
+//	CONSOLE VARIABLES
+
+// [ZA] When enabled, the LookFor* bot commands return the closest matching
+// item whose netID is at least the given start netID. Otherwise they return
+// the lowest such netID, as they always did. This is off by default, since
+// bot scripts that walk the items by passing the last result + 1 would skip
+// every item with a lower netID than the closest one.
+CVAR( Bool, bot_nearestitems, false, CVAR_ARCHIVE )
+
+//*****************************************************************************
+//	PROTOTYPES
+
+static	bool	botitems_CompareNetIDs( const BOTITEM_t &A, const BOTITEM_t &B );
+static	bool	botitems_CompareDistances( const BOTITEMCANDIDATE_t &A, const BOTITEMCANDIDATE_t &B );
+static	void	botitems_Rebuild( void );
+static	ULONG	botitems_GetCategories( AActor *pActor );
+static	int		botitems_FindLowestNetID( CSkullBot *pBot, ULONG ulCategory, unsigned short startNetID, bool bVisibilityCheck );
+static	int		botitems_FindNearest( CSkullBot *pBot, ULONG ulCategory, unsigned short startNetID, bool bVisibilityCheck );
+
+//*****************************************************************************
+//	FUNCTIONS
+
+void BOTITEMS_Invalidate( void )
+{
+	g_bIndexValid = false;
+}
+
+//*****************************************************************************
+//
+int BOTITEMS_FindItem( CSkullBot *pBot, ULONG ulCategory, unsigned short startNetID, bool bVisibilityCheck )
+{
+	if ( g_bIndexValid == false )
+		botitems_Rebuild( );
+
+	if ( bot_nearestitems && ( pBot->GetPlayer( )->mo != NULL ))
+		return ( botitems_FindNearest( pBot, ulCategory, startNetID, bVisibilityCheck ));
+
+	return ( botitems_FindLowestNetID( pBot, ulCategory, startNetID, bVisibilityCheck ));
+}
+
+//*****************************************************************************
+//*****************************************************************************
+//
+static bool botitems_CompareNetIDs( const BOTITEM_t &A, const BOTITEM_t &B )
+{
+	return ( A.NetID < B.NetID );
+}
+
+//*****************************************************************************
+//
+static bool botitems_CompareDistances( const BOTITEMCANDIDATE_t &A, const BOTITEMCANDIDATE_t &B )
+{
+	if ( A.Distance != B.Distance )
+		return ( A.Distance < B.Distance );
+
+	return ( A.NetID < B.NetID );
+}
+
+//*****************************************************************************
+//
+static ULONG botitems_GetCategories( AActor *pActor )
+{
+	ULONG	ulCategories = 0;
+
+	if ( pActor->IsKindOf( RUNTIME_CLASS( APowerupGiver )))
+		ulCategories |= BOTITEM_POWERUP;
+	if ( pActor->IsKindOf( RUNTIME_CLASS( AWeapon )))
+		ulCategories |= BOTITEM_WEAPON;
+	if ( pActor->IsKindOf( RUNTIME_CLASS( AAmmo )))
+		ulCategories |= BOTITEM_AMMO;
+	if ( pActor->STFlags & STFL_BASEHEALTH )
+		ulCategories |= BOTITEM_BASEHEALTH;
+	if ( pActor->STFlags & STFL_BASEARMOR )
+		ulCategories |= BOTITEM_BASEARMOR;
+	if ( pActor->STFlags & STFL_SUPERHEALTH )
+		ulCategories |= BOTITEM_SUPERHEALTH;
+	if ( pActor->STFlags & STFL_SUPERARMOR )
+		ulCategories |= BOTITEM_SUPERARMOR;
+
+	return ( ulCategories );
+}
+
+//*****************************************************************************
+//
+static void botitems_Rebuild( void )
+{
+	TThinkerIterator<AActor>	Iterator;
+	AActor						*pActor;
+	fixed_t						MinX = FIXED_MAX, MinY = FIXED_MAX;
+	fixed_t						MaxX = FIXED_MIN, MaxY = FIXED_MIN;
+
+	g_Items.Clear( );
+	g_bIndexValid = true;
+
+	// Collect everything a LookFor* command could ever return. The items are
+	// validated again when they are queried, so anything that is picked up or
+	// destroyed before the next rebuild is simply skipped.
+	while (( pActor = Iterator.Next( )) != NULL )
+	{
+		if (( pActor->NetID == 0 ) || (( pActor->flags & MF_SPECIAL ) == false ))
+			continue;
+
+		const ULONG ulCategories = botitems_GetCategories( pActor );
+		if ( ulCategories == 0 )
+			continue;
+
+		BOTITEM_t	Item;
+
+		Item.X = pActor->x;
+		Item.Y = pActor->y;
+		Item.ulCategories = ulCategories;
+		Item.NetID = pActor->NetID;
+		g_Items.Push( Item );
+
+		MinX = MIN( MinX, pActor->x );
+		MinY = MIN( MinY, pActor->y );
+		MaxX = MAX( MaxX, pActor->x );
+		MaxY = MAX( MaxY, pActor->y );
+	}
+
+	if ( g_Items.Size( ) > 1 )
+	{
+		std::sort( &g_Items[0], &g_Items[0] + g_Items.Size( ),
+			botitems_CompareNetIDs );
+	}
+
+	g_CellItems.Resize( g_Items.Size( ));
+	g_CellStart.Clear( );
+	g_lGridWidth = g_lGridHeight = 0;
+
+	if ( g_Items.Size( ) == 0 )
+		return;
+
+	// Size the grid to the bounding box of the items.
+	const SQWORD SpanX = static_cast<SQWORD>( MaxX ) - MinX;
+	const SQWORD SpanY = static_cast<SQWORD>( MaxY ) - MinY;
+
+	g_GridOriginX = MinX;
+	g_GridOriginY = MinY;
+	g_lCellShift = BOTITEMS_CELLSHIFT;
+	while ((( SpanX >> g_lCellShift ) + 1 ) * (( SpanY >> g_lCellShift ) + 1 ) > BOTITEMS_MAXCELLS )
+		g_lCellShift++;
+
+	g_lGridWidth = static_cast<int>( SpanX >> g_lCellShift ) + 1;
+	g_lGridHeight = static_cast<int>( SpanY >> g_lCellShift ) + 1;
+
+	// Counting sort of the items into their cells. Every cell keeps its items
+	// in netID order.
+	const unsigned int ulNumCells = g_lGridWidth * g_lGridHeight;
+	TArray<unsigned int> Cells( g_Items.Size( ));
+
+	g_CellStart.Resize( ulNumCells + 1 );
+	memset( &g_CellStart[0], 0, sizeof( unsigned int ) * ( ulNumCells + 1 ));
+
+	for ( unsigned int i = 0; i < g_Items.Size( ); i++ )
+	{
+		const unsigned int ulCellX = static_cast<unsigned int>(( static_cast<SQWORD>( g_Items[i].X ) - MinX ) >> g_lCellShift );
+		const unsigned int ulCellY = static_cast<unsigned int>(( static_cast<SQWORD>( g_Items[i].Y ) - MinY ) >> g_lCellShift );
+
+		Cells.Push( ulCellY * g_lGridWidth + ulCellX );
+		g_CellStart[Cells[i] + 1]++;
+	}
+
+	for ( unsigned int i = 0; i < ulNumCells; i++ )
+		g_CellStart[i + 1] += g_CellStart[i];
+
+	TArray<unsigned int> Fill( ulNumCells );
+	Fill.Resize( ulNumCells );
+	memcpy( &Fill[0], &g_CellStart[0], sizeof( unsigned int ) * ulNumCells );
+
+	for ( unsigned int i = 0; i < g_Items.Size( ); i++ )
+		g_CellItems[Fill[Cells[i]]++] = static_cast<WORD>( i );
+}
+
+//*****************************************************************************
+//
+static int botitems_FindLowestNetID( CSkullBot *pBot, ULONG ulCategory, unsigned short startNetID, bool bVisibilityCheck )
+{
+	// Binary search for the first item at or past the start netID.
+	unsigned int ulLow = 0;
+	unsigned int ulHigh = g_Items.Size( );
+
+	while ( ulLow < ulHigh )
+	{
+		const unsigned int ulMid = ( ulLow + ulHigh ) / 2;
+
+		if ( g_Items[ulMid].NetID < startNetID )
+			ulLow = ulMid + 1;
+		else
+			ulHigh = ulMid;
+	}
+
+	for ( unsigned int i = ulLow; i < g_Items.Size( ); i++ )
+	{
+		if ((( g_Items[i].ulCategories & ulCategory ) != 0 ) &&
+			( BOTCMD_IgnoreItem( pBot, g_Items[i].NetID, bVisibilityCheck ) == false ))
+		{
+			return ( g_Items[i].NetID );
+		}
+	}
+
+	return ( -1 );
+}
+
+//*****************************************************************************
+//
+static int botitems_FindNearest( CSkullBot *pBot, ULONG ulCategory, unsigned short startNetID, bool bVisibilityCheck )
+{
+	if ( g_Items.Size( ) == 0 )
+		return ( -1 );
+
+	const AActor	*pMo = pBot->GetPlayer( )->mo;
+	const double	BotX = static_cast<double>( pMo->x );
+	const double	BotY = static_cast<double>( pMo->y );
+	const double	CellSize = ldexp( 1.0, g_lCellShift );
+	unsigned int	ulNext = 0;
+
+	// Start from the cell the bot is in, clamped to the grid.
+	const int lCenterX = static_cast<int>( clamp<SQWORD>(( static_cast<SQWORD>( pMo->x ) - g_GridOriginX ) >> g_lCellShift, 0, g_lGridWidth - 1 ));
+	const int lCenterY = static_cast<int>( clamp<SQWORD>(( static_cast<SQWORD>( pMo->y ) - g_GridOriginY ) >> g_lCellShift, 0, g_lGridHeight - 1 ));
+	const int lMaxRing = MAX( MAX( lCenterX, g_lGridWidth - 1 - lCenterX ), MAX( lCenterY, g_lGridHeight - 1 - lCenterY ));
+
+	g_Candidates.Clear( );
+
+	// Walk rings of cells outwards. Everything outside of ring N is at least
+	// N cells away, so candidates closer than that can be tested (and the
+	// expensive visibility checks run) before the outer rings are touched.
+	for ( int lRing = 0; lRing <= lMaxRing; lRing++ )
+	{
+		const int lMinX = lCenterX - lRing, lMaxX = lCenterX + lRing;
+		const int lMinY = lCenterY - lRing, lMaxY = lCenterY + lRing;
+
+		for ( int lY = MAX( lMinY, 0 ); lY <= MIN( lMaxY, g_lGridHeight - 1 ); lY++ )
+		{
+			// Only the edge cells of the ring are new, inner rows just need
+			// their two sides.
+			const bool bFullRow = ( lY == lMinY ) || ( lY == lMaxY );
+			const int lStep = bFullRow ? 1 : MAX( lMaxX - lMinX, 1 );
+
+			for ( int lX = lMinX; lX <= lMaxX; lX += lStep )
+			{
+				if (( lX < 0 ) || ( lX >= g_lGridWidth ))
+					continue;
+
+				const unsigned int ulCell = lY * g_lGridWidth + lX;
+
+				for ( unsigned int i = g_CellStart[ulCell]; i < g_CellStart[ulCell + 1]; i++ )
+				{
+					const BOTITEM_t &Item = g_Items[g_CellItems[i]];
+
+					if ((( Item.ulCategories & ulCategory ) == 0 ) || ( Item.NetID < startNetID ))
+						continue;
+
+					BOTITEMCANDIDATE_t	Candidate;
+					const double		DeltaX = Item.X - BotX;
+					const double		DeltaY = Item.Y - BotY;
+
+					Candidate.Distance = DeltaX * DeltaX + DeltaY * DeltaY;
+					Candidate.NetID = Item.NetID;
+					g_Candidates.Push( Candidate );
+				}
+			}
+		}
+
+		if ( ulNext == g_Candidates.Size( ))
+			continue;
+
+		std::sort( &g_Candidates[0] + ulNext, &g_Candidates[0] + g_Candidates.Size( ), botitems_CompareDistances );
+
+		const double Bound = ( lRing < lMaxRing ) ? ( lRing * CellSize ) * ( lRing * CellSize ) : HUGE_VAL;
+
+		for ( ; ( ulNext < g_Candidates.Size( )) && ( g_Candidates[ulNext].Distance <= Bound ); ulNext++ )
+		{
+			if ( BOTCMD_IgnoreItem( pBot, g_Candidates[ulNext].NetID, bVisibilityCheck ) == false )
+				return ( g_Candidates[ulNext].NetID );
+		}
+	}
+
+	return ( -1 );
+}
@@ -91,6 +91,8 @@
 #include "doomerrors.h"
 #include "chat.h"
 #include "scoreboard.h"
+// [ZA] New #includes.
+#include "botitems.h"
 
 //*****************************************************************************
 //	VARIABLES
@@ -410,6 +412,9 @@ void BOTS_Tick( void )
 {
 	ULONG	ulIdx;
 
+	// [ZA] Items may have moved, been picked up or spawned since the last tic.
+	BOTITEMS_Invalidate( );
+
 	// First, handle any bots waiting to be spawned in skirmish games.
 	for ( ulIdx = 0; ulIdx < MAXPLAYERS; ulIdx++ )
 	{
@@ -79,6 +79,8 @@
 #include "st_hud.h"
 #include "r_utility.h"
 #include "p_tick.h"
+// [ZA] New #includes.
+#include <mutex>
 
 #define CONSOLESIZE	16384	// Number of characters to store in console
 #define CONSOLELINES 256	// Max number of lines of console text
@@ -1042,6 +1044,10 @@ int PrintString (int printlevel, const char *outline)
 		return 0;
 	}
 
+	// [ZA] The texture precache can print from its worker threads.
+	static std::recursive_mutex PrintLock;
+	std::lock_guard<std::recursive_mutex> lock (PrintLock);
+
 	// [TP] Possibly capture it instead
 	if ( C_IsCapturing() )
 	{
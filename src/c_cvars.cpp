@@ -89,6 +89,9 @@ bool FBaseCVar::m_UseCallback = false;
 
 FBaseCVar *CVars = NULL;
 
+// [ZA]
+FBaseCVar *FBaseCVar::m_HashTable[FBaseCVar::HASH_SIZE];
+
 int cvar_defflags;
 
 // [AK] Prevents CVars changed by ConsoleCommand from being written into the user's config file.
@@ -126,6 +129,7 @@ FBaseCVar::FBaseCVar (const char *var_name, DWORD flags, void (*callback)(FBaseC
 		Name = copystring (var_name);
 		m_Next = CVars;
 		CVars = this;
+		LinkIntoHash ();
 	}
 
 	if (var)
@@ -164,6 +168,7 @@ FBaseCVar::~FBaseCVar ()
 			else
 				CVars = m_Next;
 		}
+		UnlinkFromHash ();
 		C_RemoveTabCommand(Name);
 		delete[] Name;
 	}
@@ -1613,16 +1618,74 @@ void C_ForgetCVars (void)
 	CVarBackups.Clear();
 }
 
+//===========================================================================
+//
+// [ZA] FBaseCVar :: HashName
+//
+// Case-insensitive, like the name comparisons.
+//
+//===========================================================================
+
+unsigned int FBaseCVar::HashName (const char *name, size_t namelen)
+{
+	return MakeKey (name, namelen) % HASH_SIZE;
+}
+
+//===========================================================================
+//
+// [ZA] FBaseCVar :: LinkIntoHash
+//
+// The newest cvar goes to the front of its chain, so a lookup finds the
+// same cvar a walk of the CVars list would.
+//
+//===========================================================================
+
+void FBaseCVar::LinkIntoHash ()
+{
+	const unsigned int bucket = HashName (Name, strlen (Name));
+
+	m_HashNext = m_HashTable[bucket];
+	m_HashTable[bucket] = this;
+}
+
+//===========================================================================
+//
+// [ZA] FBaseCVar :: UnlinkFromHash
+//
+//===========================================================================
+
+void FBaseCVar::UnlinkFromHash ()
+{
+	FBaseCVar **link = &m_HashTable[HashName (Name, strlen (Name))];
+
+	while (*link != NULL)
+	{
+		if (*link == this)
+		{
+			*link = m_HashNext;
+			break;
+		}
+		link = &(*link)->m_HashNext;
+	}
+}
+
 FBaseCVar *FindCVar (const char *var_name, FBaseCVar **prev)
 {
 	FBaseCVar *var;
-	FBaseCVar *dummy;
 
 	if (var_name == NULL)
 		return NULL;
 
+	// [ZA] Only the callers that unlink the cvar need the list walk.
 	if (prev == NULL)
-		prev = &dummy;
+	{
+		for (var = FBaseCVar::m_HashTable[FBaseCVar::HashName (var_name, strlen (var_name))]; var != NULL; var = var->m_HashNext)
+		{
+			if (stricmp (var->GetName (), var_name) == 0)
+				break;
+		}
+		return var;
+	}
 
 	var = CVars;
 	*prev = NULL;
@@ -1643,7 +1706,8 @@ FBaseCVar *FindCVarSub (const char *var_name, int namelen)
 	if (var_name == NULL)
 		return NULL;
 
-	var = CVars;
+	// [ZA] Walk the hash chain instead of the whole list.
+	var = FBaseCVar::m_HashTable[FBaseCVar::HashName (var_name, namelen)];
 	while (var)
 	{
 		const char *probename = var->GetName ();
@@ -1653,7 +1717,7 @@ FBaseCVar *FindCVarSub (const char *var_name, int namelen)
 		{
 			break;
 		}
-		var = var->m_Next;
+		var = var->m_HashNext;
 	}
 	return var;
 }
@@ -181,6 +181,17 @@ private:
 	void (*m_Callback)(FBaseCVar &);
 	FBaseCVar *m_Next;
 
+	// [ZA] Cvars are also chained into a hash table by name, so FindCVar
+	// does not have to walk the whole list. The table is plain zeroed
+	// storage, because cvars register themselves during static init.
+	enum { HASH_SIZE = 1021 };
+	FBaseCVar *m_HashNext;
+	static FBaseCVar *m_HashTable[HASH_SIZE];
+
+	void LinkIntoHash ();
+	void UnlinkFromHash ();
+	static unsigned int HashName (const char *name, size_t namelen);
+
 	static bool m_UseCallback;
 	static bool m_DoNoSet;
 
@@ -0,0 +1,409 @@
+//-----------------------------------------------------------------------------
+//
+// Zandronum Source
+// Copyright (C) 2026 Zandronum Development Team
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 3. Neither the name of the Zandronum Development Team nor the names of its
+//    contributors may be used to endorse or promote products derived from this
+//    software without specific prior written permission.
+// 4. Redistributions in any form must be accompanied by information on how to
+//    obtain complete source code for the software and any accompanying
+//    software that uses the software. The source code must either be included
+//    in the distribution or be available for no more than the cost of
+//    distribution plus a nominal fee, and must be freely redistributable
+//    under reasonable conditions. For an executable file, complete source
+//    code means the source code for all modules it contains. It does not
+//    include source code for modules or files that typically accompany the
+//    major components of the operating system on which the executable file
+//    runs.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+//
+// Filename: chunkfile.cpp
+//
+// Description: Files made of independently compressed chunks, written on a background thread.
+//
+//-----------------------------------------------------------------------------
+
+#include <zlib.h>
+#include "LzmaDec.h"
+#include "LzmaEnc.h"
+#include "chunkfile.h"
+#include "files.h"
+
+extern ISzAlloc g_Alloc;
+
+//*****************************************************************************
+//	VARIABLES
+
+// Size of the header in front of every chunk: compression, packed and unpacked size.
+static	const long		CHUNK_HEADER_SIZE = 9;
+
+// How much data may be waiting for the writer thread before the producer has to wait.
+static	const size_t	MAX_PENDING_BYTES = 16 << 20;
+
+//*****************************************************************************
+//	FUNCTIONS
+
+static void chunkfile_WriteLong( BYTE *pbBuffer, DWORD ulValue )
+{
+	pbBuffer[0] = static_cast<BYTE>( ulValue );
+	pbBuffer[1] = static_cast<BYTE>( ulValue >> 8 );
+	pbBuffer[2] = static_cast<BYTE>( ulValue >> 16 );
+	pbBuffer[3] = static_cast<BYTE>( ulValue >> 24 );
+}
+
+//*****************************************************************************
+//
+static DWORD chunkfile_ReadLong( const BYTE *pbBuffer )
+{
+	return pbBuffer[0] | ( pbBuffer[1] << 8 ) | ( pbBuffer[2] << 16 ) | ( static_cast<DWORD>( pbBuffer[3] ) << 24 );
+}
+
+//*****************************************************************************
+//*****************************************************************************
+//
+FChunkWriter::FChunkWriter ()
+	: File (NULL), Failed (false), Quit (false), PendingBytes (0)
+{
+}
+
+//*****************************************************************************
+//
+FChunkWriter::~FChunkWriter ()
+{
+	Close ();
+}
+
+//*****************************************************************************
+//
+bool FChunkWriter::Open (const char *filename)
+{
+	Close ();
+
+	File = fopen (filename, "wb");
+	if (File == NULL)
+		return false;
+
+	Failed = false;
+	Quit = false;
+	PendingBytes = 0;
+	Thread = std::thread (&FChunkWriter::Run, this);
+	return true;
+}
+
+//*****************************************************************************
+//
+// Waits until everything that was queued is on the disk and closes the file.
+//
+void FChunkWriter::Close ()
+{
+	if (File == NULL)
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock (Mutex);
+		Quit = true;
+	}
+	WakeWriter.notify_one ();
+	Thread.join ();
+
+	if (fclose (File) != 0)
+		Failed = true;
+
+	File = NULL;
+}
+
+//*****************************************************************************
+//
+void FChunkWriter::WriteRaw (const void *data, unsigned int size)
+{
+	Enqueue (data, size, CHUNK_STORED, true);
+}
+
+//*****************************************************************************
+//
+void FChunkWriter::WriteChunk (const void *data, unsigned int size, EChunkCompression compression)
+{
+	Enqueue (data, size, compression, false);
+}
+
+//*****************************************************************************
+//
+void FChunkWriter::Enqueue (const void *data, unsigned int size, EChunkCompression compression, bool raw)
+{
+	if (File == NULL)
+		return;
+
+	Job *job = new Job;
+	job->Compression = compression;
+	job->Raw = raw;
+	job->Data.Resize (size);
+	if (size > 0)
+		memcpy (&job->Data[0], data, size);
+
+	std::unique_lock<std::mutex> lock (Mutex);
+	WakeProducer.wait (lock, [this] { return PendingBytes < MAX_PENDING_BYTES; });
+	PendingBytes += size;
+	Queue.push_back (job);
+	lock.unlock ();
+
+	WakeWriter.notify_one ();
+}
+
+//*****************************************************************************
+//
+// The writer thread. It keeps going until it's told to quit and has written
+// everything that's still queued.
+//
+void FChunkWriter::Run ()
+{
+	std::unique_lock<std::mutex> lock (Mutex);
+
+	while (true)
+	{
+		WakeWriter.wait (lock, [this] { return Quit || !Queue.empty (); });
+
+		if (Queue.empty ())
+			break;
+
+		Job *job = Queue.front ();
+		Queue.pop_front ();
+		lock.unlock ();
+
+		const size_t size = job->Data.Size ();
+		WriteJob (*job);
+		delete job;
+
+		lock.lock ();
+		PendingBytes -= size;
+		WakeProducer.notify_one ();
+	}
+}
+
+//*****************************************************************************
+//
+void FChunkWriter::WriteJob (Job &job)
+{
+	const unsigned int unpackedSize = job.Data.Size ();
+	const BYTE *data = unpackedSize > 0 ? &job.Data[0] : NULL;
+
+	if (job.Raw)
+	{
+		if (unpackedSize > 0 && fwrite (data, unpackedSize, 1, File) != 1)
+			Failed = true;
+		return;
+	}
+
+	TArray<BYTE> packed;
+	BYTE compression = static_cast<BYTE> (job.Compression);
+	unsigned int packedSize = 0;
+
+	switch (job.Compression)
+	{
+	case CHUNK_ZLIB:
+		{
+			uLongf length = compressBound (unpackedSize);
+			packed.Resize (length);
+			if (compress2 (&packed[0], &length, data, unpackedSize, Z_BEST_SPEED) == Z_OK)
+				packedSize = length;
+		}
+		break;
+
+	case CHUNK_LZMA:
+		{
+			CLzmaEncProps props;
+			LzmaEncProps_Init (&props);
+			props.level = 5;
+			// Nothing is ever matched across chunks, so a larger dictionary would only waste memory.
+			props.dictSize = unpackedSize > (1 << 12) ? unpackedSize : (1 << 12);
+
+			packed.Resize (LZMA_PROPS_SIZE + unpackedSize + unpackedSize / 3 + 128);
+			SizeT length = packed.Size () - LZMA_PROPS_SIZE;
+			SizeT propsSize = LZMA_PROPS_SIZE;
+			if (LzmaEncode (&packed[LZMA_PROPS_SIZE], &length, data, unpackedSize, &props, &packed[0], &propsSize, 0, NULL, &g_Alloc, &g_Alloc) == SZ_OK
+				&& propsSize == LZMA_PROPS_SIZE)
+			{
+				packedSize = static_cast<unsigned int> (LZMA_PROPS_SIZE + length);
+			}
+		}
+		break;
+
+	default:
+		break;
+	}
+
+	// Store the data as it is if it couldn't be compressed.
+	if (packedSize == 0 || packedSize >= unpackedSize)
+	{
+		if (compression != CHUNK_TRAILER)
+			compression = CHUNK_STORED;
+
+		packedSize = unpackedSize;
+	}
+	else
+	{
+		data = &packed[0];
+	}
+
+	BYTE header[CHUNK_HEADER_SIZE];
+	header[0] = compression;
+	chunkfile_WriteLong (header + 1, packedSize);
+	chunkfile_WriteLong (header + 5, unpackedSize);
+
+	if (fwrite (header, CHUNK_HEADER_SIZE, 1, File) != 1)
+		Failed = true;
+	else if (packedSize > 0 && fwrite (data, packedSize, 1, File) != 1)
+		Failed = true;
+
+	// Everything that's written should survive a crash of the game.
+	fflush (File);
+}
+
+//*****************************************************************************
+//*****************************************************************************
+//
+FChunkReader::FChunkReader (FileReader *file, long dataStart)
+	: File (file), Complete (true)
+{
+	const long length = File->GetLength ();
+	long position = dataStart;
+	DWORD streamOffset = 0;
+
+	while (position < length)
+	{
+		BYTE header[CHUNK_HEADER_SIZE];
+
+		File->Seek (position, SEEK_SET);
+		if (length - position < CHUNK_HEADER_SIZE || File->Read (header, CHUNK_HEADER_SIZE) != CHUNK_HEADER_SIZE)
+		{
+			Complete = false;
+			break;
+		}
+
+		Chunk chunk;
+		chunk.FileOffset = position + CHUNK_HEADER_SIZE;
+		chunk.Compression = header[0];
+		chunk.PackedSize = chunkfile_ReadLong (header + 1);
+		chunk.UnpackedSize = chunkfile_ReadLong (header + 5);
+		chunk.StreamOffset = streamOffset;
+
+		if (chunk.PackedSize > static_cast<DWORD> (length - chunk.FileOffset))
+		{
+			Complete = false;
+			break;
+		}
+
+		if (chunk.Compression == CHUNK_TRAILER)
+		{
+			Trailer.Resize (chunk.PackedSize);
+			if (chunk.PackedSize > 0 && File->Read (&Trailer[0], chunk.PackedSize) != static_cast<long> (chunk.PackedSize))
+				Trailer.Clear ();
+			break;
+		}
+
+		if (chunk.Compression >= NUM_CHUNK_COMPRESSIONS)
+		{
+			Complete = false;
+			break;
+		}
+
+		Chunks.Push (chunk);
+		streamOffset += chunk.UnpackedSize;
+		position = chunk.FileOffset + chunk.PackedSize;
+	}
+}
+
+//*****************************************************************************
+//
+FChunkReader::~FChunkReader ()
+{
+	delete File;
+}
+
+//*****************************************************************************
+//
+int FChunkReader::FindChunk (DWORD streamOffset) const
+{
+	int min = 0;
+	int max = static_cast<int> (Chunks.Size ()) - 1;
+
+	while (min <= max)
+	{
+		const int mid = (min + max) / 2;
+
+		if (streamOffset < Chunks[mid].StreamOffset)
+			max = mid - 1;
+		else if (streamOffset >= Chunks[mid].StreamOffset + Chunks[mid].UnpackedSize)
+			min = mid + 1;
+		else
+			return mid;
+	}
+
+	return -1;
+}
+
+//*****************************************************************************
+//
+// Reads and decompresses a chunk. The buffer must be ChunkSize() bytes large.
+//
+bool FChunkReader::ReadChunk (unsigned int index, BYTE *buffer)
+{
+	if (index >= Chunks.Size ())
+		return false;
+
+	const Chunk &chunk = Chunks[index];
+	File->Seek (chunk.FileOffset, SEEK_SET);
+
+	if (chunk.Compression == CHUNK_STORED)
+		return File->Read (buffer, chunk.UnpackedSize) == static_cast<long> (chunk.UnpackedSize);
+
+	TArray<BYTE> packed;
+	packed.Resize (chunk.PackedSize);
+	if (chunk.PackedSize == 0 || File->Read (&packed[0], chunk.PackedSize) != static_cast<long> (chunk.PackedSize))
+		return false;
+
+	switch (chunk.Compression)
+	{
+	case CHUNK_ZLIB:
+		{
+			uLongf length = chunk.UnpackedSize;
+			return uncompress (buffer, &length, &packed[0], chunk.PackedSize) == Z_OK && length == chunk.UnpackedSize;
+		}
+
+	case CHUNK_LZMA:
+		{
+			if (chunk.PackedSize < LZMA_PROPS_SIZE)
+				return false;
+
+			SizeT length = chunk.UnpackedSize;
+			SizeT packedLength = chunk.PackedSize - LZMA_PROPS_SIZE;
+			ELzmaStatus status;
+			return LzmaDecode (buffer, &length, &packed[LZMA_PROPS_SIZE], &packedLength, &packed[0], LZMA_PROPS_SIZE, LZMA_FINISH_END, &status, &g_Alloc) == SZ_OK
+				&& length == chunk.UnpackedSize;
+		}
+
+	default:
+		return false;
+	}
+}
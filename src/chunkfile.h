@@ -0,0 +1,171 @@
+//-----------------------------------------------------------------------------
+//
+// Zandronum Source
+// Copyright (C) 2026 Zandronum Development Team
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 3. Neither the name of the Zandronum Development Team nor the names of its
+//    contributors may be used to endorse or promote products derived from this
+//    software without specific prior written permission.
+// 4. Redistributions in any form must be accompanied by information on how to
+//    obtain complete source code for the software and any accompanying
+//    software that uses the software. The source code must either be included
+//    in the distribution or be available for no more than the cost of
+//    distribution plus a nominal fee, and must be freely redistributable
+//    under reasonable conditions. For an executable file, complete source
+//    code means the source code for all modules it contains. It does not
+//    include source code for modules or files that typically accompany the
+//    major components of the operating system on which the executable file
+//    runs.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+//
+// Filename: chunkfile.h
+//
+// Description: Files made of independently compressed chunks, written on a background thread.
+//
+//-----------------------------------------------------------------------------
+
+#ifndef __CHUNKFILE_H__
+#define __CHUNKFILE_H__
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include "doomtype.h"
+#include "tarray.h"
+
+class FileReader;
+
+//*****************************************************************************
+//	DEFINES
+
+// How the data of a chunk is stored.
+enum EChunkCompression
+{
+	CHUNK_STORED,
+	CHUNK_ZLIB,
+	CHUNK_LZMA,
+
+	NUM_CHUNK_COMPRESSIONS,
+
+	// A chunk that's stored as is and isn't part of the data stream. A file may
+	// only have one of those at the very end to store whatever is only known
+	// once everything else was written.
+	CHUNK_TRAILER = 0xFF
+};
+
+//*****************************************************************************
+//
+// Appends chunks to a file. The chunks are compressed and written by a
+// background thread, so the caller never has to wait for the disk unless
+// it's producing data faster than it can be written.
+//
+class FChunkWriter
+{
+public:
+	FChunkWriter ();
+	~FChunkWriter ();
+
+	bool Open (const char *filename);
+	void Close ();
+	bool IsOpen () const { return File != NULL; }
+
+	// Did any write fail since the file was opened?
+	bool HasFailed () const { return Failed; }
+
+	// Writes data uncompressed and without a chunk header, e.g. a signature.
+	void WriteRaw (const void *data, unsigned int size);
+	void WriteChunk (const void *data, unsigned int size, EChunkCompression compression);
+
+private:
+	struct Job
+	{
+		EChunkCompression	Compression;
+		bool				Raw;
+		TArray<BYTE>		Data;
+	};
+
+	void Enqueue (const void *data, unsigned int size, EChunkCompression compression, bool raw);
+	void Run ();
+	void WriteJob (Job &job);
+
+	FILE						*File;
+	std::atomic<bool>			Failed;
+	bool						Quit;
+	size_t						PendingBytes;
+	std::deque<Job *>			Queue;
+	std::mutex					Mutex;
+	std::condition_variable		WakeWriter;
+	std::condition_variable		WakeProducer;
+	std::thread					Thread;
+};
+
+//*****************************************************************************
+//
+// Reads a file written by FChunkWriter one chunk at a time. The chunks are
+// located up front by only reading their headers.
+//
+class FChunkReader
+{
+public:
+	// The reader takes ownership of the file.
+	FChunkReader (FileReader *file, long dataStart);
+	~FChunkReader ();
+
+	// Returns false if the file ends in the middle of a chunk. All complete
+	// chunks before that can still be read.
+	bool IsComplete () const { return Complete; }
+
+	unsigned int NumChunks () const { return Chunks.Size(); }
+
+	// Position of the chunk's first byte in the uncompressed data stream.
+	DWORD ChunkStart (unsigned int chunk) const { return Chunks[chunk].StreamOffset; }
+	DWORD ChunkSize (unsigned int chunk) const { return Chunks[chunk].UnpackedSize; }
+
+	// Returns the chunk that contains the given position of the data stream.
+	int FindChunk (DWORD streamOffset) const;
+
+	bool ReadChunk (unsigned int chunk, BYTE *buffer);
+
+	bool HasTrailer () const { return Trailer.Size() > 0; }
+	const TArray<BYTE> &GetTrailer () const { return Trailer; }
+
+private:
+	struct Chunk
+	{
+		long				FileOffset;
+		BYTE				Compression;
+		DWORD				PackedSize;
+		DWORD				UnpackedSize;
+		DWORD				StreamOffset;
+	};
+
+	FileReader				*File;
+	TArray<Chunk>			Chunks;
+	TArray<BYTE>			Trailer;
+	bool					Complete;
+};
+
+#endif // __CHUNKFILE_H__
@@ -50,6 +50,7 @@
 
 #include "c_console.h"
 #include "c_dispatch.h"
+#include "chunkfile.h"
 #include "cl_demo.h"
 #include "cl_main.h"
 #include "cmdlib.h"
@@ -59,12 +60,16 @@
 #include "d_protocol.h"
 #include "doomstat.h"
 #include "doomtype.h"
+#include "farchive.h"
+#include "files.h"
+#include "g_level.h"
 #include "i_system.h"
 #include "m_misc.h"
 #include "m_random.h"
 #include "network.h"
 #include "networkshared.h"
 #include "p_local.h"
+#include "p_setup.h"
 #include "p_tick.h"
 #include "r_draw.h"
 #include "r_state.h"
@@ -76,28 +81,34 @@
 #include "network_enums.h"
 
 //*****************************************************************************
-enum 
+//	STRUCTURES
+
+// [ZA] A snapshot of the world stored in the demo that playback can jump to.
+struct DemoKeyframe
 {
-	// [BC] Message headers with bytes starting with 0 and going sequentially
-	// isn't very distinguishing from other formats (such as normal ZDoom demos),
-	// but does that matter?
-	CLD_DEMOLENGTH = NUM_SERVER_COMMANDS,
-	CLD_DEMOVERSION,
-	CLD_CVARS,
-	CLD_USERINFO,
-	CLD_BODYSTART,
-	CLD_TICCMD,
-	CLD_LOCALCOMMAND, // [Dusk]
-	CLD_DEMOEND,
-	CLD_DEMOWADS, // [Dusk]
-
-	NUM_DEMO_COMMANDS
+	// Number of tics recorded before this keyframe.
+	unsigned int	tic;
+
+	// Position of the CLD_KEYFRAME command in the demo stream.
+	LONG			offset;
 };
 
 //*****************************************************************************
 //	PROTOTYPES
 
 static	void				clientdemo_CheckDemoBuffer( ULONG ulSize );
+static	bool				clientdemo_CanWriteKeyframe( void );
+static	void				clientdemo_WriteKeyframe( void );
+static	void				clientdemo_ReadKeyframe( bool bRestore );
+static	void				clientdemo_ReadKeyframeIndex( LONG lIndexOffset );
+static	LONG				clientdemo_GetStreamOffset( void );
+static	bool				clientdemo_SetStreamOffset( LONG lOffset );
+static	void				clientdemo_FlushChunk( void );
+static	bool				clientdemo_LoadChunk( int chunk );
+static	int					clientdemo_FindKeyframe( unsigned int tic );
+static	void				clientdemo_SeekTo( unsigned int tic );
+static	void				clientdemo_PerformSeek( void );
+static	void				clientdemo_StartFreeSpectating( void );
 
 //*****************************************************************************
 //	VARIABLES
@@ -122,8 +133,23 @@ static	bool				g_ConsolePlayerUnrestricted = false;
 static	ULONG				g_ulTicsToSkip = 0;
 
 // Buffer for our demo.
+// [ZA] When recording, this only holds what hasn't been handed to the writer yet.
+// When playing a chunked demo, this is the chunk we are currently in.
 static	BYTE				*g_pbDemoBuffer;
 
+// [ZA] Position of g_pbDemoBuffer's first byte in the whole demo stream.
+static	LONG				g_lDemoBufferOffset = 0;
+
+// [ZA] Streams the demo we are recording to the disk.
+static	FChunkWriter		g_DemoWriter;
+
+// [ZA] Reads the demo we are playing one chunk at a time. This is NULL for
+// demos from before the chunked format, these are loaded as a whole.
+static	FChunkReader		*g_pDemoReader = NULL;
+
+// [ZA] The chunk of the demo that's currently in g_pbDemoBuffer.
+static	int					g_CurrentChunk = -1;
+
 // Our byte stream that points to where we are in our demo.
 static	BYTESTREAM_s		g_ByteStream;
 
@@ -140,6 +166,7 @@ static	LONG				g_lDemoLength;
 static	LONG				g_lGameticOffset;
 
 // Maximum length our current demo can be.
+// [ZA] Or rather, the size of the buffer that collects the data of the next chunk.
 static	LONG				g_lMaxDemoLength;
 
 // [BB] Special player that is used to control the camera when playing demos in free spectate mode.
@@ -148,8 +175,32 @@ static	player_t			g_demoCameraPlayer;
 // [Dusk] ZCLD magic number signature
 static	const DWORD			g_demoSignature = MAKE_ID( 'Z', 'C', 'L', 'D' );
 
+// [ZA] Signature of demo files that store the ZCLD stream in chunks.
+static	const DWORD			g_chunkedDemoSignature = MAKE_ID( 'Z', 'C', 'L', 'C' );
+
+// [ZA] A chunk is handed to the writer once at least that much data was collected.
+// Chunks always end with a ticcmd, so they are usually a bit larger than this.
+static	const LONG			DEMO_CHUNK_SIZE = 0x10000;
+
 static	unsigned int		g_TicsPlayedBack = 0;
 
+// [ZA] How many ticcmds have been written to the demo we are recording?
+static	unsigned int		g_TicsRecorded = 0;
+
+// [ZA] At which tic should the next keyframe be written?
+static	unsigned int		g_NextKeyframeTic = 0;
+
+// [ZA] Seek index of the demo, sorted by tic.
+static	TArray<DemoKeyframe>	g_DemoKeyframes;
+
+// [ZA] Where the body of the demo starts. Seeking back before the first keyframe restarts from here.
+static	LONG				g_lBodyStartPosition = 0;
+
+// [ZA] A seek requested by demo_skipto, performed before reading the next packet.
+static	bool				g_bSeekPending = false;
+static	int					g_SeekKeyframe = -1;
+static	unsigned int		g_SeekTic = 0;
+
 // [Dusk] Should we perform demo authentication?
 CUSTOM_CVAR( Bool, demo_pure, true, CVAR_ARCHIVE | CVAR_GLOBALCONFIG )
 {
@@ -161,6 +212,17 @@ CUSTOM_CVAR( Bool, demo_pure, true, CVAR_ARCHIVE | CVAR_GLOBALCONFIG )
 		"Demos may get played back with completely incorrect WADs!" TEXTCOLOR_NORMAL "\n" );
 }
 
+// [ZA] How often (in tics) a snapshot of the world is stored in recorded demos, so that
+// playback can seek to any position quickly. Zero disables keyframes.
+CVAR( Int, demo_keyframeinterval, 30 * TICRATE, CVAR_ARCHIVE | CVAR_GLOBALCONFIG )
+
+// [ZA] How the chunks of recorded demos are compressed: 0 = not at all, 1 = zlib, 2 = LZMA.
+CUSTOM_CVAR( Int, demo_compression, CHUNK_ZLIB, CVAR_ARCHIVE | CVAR_GLOBALCONFIG )
+{
+	if (( self < CHUNK_STORED ) || ( self >= NUM_CHUNK_COMPRESSIONS ))
+		self = CHUNK_ZLIB;
+}
+
 //*****************************************************************************
 //	FUNCTIONS
 
@@ -174,46 +236,28 @@ void CLIENTDEMO_BeginRecording( const char *pszDemoName )
 	FixPathSeperator( g_DemoName );
 	DefaultExtension( g_DemoName, ".cld" );
 
+	// [ZA] The demo is written to the disk while it's being recorded, so that
+	// neither a long demo has to be kept in memory nor is it lost on a crash.
+	if ( g_DemoWriter.Open( g_DemoName.GetChars( )) == false )
+	{
+		Printf( "Couldn't open \"%s\" for recording.\n", g_DemoName.GetChars( ));
+		return;
+	}
+
 	// Allocate 128KB of memory for the demo buffer.
 	g_bDemoRecording = true;
 	g_lMaxDemoLength = 0x20000;
 	g_pbDemoBuffer = (BYTE *)M_Malloc( g_lMaxDemoLength );
+	g_lDemoBufferOffset = 0;
 	g_ByteStream.pbStream = g_pbDemoBuffer;
 	g_ByteStream.pbStreamEnd = g_pbDemoBuffer + g_lMaxDemoLength;
 
 	// Write our header.
-	// [Dusk] Write a static "ZCLD" which is consistent between
-	// different Zandronum versions.
-	g_ByteStream.WriteLong( g_demoSignature );
-
-	// Write the length of the demo. Of course, we can't complete this quite yet!
-	g_ByteStream.WriteByte( CLD_DEMOLENGTH );
-	g_ByteStream.pbStream += 4;
-
-	// Write version information helpful for this demo.
-	g_ByteStream.WriteByte( CLD_DEMOVERSION );
-	g_ByteStream.WriteShort( DEMOGAMEVERSION );
-	g_ByteStream.WriteString( GetVersionStringRev() );
-	g_ByteStream.WriteByte( BUILD_ID );
-	g_ByteStream.WriteLong( rngseed );
-
-	// [Dusk] Write the amount of WADs and their names, incl. IWAD
-	g_ByteStream.WriteByte( CLD_DEMOWADS );
-	ULONG ulWADCount = 1 + NETWORK_GetPWADList().Size( ); // 1 for IWAD
-	g_ByteStream.WriteShort( ulWADCount );
-	g_ByteStream.WriteString( NETWORK_GetIWAD ( ) );
-
-	for ( unsigned int i = 0; i < NETWORK_GetPWADList().Size(); ++i )
-		g_ByteStream.WriteString( NETWORK_GetPWADList()[i].name );
+	CLIENTDEMO_WriteDemoHeader( g_DemoWriter, &g_ByteStream );
 
-	// [Dusk] Write the network authentication string, we need it to
-	// ensure we have the right WADs loaded.
-	g_ByteStream.WriteString( g_lumpsAuthenticationChecksum.GetChars( ) );
-
-	// [Dusk] Also generate and write the map collection checksum so we can
-	// authenticate the maps.
-	NETWORK_MakeMapCollectionChecksum( );
-	g_ByteStream.WriteString( g_MapCollectionChecksum.GetChars( ) );
+	g_DemoKeyframes.Clear( );
+	g_TicsRecorded = 0;
+	g_NextKeyframeTic = demo_keyframeinterval;
 
 /*
 	// Write cvars chunk.
@@ -235,6 +279,55 @@ void CLIENTDEMO_BeginRecording( const char *pszDemoName )
 	CLIENTDEMO_WriteConsolePlayerUnrestricted( cl_spectatormode == SPECMODE_NO_RESTRICTIONS );
 }
 
+//*****************************************************************************
+//
+// [ZA] Writes everything that comes before the userinfo in the demo header. Also used by
+// the server to record demos.
+//
+void CLIENTDEMO_WriteDemoHeader( FChunkWriter &Writer, BYTESTREAM_s *pByteStream )
+{
+	Writer.WriteRaw( &g_chunkedDemoSignature, sizeof( g_chunkedDemoSignature ));
+
+	// [Dusk] Write a static "ZCLD" which is consistent between
+	// different Zandronum versions.
+	pByteStream->WriteLong( g_demoSignature );
+
+	// Write the length of the demo. Of course, we can't complete this quite yet!
+	// [ZA] The header is already on the disk once we know, the trailer of the file tells instead.
+	pByteStream->WriteByte( CLD_DEMOLENGTH );
+	pByteStream->WriteLong( 0 );
+
+	// Write version information helpful for this demo.
+	pByteStream->WriteByte( CLD_DEMOVERSION );
+	pByteStream->WriteShort( DEMOGAMEVERSION );
+	pByteStream->WriteString( GetVersionStringRev() );
+	pByteStream->WriteByte( BUILD_ID );
+	pByteStream->WriteLong( rngseed );
+
+	// [Dusk] Write the amount of WADs and their names, incl. IWAD
+	pByteStream->WriteByte( CLD_DEMOWADS );
+	ULONG ulWADCount = 1 + NETWORK_GetPWADList().Size( ); // 1 for IWAD
+	pByteStream->WriteShort( ulWADCount );
+	pByteStream->WriteString( NETWORK_GetIWAD ( ) );
+
+	for ( unsigned int i = 0; i < NETWORK_GetPWADList().Size(); ++i )
+		pByteStream->WriteString( NETWORK_GetPWADList()[i].name );
+
+	// [Dusk] Write the network authentication string, we need it to
+	// ensure we have the right WADs loaded.
+	pByteStream->WriteString( g_lumpsAuthenticationChecksum.GetChars( ) );
+
+	// [Dusk] Also generate and write the map collection checksum so we can
+	// authenticate the maps.
+	NETWORK_MakeMapCollectionChecksum( );
+	pByteStream->WriteString( g_MapCollectionChecksum.GetChars( ) );
+
+	// [ZA] Where the seek index is. Like the length, this is only known when we're done,
+	// so it stays zero and the trailer of the file tells instead.
+	pByteStream->WriteByte( CLD_KEYFRAMEINDEX );
+	pByteStream->WriteLong( 0 );
+}
+
 //*****************************************************************************
 //
 bool CLIENTDEMO_ProcessDemoHeader( void )
@@ -271,7 +364,10 @@ bool CLIENTDEMO_ProcessDemoHeader( void )
 	}
 
 	g_lDemoLength = g_ByteStream.ReadLong();
-	g_ByteStream.pbStreamEnd = g_pbDemoBuffer + g_lDemoLength + ( g_lDemoLength & 1 );
+
+	// [ZA] Chunked demos end where their last chunk ends.
+	if ( g_pDemoReader == NULL )
+		g_ByteStream.pbStreamEnd = g_pbDemoBuffer + g_lDemoLength + ( g_lDemoLength & 1 );
 
 	// Continue to read header commands until we reach the body of the demo.
 	bBodyStart = false;
@@ -319,6 +415,7 @@ bool CLIENTDEMO_ProcessDemoHeader( void )
 		case CLD_BODYSTART:
 
 			bBodyStart = true;
+			g_lBodyStartPosition = clientdemo_GetStreamOffset( );
 			break;
 
 		// [Dusk]
@@ -326,6 +423,15 @@ bool CLIENTDEMO_ProcessDemoHeader( void )
 			CLIENTDEMO_ReadDemoWads( );
 			break;
 
+		// [ZA] Chunked demos leave this at zero, their trailer is read once the header is done.
+		case CLD_KEYFRAMEINDEX:
+			{
+				const LONG lIndexOffset = g_ByteStream.ReadLong( );
+				if ( lIndexOffset != 0 )
+					clientdemo_ReadKeyframeIndex( lIndexOffset );
+			}
+			break;
+
 		// [Dusk] Bad headers shouldn't just be ignored, that's just asking for trouble.
 		default:
 			I_Error( "Unknown demo header %ld!\n", lCommand );
@@ -406,6 +512,14 @@ void CLIENTDEMO_ReadUserInfo( void )
 //
 void CLIENTDEMO_WriteTiccmd( ticcmd_t *pCmd )
 {
+	// [ZA] Store a keyframe before the ticcmd if it's time for one. If the world isn't
+	// in a state that can be stored right now, try again on the next tic.
+	if (( demo_keyframeinterval > 0 ) && ( g_TicsRecorded >= g_NextKeyframeTic ) && clientdemo_CanWriteKeyframe( ))
+	{
+		clientdemo_WriteKeyframe( );
+		g_NextKeyframeTic = g_TicsRecorded + demo_keyframeinterval;
+	}
+
 	// First, make sure we have enough space to write this command. If not, add
 	// more space.
 	clientdemo_CheckDemoBuffer( 14 );
@@ -421,6 +535,12 @@ void CLIENTDEMO_WriteTiccmd( ticcmd_t *pCmd )
 	g_ByteStream.WriteShort( pCmd->ucmd.upmove );
 	g_ByteStream.WriteShort( pCmd->ucmd.forwardmove );
 	g_ByteStream.WriteShort( pCmd->ucmd.sidemove );
+
+	++g_TicsRecorded;
+
+	// [ZA] This is the end of the tic, so the collected data can be handed to the writer.
+	if (( g_ByteStream.pbStream - g_pbDemoBuffer ) >= DEMO_CHUNK_SIZE )
+		clientdemo_FlushChunk( );
 }
 
 //*****************************************************************************
@@ -497,6 +617,10 @@ void CLIENTDEMO_ReadPacket( void )
 	LONG		lCommand;
 	const char	*pszString;
 
+	// [ZA] Jump to where demo_skipto wants us to be.
+	if ( g_bSeekPending )
+		clientdemo_PerformSeek( );
+
 	while ( 1 )
 	{  
 		lCommand = g_ByteStream.ReadByte();
@@ -508,6 +632,10 @@ void CLIENTDEMO_ReadPacket( void )
 		// End of message.
 		if ( lCommand == -1 )
 		{
+			// [ZA] Continue with the next chunk, if there is one.
+			if (( g_pDemoReader != NULL ) && clientdemo_LoadChunk( g_CurrentChunk + 1 ))
+				continue;
+
 			// [BB] When we reach the end of the demo stream, we need to stop the demo.
 			CLIENTDEMO_FinishPlaying( );
 			break;
@@ -620,8 +748,29 @@ void CLIENTDEMO_ReadPacket( void )
 					}
 				}
 				break;
+			case CLD_LCMD_FREESPECTATE:
+
+				// [ZA] Demos recorded by the server have no player of their own to look through.
+				clientdemo_StartFreeSpectating( );
+				break;
+			}
+			break;
+		case CLD_PLAYERTICCMD:
+
+			// [ZA] Demos recorded by the server store what every player sent. Nothing needs
+			// them for playback since the movement is in the server commands already.
+			{
+				ticcmd_t	cmd;
+
+				g_ByteStream.ReadByte( );
+				CLIENTDEMO_ReadTiccmd( &cmd );
 			}
 			break;
+		case CLD_KEYFRAME:
+
+			// [ZA] Keyframes are only needed when seeking, otherwise just skip over them.
+			clientdemo_ReadKeyframe( false );
+			break;
 		case CLD_DEMOEND:
 
 			CLIENTDEMO_FinishPlaying( );
@@ -644,60 +793,130 @@ void CLIENTDEMO_FinishRecording( void )
 {
 	LONG			lDemoLength;
 	BYTESTREAM_s	ByteStream;
+	BYTE			abTrailer[8];
 
 	// Write our header.
+	clientdemo_CheckDemoBuffer( 5 + 8 * g_DemoKeyframes.Size( ));
 	g_ByteStream.WriteByte( CLD_DEMOEND );
 
-	// Go back real quick and write the length of this demo.
-	lDemoLength = g_ByteStream.pbStream - g_pbDemoBuffer;
-	ByteStream.pbStream = g_pbDemoBuffer + 5;
-	ByteStream.pbStreamEnd = g_ByteStream.pbStreamEnd;
+	// [ZA] Append the seek index behind the end of the demo, playback never reads that far.
+	const LONG lKeyframeIndexOffset = clientdemo_GetStreamOffset( );
+	g_ByteStream.WriteLong( g_DemoKeyframes.Size( ));
+	for ( unsigned int i = 0; i < g_DemoKeyframes.Size( ); ++i )
+	{
+		g_ByteStream.WriteLong( g_DemoKeyframes[i].tic );
+		g_ByteStream.WriteLong( g_DemoKeyframes[i].offset );
+	}
+
+	lDemoLength = clientdemo_GetStreamOffset( );
+	clientdemo_FlushChunk( );
+
+	// [ZA] The header was written long ago, so the length of this demo and where to
+	// find the seek index go into the trailer of the file instead.
+	ByteStream.pbStream = abTrailer;
+	ByteStream.pbStreamEnd = abTrailer + sizeof( abTrailer );
 	ByteStream.WriteLong( lDemoLength );
+	ByteStream.WriteLong( lKeyframeIndexOffset );
+	g_DemoWriter.WriteChunk( abTrailer, sizeof( abTrailer ), CHUNK_TRAILER );
 
-	// Write the contents of the buffer to the file, and free the memory we
-	// allocated for the demo.
-	M_WriteFile( g_DemoName.GetChars(), g_pbDemoBuffer, lDemoLength ); 
+	// [ZA] Wait for the writer to put everything on the disk, and free the memory
+	// we allocated for the demo.
+	g_DemoWriter.Close( );
 	M_Free( g_pbDemoBuffer );
 	g_pbDemoBuffer = NULL;
+	g_lDemoBufferOffset = 0;
 
 	// We're no longer recording a demo.
 	g_bDemoRecording = false;
 
-	// All done!
-	Printf( "Demo \"%s\" successfully recorded!\n", g_DemoName.GetChars() ); 
+	if ( g_DemoWriter.HasFailed( ))
+	{
+		Printf( "Failed to write demo \"%s\"!\n", g_DemoName.GetChars() );
+	}
+	else
+	{
+		// All done!
+		Printf( "Demo \"%s\" successfully recorded!\n", g_DemoName.GetChars() ); 
+		if ( g_DemoKeyframes.Size( ) > 0 )
+			Printf( "%u keyframes were stored for seeking.\n", g_DemoKeyframes.Size( ));
+	}
+
+	g_DemoKeyframes.Clear( );
 }
 
 //*****************************************************************************
 //
 void CLIENTDEMO_DoPlayDemo( const char *pszDemoName )
 {
-	LONG	lDemoLump;
-	LONG	lDemoLength;
-	FString demoName = pszDemoName;
+	LONG		lDemoLump;
+	LONG		lDemoLength;
+	FString		demoName = pszDemoName;
+	FileReader	*pReader = NULL;
+	DWORD		signature = 0;
 
 	// First, check if the demo is in a lump.
 	lDemoLump = Wads.CheckNumForName( demoName );
 	if ( lDemoLump >= 0 )
 	{
-		lDemoLength = Wads.LumpLength( lDemoLump );
-
-		// Read the data from the lump into our demo buffer.
-		g_pbDemoBuffer = new BYTE[lDemoLength];
-		Wads.ReadLump( lDemoLump, g_pbDemoBuffer );
+		pReader = Wads.ReopenLumpNum( lDemoLump );
 	}
 	else
 	{
 		FixPathSeperator( demoName );
 		DefaultExtension( demoName, ".cld" );
-		lDemoLength = M_ReadFile( demoName, &g_pbDemoBuffer );
+
+		pReader = new FileReader;
+		if ( pReader->Open( demoName ) == false )
+		{
+			delete pReader;
+			I_Error( "CLIENTDEMO_DoPlayDemo: Couldn't open demo %s.\n", demoName.GetChars( ));
+		}
 	}
 
-	g_ByteStream.pbStream = g_pbDemoBuffer;
-	g_ByteStream.pbStreamEnd = g_pbDemoBuffer + lDemoLength;
 	g_TicsPlayedBack = 0;
+	g_DemoKeyframes.Clear( );
+	g_bSeekPending = false;
+	g_lDemoBufferOffset = 0;
+	g_CurrentChunk = -1;
+
+	pReader->Read( &signature, sizeof( signature ));
+
+	// [ZA] Chunked demos are read one chunk at a time.
+	if ( signature == g_chunkedDemoSignature )
+	{
+		g_pDemoReader = new FChunkReader( pReader, sizeof( signature ));
+
+		if ( g_pDemoReader->IsComplete( ) == false || g_pDemoReader->HasTrailer( ) == false )
+			Printf( TEXTCOLOR_YELLOW "This demo was not finished properly, it will be played back as far as possible.\n" );
+
+		if ( clientdemo_LoadChunk( 0 ) == false )
+			I_Error( "CLIENTDEMO_DoPlayDemo: This demo is empty.\n" );
+	}
+	// [ZA] Demos from before the chunked format are loaded as a whole.
+	else
+	{
+		lDemoLength = pReader->GetLength( );
+		g_pbDemoBuffer = new BYTE[lDemoLength];
+		pReader->Seek( 0, SEEK_SET );
+		pReader->Read( g_pbDemoBuffer, lDemoLength );
+		delete pReader;
+
+		g_ByteStream.pbStream = g_pbDemoBuffer;
+		g_ByteStream.pbStreamEnd = g_pbDemoBuffer + lDemoLength;
+	}
 
 	if ( CLIENTDEMO_ProcessDemoHeader( ))
 	{
+		// [ZA] The trailer of a chunked demo tells where to find the seek index.
+		if (( g_pDemoReader != NULL ) && ( g_pDemoReader->GetTrailer( ).Size( ) >= 8 ))
+		{
+			BYTESTREAM_s trailer;
+			trailer.pbStream = const_cast<BYTE *>( &g_pDemoReader->GetTrailer( )[0] );
+			trailer.pbStreamEnd = trailer.pbStream + g_pDemoReader->GetTrailer( ).Size( );
+			g_lDemoLength = trailer.ReadLong( );
+			clientdemo_ReadKeyframeIndex( trailer.ReadLong( ));
+		}
+
 		C_HideConsole( );
 		g_bDemoPlaying = true;
 		g_bDemoPlayingHonest = true;
@@ -721,6 +940,12 @@ void CLIENTDEMO_FinishPlaying( void )
 	// Free our demo buffer.
 	delete[] ( g_pbDemoBuffer );
 	g_pbDemoBuffer = NULL;
+	g_lDemoBufferOffset = 0;
+	delete g_pDemoReader;
+	g_pDemoReader = NULL;
+	g_CurrentChunk = -1;
+	g_DemoKeyframes.Clear( );
+	g_bSeekPending = false;
 
 	// We're no longer playing a demo.
 	g_bDemoPlaying = false;
@@ -1080,8 +1305,8 @@ static void clientdemo_CheckDemoBuffer( ULONG ulSize )
 	// We may need to allocate more memory for our demo buffer.
 	if (( g_ByteStream.pbStream + ulSize ) > g_ByteStream.pbStreamEnd )
 	{
-		// Give us another 128KB of memory.
-		g_lMaxDemoLength += 0x20000;
+		// Give us another 128KB of memory, or more if needed.
+		g_lMaxDemoLength += MAX<LONG>( 0x20000, ulSize );
 		lPosition = g_ByteStream.pbStream - g_pbDemoBuffer;
 		// [BB] Convert our marked position to an offset.
 		const LONG markedOffset = g_pbMarkedStreamPosition - g_pbDemoBuffer;
@@ -1093,6 +1318,376 @@ static void clientdemo_CheckDemoBuffer( ULONG ulSize )
 	}
 }
 
+//*****************************************************************************
+//
+// [ZA] Returns the current position in the whole demo stream.
+//
+static LONG clientdemo_GetStreamOffset( void )
+{
+	return g_lDemoBufferOffset + static_cast<LONG>( g_ByteStream.pbStream - g_pbDemoBuffer );
+}
+
+//*****************************************************************************
+//
+// [ZA] Moves playback to a position in the whole demo stream, loading the chunk it's in if necessary.
+//
+static bool clientdemo_SetStreamOffset( LONG lOffset )
+{
+	if ( g_pDemoReader != NULL )
+	{
+		const int chunk = g_pDemoReader->FindChunk( lOffset );
+
+		if ( chunk < 0 )
+			return false;
+
+		if (( chunk != g_CurrentChunk ) && ( clientdemo_LoadChunk( chunk ) == false ))
+			return false;
+	}
+
+	g_ByteStream.pbStream = g_pbDemoBuffer + ( lOffset - g_lDemoBufferOffset );
+	g_ByteStream.bitBuffer = NULL;
+	g_ByteStream.bitShift = -1;
+	return true;
+}
+
+//*****************************************************************************
+//
+// [ZA] Hands everything recorded since the last chunk to the writer thread.
+// This must only be done at the end of a tic, so that playback can load the
+// next chunk whenever it runs out of data without splitting any commands.
+//
+static void clientdemo_FlushChunk( void )
+{
+	const LONG lSize = static_cast<LONG>( g_ByteStream.pbStream - g_pbDemoBuffer );
+
+	if ( lSize <= 0 )
+		return;
+
+	g_DemoWriter.WriteChunk( g_pbDemoBuffer, lSize, static_cast<EChunkCompression>( *demo_compression ));
+	g_lDemoBufferOffset += lSize;
+	g_ByteStream.pbStream = g_pbDemoBuffer;
+	g_pbMarkedStreamPosition = g_pbDemoBuffer;
+}
+
+//*****************************************************************************
+//
+// [ZA] Replaces the demo buffer with the given chunk of the demo we are playing.
+//
+static bool clientdemo_LoadChunk( int chunk )
+{
+	if (( g_pDemoReader == NULL ) || ( chunk < 0 ) || ( chunk >= static_cast<int>( g_pDemoReader->NumChunks( ))))
+		return false;
+
+	const DWORD size = g_pDemoReader->ChunkSize( chunk );
+	BYTE *pbChunk = new BYTE[size + 1];
+
+	if ( g_pDemoReader->ReadChunk( chunk, pbChunk ) == false )
+	{
+		Printf( "CLIENTDEMO_ReadPacket: Couldn't read chunk %d of the demo.\n", chunk );
+		delete[] pbChunk;
+		return false;
+	}
+
+	delete[] g_pbDemoBuffer;
+	g_pbDemoBuffer = pbChunk;
+	g_lDemoBufferOffset = g_pDemoReader->ChunkStart( chunk );
+	g_CurrentChunk = chunk;
+
+	g_ByteStream.pbStream = g_pbDemoBuffer;
+	g_ByteStream.pbStreamEnd = g_pbDemoBuffer + size;
+	g_ByteStream.bitBuffer = NULL;
+	g_ByteStream.bitShift = -1;
+	return true;
+}
+
+//*****************************************************************************
+//
+// [ZA] Keyframes can only be stored when we are in a level and the server has
+// already told us everything about it.
+//
+static bool clientdemo_CanWriteKeyframe( void )
+{
+	if (( gamestate != GS_LEVEL ) || ( level.info == NULL ) || ( level.info->isValid( ) == false ))
+		return false;
+
+	if ( CLIENT_GetConnectionState( ) != CTS_ACTIVE )
+		return false;
+
+	return ( CLIENT_GetFullUpdateIncomplete( ) == false );
+}
+
+//*****************************************************************************
+//
+// [ZA] Stores a compressed snapshot of the whole world in the demo, using the same
+// serialization that is used for hub snapshots.
+//
+static void clientdemo_WriteKeyframe( void )
+{
+	FCompressedMemFile snapshot;
+	snapshot.Open( );
+
+	{
+		FArchive arc( snapshot );
+		arc.SetDemoKeyframe( );
+		SaveVersion = SAVEVER;
+		G_SerializeLevel( arc, false );
+	}
+
+	unsigned int compressedSize, uncompressedSize;
+	snapshot.GetSizes( compressedSize, uncompressedSize );
+	const ULONG ulSnapshotSize = ( compressedSize ? compressedSize : uncompressedSize ) + 8;
+	const ULONG ulKeyframeSize = 10 + (ULONG)strlen( level.mapname ) + ulSnapshotSize;
+
+	clientdemo_CheckDemoBuffer( ulKeyframeSize );
+
+	// [ZA] A keyframe header without its snapshot would put every command after it out of step,
+	// so leave the keyframe out entirely if the snapshot can't be stored.
+	if (( snapshot.GetImplodedBuffer( ) == NULL ) || ( g_ByteStream.pbStream + ulKeyframeSize > g_ByteStream.pbStreamEnd ))
+	{
+		Printf( "clientdemo_WriteKeyframe: Couldn't store the keyframe at tic %u.\n", g_TicsRecorded );
+		return;
+	}
+
+	DemoKeyframe keyframe;
+	keyframe.tic = g_TicsRecorded;
+	keyframe.offset = clientdemo_GetStreamOffset( );
+	g_DemoKeyframes.Push( keyframe );
+
+	g_ByteStream.WriteByte( CLD_KEYFRAME );
+	g_ByteStream.WriteLong( keyframe.tic );
+	g_ByteStream.WriteString( level.mapname );
+	g_ByteStream.WriteLong( ulSnapshotSize );
+	g_ByteStream.WriteBuffer( snapshot.GetImplodedBuffer( ), ulSnapshotSize );
+}
+
+//*****************************************************************************
+//
+// [ZA] Reads a keyframe at the current position of the demo stream. The world is only
+// restored from it if bRestore is true.
+//
+static void clientdemo_ReadKeyframe( bool bRestore )
+{
+	const unsigned int tic = g_ByteStream.ReadLong( );
+	const FString mapName = g_ByteStream.ReadString( );
+	const LONG lSnapshotSize = g_ByteStream.ReadLong( );
+	BYTE *pbSnapshot = g_ByteStream.pbStream;
+
+	if (( lSnapshotSize < 8 ) || ( g_ByteStream.pbStream + lSnapshotSize > g_ByteStream.pbStreamEnd ))
+	{
+		Printf( "CLIENTDEMO_ReadPacket: Corrupted keyframe at tic %u.\n", tic );
+		g_ByteStream.pbStream = g_ByteStream.pbStreamEnd;
+		return;
+	}
+
+	g_ByteStream.pbStream += lSnapshotSize;
+
+	// [ZA] Demos without a seek index get one built while they are played back.
+	if (( g_DemoKeyframes.Size( ) == 0 ) || ( g_DemoKeyframes.Last( ).tic < tic ))
+	{
+		DemoKeyframe keyframe;
+		keyframe.tic = tic;
+		keyframe.offset = g_lDemoBufferOffset + ( pbSnapshot - g_pbDemoBuffer ) - ( 10 + (LONG)mapName.Len( ));
+		g_DemoKeyframes.Push( keyframe );
+	}
+
+	if ( bRestore == false )
+		return;
+
+	// [ZA] The keyframe may be on a different map than the one we are on now.
+	if (( gamestate != GS_LEVEL ) || ( stricmp( level.mapname, mapName.GetChars( )) != 0 ))
+	{
+		if ( P_CheckIfMapExists( mapName.GetChars( )) == false )
+		{
+			Printf( "CLIENTDEMO_ReadPacket: Keyframe uses unknown map %s.\n", mapName.GetChars( ));
+			return;
+		}
+
+		G_InitNew( mapName.GetChars( ), false );
+	}
+
+	FCompressedMemFile snapshot;
+	snapshot.Open( pbSnapshot );
+
+	{
+		FArchive arc( snapshot );
+		arc.SetDemoKeyframe( );
+		SaveVersion = SAVEVER;
+		G_SerializeLevel( arc, false );
+	}
+
+	// [ZA] Make sure that the NetID list exactly matches what was just loaded.
+	g_ActorNetIDList.rebuild( );
+
+	g_TicsPlayedBack = tic;
+}
+
+//*****************************************************************************
+//
+static void clientdemo_ReadKeyframeIndex( LONG lIndexOffset )
+{
+	g_DemoKeyframes.Clear( );
+
+	TArray<BYTE> chunkData;
+	BYTESTREAM_s stream;
+
+	// [ZA] Demos that are loaded as a whole have the index right in the buffer.
+	if ( g_pDemoReader == NULL )
+	{
+		stream.pbStream = g_pbDemoBuffer + lIndexOffset;
+		stream.pbStreamEnd = g_ByteStream.pbStreamEnd;
+
+		if (( lIndexOffset < 0 ) || ( stream.pbStream + 4 > stream.pbStreamEnd ))
+		{
+			Printf( "CLIENTDEMO_ProcessDemoHeader: Invalid keyframe index.\n" );
+			return;
+		}
+	}
+	// [ZA] Otherwise, it is stored in the last chunk of the demo.
+	else
+	{
+		const int chunk = g_pDemoReader->FindChunk( lIndexOffset );
+		if ( chunk < 0 )
+		{
+			Printf( "CLIENTDEMO_DoPlayDemo: Invalid keyframe index.\n" );
+			return;
+		}
+
+		chunkData.Resize( g_pDemoReader->ChunkSize( chunk ));
+		if ( g_pDemoReader->ReadChunk( chunk, &chunkData[0] ) == false )
+		{
+			Printf( "CLIENTDEMO_DoPlayDemo: Couldn't read the keyframe index.\n" );
+			return;
+		}
+
+		stream.pbStream = &chunkData[0] + ( lIndexOffset - g_pDemoReader->ChunkStart( chunk ));
+		stream.pbStreamEnd = &chunkData[0] + chunkData.Size( );
+
+		if ( stream.pbStream + 4 > stream.pbStreamEnd )
+		{
+			Printf( "CLIENTDEMO_DoPlayDemo: Invalid keyframe index.\n" );
+			return;
+		}
+	}
+
+	const ULONG ulNumKeyframes = stream.ReadLong( );
+
+	if ( static_cast<ULONG>( stream.pbStreamEnd - stream.pbStream ) < ulNumKeyframes * 8 )
+	{
+		Printf( "CLIENTDEMO_DoPlayDemo: Invalid keyframe index.\n" );
+		return;
+	}
+
+	for ( ULONG ulIdx = 0; ulIdx < ulNumKeyframes; ulIdx++ )
+	{
+		DemoKeyframe keyframe;
+		keyframe.tic = stream.ReadLong( );
+		keyframe.offset = stream.ReadLong( );
+		g_DemoKeyframes.Push( keyframe );
+	}
+}
+
+//*****************************************************************************
+//
+// [ZA] Returns the index of the last keyframe at or before the given tic, or -1 if there is none.
+//
+static int clientdemo_FindKeyframe( unsigned int tic )
+{
+	int min = 0;
+	int max = static_cast<int>( g_DemoKeyframes.Size( )) - 1;
+	int found = -1;
+
+	while ( min <= max )
+	{
+		const int mid = ( min + max ) / 2;
+
+		if ( g_DemoKeyframes[mid].tic <= tic )
+		{
+			found = mid;
+			min = mid + 1;
+		}
+		else
+		{
+			max = mid - 1;
+		}
+	}
+
+	return found;
+}
+
+//*****************************************************************************
+//
+// [ZA] Schedules a seek to the given tic. Only the tics between the nearest keyframe
+// and the desired tic need to be played back.
+//
+static void clientdemo_SeekTo( unsigned int tic )
+{
+	const int keyframe = clientdemo_FindKeyframe( tic );
+
+	// [ZA] Going forward, skipping tics is enough unless there is a keyframe in between.
+	if (( tic >= g_TicsPlayedBack ) && (( keyframe < 0 ) || ( g_DemoKeyframes[keyframe].tic <= g_TicsPlayedBack )))
+	{
+		g_ulTicsToSkip = tic - g_TicsPlayedBack;
+		return;
+	}
+
+	g_bSeekPending = true;
+	g_SeekKeyframe = keyframe;
+	g_SeekTic = tic;
+}
+
+//*****************************************************************************
+//
+static void clientdemo_PerformSeek( void )
+{
+	g_bSeekPending = false;
+
+	// [ZA] The free spectator's body would be destroyed together with the rest of the world.
+	const bool bFreeSpectating = CLIENTDEMO_IsInFreeSpectateMode( );
+	CLIENTDEMO_ClearFreeSpectatorPlayer( );
+
+	if (( g_SeekKeyframe >= 0 ) && ( g_SeekKeyframe < static_cast<int>( g_DemoKeyframes.Size( ))))
+	{
+		if ( clientdemo_SetStreamOffset( g_DemoKeyframes[g_SeekKeyframe].offset ) && ( g_ByteStream.ReadByte( ) == CLD_KEYFRAME ))
+			clientdemo_ReadKeyframe( true );
+		else
+			Printf( "CLIENTDEMO_ReadPacket: Seek index points to an invalid position.\n" );
+	}
+	// [ZA] No keyframe before the position, so we have to start over.
+	else
+	{
+		CLIENT_ClearAllPlayers( );
+		clientdemo_SetStreamOffset( g_lBodyStartPosition );
+		g_TicsPlayedBack = 0;
+	}
+
+	g_ulTicsToSkip = ( g_SeekTic > g_TicsPlayedBack ) ? ( g_SeekTic - g_TicsPlayedBack ) : 0;
+
+	if ( bFreeSpectating && ( gamestate == GS_LEVEL ))
+	{
+		CLIENTDEMO_SpawnFreeSpectatorPlayer( );
+		players[consoleplayer].camera = g_demoCameraPlayer.mo;
+		if ( StatusBar )
+			StatusBar->AttachToPlayer( &g_demoCameraPlayer );
+	}
+}
+
+//*****************************************************************************
+//
+// [ZA] Makes the free spectator player the camera, spawning it first if necessary.
+//
+static void clientdemo_StartFreeSpectating( void )
+{
+	if ( players[consoleplayer].camera != g_demoCameraPlayer.mo )
+	{
+		CLIENTDEMO_ClearFreeSpectatorPlayer();
+		CLIENTDEMO_SpawnFreeSpectatorPlayer();
+
+		players[consoleplayer].camera = g_demoCameraPlayer.mo;
+		if ( StatusBar )
+			StatusBar->AttachToPlayer ( &g_demoCameraPlayer );
+	}
+}
+
 //*****************************************************************************
 //	CONSOLE COMMANDS
 
@@ -1152,15 +1747,8 @@ CCMD( demo_skipto )
 
 		if ( ticPositionSigned >= 0 )
 		{
-			const unsigned int ticPosition = static_cast<unsigned int>( ticPositionSigned );
-			if ( ticPosition >= g_TicsPlayedBack )
-			{
-				g_ulTicsToSkip = ticPosition - g_TicsPlayedBack;
-			}
-			else
-			{
-				Printf( "That position is in the past. You cannot rewind demos.\n" );
-			}
+			// [ZA] Positions in the past can be reached through the keyframes or by starting over.
+			clientdemo_SeekTo( static_cast<unsigned int>( ticPositionSigned ));
 		}
 		else
 		{
@@ -1187,13 +1775,5 @@ CCMD( demo_spectatefreely )
 	if ( CLIENTDEMO_IsPlaying( ) == false )
 		return;
 
-	if ( players[consoleplayer].camera != g_demoCameraPlayer.mo )
-	{
-		CLIENTDEMO_ClearFreeSpectatorPlayer();
-		CLIENTDEMO_SpawnFreeSpectatorPlayer();
-
-		players[consoleplayer].camera = g_demoCameraPlayer.mo;
-		if ( StatusBar )
-			StatusBar->AttachToPlayer ( &g_demoCameraPlayer );
-	}
+	clientdemo_StartFreeSpectating( );
 }
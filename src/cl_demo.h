@@ -54,10 +54,34 @@
 #include "d_ticcmd.h"
 #include "network.h"
 #include "networkshared.h"
+#include "network_enums.h"
+
+class FChunkWriter;
 
 //*****************************************************************************
 //	DEFINES
 
+enum 
+{
+	// [BC] Message headers with bytes starting with 0 and going sequentially
+	// isn't very distinguishing from other formats (such as normal ZDoom demos),
+	// but does that matter?
+	CLD_DEMOLENGTH = NUM_SERVER_COMMANDS,
+	CLD_DEMOVERSION,
+	CLD_CVARS,
+	CLD_USERINFO,
+	CLD_BODYSTART,
+	CLD_TICCMD,
+	CLD_LOCALCOMMAND, // [Dusk]
+	CLD_DEMOEND,
+	CLD_DEMOWADS, // [Dusk]
+	CLD_KEYFRAMEINDEX, // [ZA]
+	CLD_KEYFRAME, // [ZA]
+	CLD_PLAYERTICCMD, // [ZA]
+
+	NUM_DEMO_COMMANDS
+};
+
 enum ClientDemoLocalCommand
 {
 	CLD_LCMD_INVUSE,
@@ -68,12 +92,14 @@ enum ClientDemoLocalCommand
 	CLD_LCMD_SETSTATUS,
 	CLD_LCMD_FREECHASECAM,
 	CLD_LCMD_CONSOLEPLAYERUNRESTRICTED,
+	CLD_LCMD_FREESPECTATE, // [ZA]
 };
 
 //*****************************************************************************
 //	PROTOTYPES
 
 void		CLIENTDEMO_BeginRecording( const char *pszDemoName );
+void		CLIENTDEMO_WriteDemoHeader( FChunkWriter &Writer, BYTESTREAM_s *pByteStream );
 bool		CLIENTDEMO_ProcessDemoHeader( void );
 void		CLIENTDEMO_WriteUserInfo( void );
 void		CLIENTDEMO_ReadUserInfo( void );
@@ -4823,6 +4823,14 @@ void ServerCommands::PlayerVoIPAudioPacket::Execute()
 	VOIPController::GetInstance( ).ReceiveAudioPacket( playerNumber, frame, audio.data, audio.size );
 }
 
+//*****************************************************************************
+//
+void ServerCommands::PlayerVoIPAudioFrames::Execute()
+{
+	for ( unsigned int i = 0; i < frames.Size( ); i++ )
+		VOIPController::GetInstance( ).ReceiveAudioPacket( frames[i].playerNumber, frames[i].frame, frames[i].audio.data, frames[i].audio.size );
+}
+
 //*****************************************************************************
 //
 void ServerCommands::PlayerTaunt::Execute()
@@ -263,6 +263,12 @@ namespace GC
 	// Size of GC steps.
 	extern int StepMul;
 
+	// [ZA] While set, Step leaves sweeping to SweepTail.
+	extern bool DeferSweep;
+
+	// [ZA] Microseconds SweepTail may spend per call. 0 never defers sweeping.
+	extern int SweepTime;
+
 	// Current white value for known-dead objects.
 	static inline uint32 OtherWhite()
 	{
@@ -278,6 +284,9 @@ namespace GC
 	// Does a complete collection.
 	void FullGC();
 
+	// [ZA] Does the sweeping Step left over, within the time SweepTime allows.
+	void SweepTail();
+
 	// Handles the grunt work for a write barrier.
 	void Barrier(DObject *pointing, DObject *pointed);
 
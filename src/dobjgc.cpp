@@ -96,6 +96,11 @@
 */
 #define DEFAULT_GCMUL		400 // GC runs 'quadruple the speed' of memory allocation
 
+// [ZA] Microseconds of sweeping to do at the end of each tic. Sweeping
+// destroys and frees objects, so doing it in the middle of the thinkers,
+// whenever they happened to allocate enough, made for uneven tic times.
+#define DEFAULT_GCSWEEPTIME	1000
+
 // Number of sectors to mark for each step.
 #define SECTORSTEPSIZE	32
 #define POLYSTEPSIZE 120
@@ -150,10 +155,13 @@ int Pause = DEFAULT_GCPAUSE;
 int StepMul = DEFAULT_GCMUL;
 int StepCount;
 size_t Dept;
+bool DeferSweep;
+int SweepTime = DEFAULT_GCSWEEPTIME;
 
 // PRIVATE DATA DEFINITIONS ------------------------------------------------
 
 static DSectorMarker *SectorMarker;
+static cycle_t SweepTailCycles;
 
 // CODE --------------------------------------------------------------------
 
@@ -451,6 +459,13 @@ void Step()
 	Dept += AllocBytes - Threshold;
 	do
 	{
+		// [ZA] Leave sweeping to SweepTail, unless memory use grew by half
+		// since the sweep started and it can't wait any longer.
+		if (State == GCS_Sweep && DeferSweep && SweepTime > 0 &&
+			AllocBytes <= Estimate + Estimate / 2)
+		{
+			break;
+		}
 		olim = lim;
 		lim -= SingleStep();
 	} while (olim > lim && State != GCS_Pause);
@@ -474,6 +489,41 @@ void Step()
 	StepCount++;
 }
 
+//==========================================================================
+//
+// SweepTail
+//
+// [ZA] Called at the end of each tic. Continues a sweep that Step left
+// over for up to SweepTime microseconds.
+//
+//==========================================================================
+
+void SweepTail()
+{
+	DeferSweep = false;
+	SweepTailCycles.Reset();
+
+	if (State != GCS_Sweep && State != GCS_Finalize)
+	{
+		return;
+	}
+
+	const double limit = SweepTime / 1000.;
+	do
+	{
+		SweepTailCycles.Clock();
+		SingleStep();
+		SweepTailCycles.Unclock();
+	} while (State != GCS_Pause && SweepTailCycles.TimeMS() < limit);
+
+	// The threshold Step left is only meant to bring the next step closer.
+	// Once the sweep is done, the next cycle has to wait for the pause.
+	if (State == GCS_Pause)
+	{
+		SetThreshold();
+	}
+}
+
 //==========================================================================
 //
 // FullGC
@@ -721,6 +771,8 @@ ADD_STAT(gc)
 	{
 		out.AppendFormat("  %zuK", (GC::Dept + 1023) >> 10);
 	}
+	// [ZA]
+	out.AppendFormat("  Tail:%5.2f ms", GC::SweepTailCycles.TimeMS());
 	return out;
 }
 
@@ -736,7 +788,7 @@ CCMD(gc)
 {
 	if (argv.argc() == 1)
 	{
-		Printf ("Usage: gc stop|now|full|pause [size]|stepmul [size]\n");
+		Printf ("Usage: gc stop|now|full|pause [size]|stepmul [size]|sweeptime [usec]\n");
 		return;
 	}
 	if (stricmp(argv[1], "stop") == 0)
@@ -773,4 +825,16 @@ CCMD(gc)
 			GC::StepMul = MAX(100, atoi(argv[2]));
 		}
 	}
+	// [ZA]
+	else if (stricmp(argv[1], "sweeptime") == 0)
+	{
+		if (argv.argc() == 2)
+		{
+			Printf ("Current GC sweep time is %d microseconds per tic\n", GC::SweepTime);
+		}
+		else
+		{
+			GC::SweepTime = MAX(0, atoi(argv[2]));
+		}
+	}
 }
@@ -665,6 +665,10 @@ void FArchive::AttachToFile (FFile &file)
 	unsigned int i;
 
 	m_HubTravel = false;
+	m_DemoKeyframe = false;
+	m_WorldDelta = false;
+	m_Fingerprint = false;
+	m_FingerprintObjects = false;
 	m_File = &file;
 	m_MaxObjectCount = m_ObjectCount = 0;
 	m_ObjectMap = NULL;
@@ -771,6 +775,13 @@ void FArchive::WriteName (const char *name)
 		id = NIL_NAME;
 		Write (&id, 1);
 	}
+	else if (m_Fingerprint)
+	{
+		// [ZA] The name table would make the data depend on what was written before.
+		id = NEW_NAME;
+		Write (&id, 1);
+		WriteString (name);
+	}
 	else
 	{
 		DWORD index = FindName (name);
@@ -1049,7 +1060,22 @@ FArchive &FArchive::WriteObject (DObject *obj)
 	player_t *player;
 	BYTE id[2];
 
-	if (obj == NULL)
+	if (m_Fingerprint)
+	{
+		// [ZA] Objects don't keep their identity across a level reload, so
+		// all that matters to a fingerprint is that there is one.
+		if (obj == NULL || obj == (DObject*)~0 || (obj->ObjectFlags & OF_EuthanizeMe))
+		{
+			id[0] = obj == (DObject*)~0 ? M1_OBJ : NULL_OBJ;
+		}
+		else
+		{
+			id[0] = NEW_OBJ;
+			m_FingerprintObjects = true;
+		}
+		Write (id, 1);
+	}
+	else if (obj == NULL)
 	{
 		id[0] = NULL_OBJ;
 		Write (id, 1);
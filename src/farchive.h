@@ -125,6 +125,8 @@ public:
 	void Close ();
 	bool IsOpen () const;
 	void GetSizes(unsigned int &one, unsigned int &two) const;
+	// [ZA] The compressed data (including its 8 byte size header), valid after Close.
+	const unsigned char *GetImplodedBuffer () const { return m_ImplodedBuffer; }
 
 	void Serialize (FArchive &arc);
 
@@ -159,6 +161,17 @@ public:
 		inline bool IsPeristent () const { return m_Persistent; }
 		
 		void SetHubTravel () { m_HubTravel = true; }
+		// [ZA] Client demo keyframes keep the network IDs of the actors they store.
+		void SetDemoKeyframe () { m_DemoKeyframe = true; }
+		inline bool IsDemoKeyframe () const { return m_DemoKeyframe; }
+		// [ZA] Level snapshots may leave out the parts of the world that match the freshly loaded map.
+		void SetWorldDelta () { m_WorldDelta = true; }
+		inline bool IsWorldDelta () const { return m_WorldDelta; }
+		// [ZA] Fingerprint archives are only hashed, never read back, so names are always
+		// written out in full and objects are reduced to whether there is one at all.
+		void SetFingerprint () { m_Fingerprint = true; }
+		void ResetFingerprintObjects () { m_FingerprintObjects = false; }
+		inline bool HasFingerprintObjects () const { return m_FingerprintObjects; }
 
 		void Close ();
 
@@ -221,6 +234,10 @@ protected:
 		bool m_Loading;			// extracting objects?
 		bool m_Storing;			// inserting objects?
 		bool m_HubTravel;		// travelling inside a hub?
+		bool m_DemoKeyframe;	// [ZA] storing / restoring a client demo keyframe?
+		bool m_WorldDelta;		// [ZA] storing only the changed parts of the world?
+		bool m_Fingerprint;		// [ZA] only hashing the data?
+		bool m_FingerprintObjects;	// [ZA] were any objects written to the fingerprint?
 		FFile *m_File;			// unerlying file object
 		DWORD m_ObjectCount;	// # of objects currently serialized
 		DWORD m_MaxObjectCount;
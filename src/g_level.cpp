@@ -1542,6 +1542,7 @@ void G_DoLoadLevel (int position, bool autosave)
 	}
 
 	level.starttime = gametic;
+	P_CaptureWorldBaseline ();	// [ZA] Must happen before the snapshot is applied.
 	G_UnSnapshotLevel (!savegamerestore);	// [RH] Restore the state of the level.
 
 	// [BB] If the snapshot was taken with less players than we have now (possible due to ingame joining),
@@ -2202,7 +2203,8 @@ void G_SerializeLevel (FArchive &arc, bool hubLoad)
 	int i = level.totaltime;
 	
 	// [BC] In client mode, we just want to save the lines we've seen.
-	if ( NETWORK_InClientMode() )
+	// [ZA] Unless we are storing a keyframe of a client demo, these need everything.
+	if ( NETWORK_InClientMode() && ( arc.IsDemoKeyframe( ) == false ))
 	{
 		P_SerializeWorld( arc );
 		return;
@@ -2365,6 +2367,8 @@ void G_SnapshotLevel ()
 		level.info->snapshot->Open ();
 
 		FArchive arc (*level.info->snapshot);
+		// [ZA] Leave out everything that restoring the snapshot gets from loading the map anyway.
+		arc.SetWorldDelta ();
 
 		SaveVersion = SAVEVER;
 		G_SerializeLevel (arc, false);
@@ -25,6 +25,12 @@
 #include <stdlib.h>
 #include "mystdint.h"
 
+/* [ZA] SSE2 is always there on x86-64 */
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define HQX_SSE2
+#include <emmintrin.h>
+#endif
+
 #define MASK_2     0x0000FF00
 #define MASK_13    0x00FF00FF
 #define MASK_RGB   0x00FFFFFF
@@ -58,6 +64,70 @@ static inline int Diff(uint32_t c1, uint32_t c2)
     return yuv_diff(rgb_to_yuv(c1), rgb_to_yuv(c2));
 }
 
+#ifdef HQX_SSE2
+/* [ZA] yuv_diff on four colors at once, as a 4-bit mask */
+static inline int yuv_diff4(__m128i yuv1, __m128i yuv2)
+{
+    __m128i dy = _mm_sub_epi32(_mm_and_si128(yuv1, _mm_set1_epi32(Ymask)), _mm_and_si128(yuv2, _mm_set1_epi32(Ymask)));
+    __m128i du = _mm_sub_epi32(_mm_and_si128(yuv1, _mm_set1_epi32(Umask)), _mm_and_si128(yuv2, _mm_set1_epi32(Umask)));
+    __m128i dv = _mm_sub_epi32(_mm_and_si128(yuv1, _mm_set1_epi32(Vmask)), _mm_and_si128(yuv2, _mm_set1_epi32(Vmask)));
+
+    // The channels are at most 24 bits wide, so 32-bit lanes cannot overflow.
+    __m128i sign = _mm_srai_epi32(dy, 31);
+    dy = _mm_sub_epi32(_mm_xor_si128(dy, sign), sign);
+    sign = _mm_srai_epi32(du, 31);
+    du = _mm_sub_epi32(_mm_xor_si128(du, sign), sign);
+    sign = _mm_srai_epi32(dv, 31);
+    dv = _mm_sub_epi32(_mm_xor_si128(dv, sign), sign);
+
+    __m128i diff = _mm_or_si128(_mm_or_si128(
+        _mm_cmpgt_epi32(dy, _mm_set1_epi32(trY)),
+        _mm_cmpgt_epi32(du, _mm_set1_epi32(trU))),
+        _mm_cmpgt_epi32(dv, _mm_set1_epi32(trV)));
+    return _mm_movemask_ps(_mm_castsi128_ps(diff));
+}
+#endif
+
+/* [ZA] Which of the 8 neighbours w[1..4] and w[6..9] differ from w[5], one
+ * yuv_diff at a time. This is the reference for hqx_pattern.
+ * Neighbours equal to w[5] never differ, so their (uncached) table lookup is skipped. */
+static inline int hqx_pattern_c(const uint32_t *w)
+{
+    const uint32_t yuv5 = rgb_to_yuv(w[5]);
+    int pattern = 0;
+    int flag = 1;
+    for (int k = 1; k <= 9; k++)
+    {
+        if (k == 5) continue;
+
+        if ( w[k] != w[5] )
+        {
+            if (yuv_diff(yuv5, rgb_to_yuv(w[k])))
+                pattern |= flag;
+        }
+        flag <<= 1;
+    }
+    return pattern;
+}
+
+/* [ZA] Same as hqx_pattern_c, eight comparisons at a time where SSE2 is available */
+static inline int hqx_pattern(const uint32_t *w)
+{
+#ifdef HQX_SSE2
+    const uint32_t yuv5 = rgb_to_yuv(w[5]);
+    uint32_t yuv[10];
+    for (int k = 1; k <= 9; k++)
+    {
+        yuv[k] = (w[k] == w[5]) ? yuv5 : rgb_to_yuv(w[k]);
+    }
+    const __m128i center = _mm_set1_epi32(yuv5);
+    return yuv_diff4(center, _mm_setr_epi32(yuv[1], yuv[2], yuv[3], yuv[4])) |
+        (yuv_diff4(center, _mm_setr_epi32(yuv[6], yuv[7], yuv[8], yuv[9])) << 4);
+#else
+    return hqx_pattern_c(w);
+#endif
+}
+
 /* Interpolate functions */
 static inline uint32_t Interpolate_2(uint32_t c1, int w1, uint32_t c2, int w2, int s)
 {
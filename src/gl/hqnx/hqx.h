@@ -52,4 +52,16 @@ HQX_API void HQX_CALLCONV hq2x_32_rb( uint32_t * src, uint32_t src_rowBytes, uin
 HQX_API void HQX_CALLCONV hq3x_32_rb( uint32_t * src, uint32_t src_rowBytes, uint32_t * dest, uint32_t dest_rowBytes, int width, int height );
 HQX_API void HQX_CALLCONV hq4x_32_rb( uint32_t * src, uint32_t src_rowBytes, uint32_t * dest, uint32_t dest_rowBytes, int width, int height );
 
+/* [ZA] Scale only the source rows [firstRow, lastRow) of the image. Different row
+ * ranges of the same image can be scaled on different threads at the same time. */
+HQX_API void HQX_CALLCONV hq2x_32_rows( uint32_t * src, uint32_t src_rowBytes, uint32_t * dest, uint32_t dest_rowBytes, int width, int height, int firstRow, int lastRow );
+HQX_API void HQX_CALLCONV hq3x_32_rows( uint32_t * src, uint32_t src_rowBytes, uint32_t * dest, uint32_t dest_rowBytes, int width, int height, int firstRow, int lastRow );
+HQX_API void HQX_CALLCONV hq4x_32_rows( uint32_t * src, uint32_t src_rowBytes, uint32_t * dest, uint32_t dest_rowBytes, int width, int height, int firstRow, int lastRow );
+
+/* [ZA] The same, but classifying neighbours with the scalar hqx_pattern_c. Only used to
+ * check the faster classifier. */
+HQX_API void HQX_CALLCONV hq2x_32_rows_c( uint32_t * src, uint32_t src_rowBytes, uint32_t * dest, uint32_t dest_rowBytes, int width, int height, int firstRow, int lastRow );
+HQX_API void HQX_CALLCONV hq3x_32_rows_c( uint32_t * src, uint32_t src_rowBytes, uint32_t * dest, uint32_t dest_rowBytes, int width, int height, int firstRow, int lastRow );
+HQX_API void HQX_CALLCONV hq4x_32_rows_c( uint32_t * src, uint32_t src_rowBytes, uint32_t * dest, uint32_t dest_rowBytes, int width, int height, int firstRow, int lastRow );
+
 #endif
@@ -43,6 +43,12 @@
 #ifdef _MSC_VER
 #include "gl/hqnx_asm/hqnx_asm.h"
 #endif
+// [ZA] New #includes.
+#include <thread>
+#include <vector>
+#include "c_dispatch.h"
+#include "stats.h"
+#include "textures/bitmap.h"
 
 CUSTOM_CVAR(Int, gl_texture_hqresize, 0, CVAR_ARCHIVE | CVAR_GLOBALCONFIG | CVAR_NOINITCALL)
 {
@@ -66,6 +72,9 @@ CVAR (Flag, gl_texture_hqresize_textures, gl_texture_hqresize_targets, 1);
 CVAR (Flag, gl_texture_hqresize_sprites, gl_texture_hqresize_targets, 2);
 CVAR (Flag, gl_texture_hqresize_fonts, gl_texture_hqresize_targets, 4);
 
+// [ZA] How many threads the hqNx scalers split a texture across. 0 means one per core.
+CVAR (Int, gl_texture_hqresize_threads, 0, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)
+
 
 static void scale2x ( uint32* inputBuffer, uint32* outputBuffer, int inWidth, int inHeight )
 {
@@ -214,7 +223,74 @@ static unsigned char *hqNxAsmHelper( void (*hqNxFunction) ( int*, unsigned char*
 }
 #endif
 
-static unsigned char *hqNxHelper( void (*hqNxFunction) ( unsigned*, unsigned*, int, int ),
+typedef void (HQX_CALLCONV *hqNxRowsFunction) ( uint32_t*, uint32_t, uint32_t*, uint32_t, int, int, int, int );
+
+//===========================================================================
+// 
+// [ZA] Runs an hqNx scaler on inputBuffer, splitting the rows between up to
+//  numThreads threads. Every thread reads the rows around its own, so the
+//  result does not depend on how the rows were split.
+//
+//===========================================================================
+
+// Textures smaller than this are not worth starting a thread for.
+static const int HQNX_MIN_PIXELS_PER_THREAD = 64*64;
+
+static void hqNxScale( hqNxRowsFunction hqNxFunction, const int N, uint32_t *inputBuffer, uint32_t *outputBuffer,
+					   const int inWidth, const int inHeight, int numThreads )
+{
+	const uint32_t srcRowBytes = inWidth * 4;
+	const uint32_t destRowBytes = inWidth * N * 4;
+
+	numThreads = MIN( numThreads, inHeight );
+	numThreads = MIN( numThreads, MAX( 1, ( inWidth * inHeight ) / HQNX_MIN_PIXELS_PER_THREAD ) );
+
+	if ( numThreads <= 1 )
+	{
+		hqNxFunction( inputBuffer, srcRowBytes, outputBuffer, destRowBytes, inWidth, inHeight, 0, inHeight );
+		return;
+	}
+
+	std::vector<std::thread> workers;
+	for ( int i = 1; i < numThreads; ++i )
+	{
+		workers.emplace_back( hqNxFunction, inputBuffer, srcRowBytes, outputBuffer, destRowBytes, inWidth, inHeight,
+							  i * inHeight / numThreads, ( i + 1 ) * inHeight / numThreads );
+	}
+	hqNxFunction( inputBuffer, srcRowBytes, outputBuffer, destRowBytes, inWidth, inHeight, 0, inHeight / numThreads );
+	for ( unsigned int i = 0; i < workers.size(); ++i )
+	{
+		workers[i].join();
+	}
+}
+
+static int hqNxNumThreads()
+{
+	int numThreads = gl_texture_hqresize_threads;
+	if ( numThreads <= 0 )
+		numThreads = static_cast<int>( std::thread::hardware_concurrency() );
+	return clamp( numThreads, 1, 64 );
+}
+
+//===========================================================================
+// 
+// [ZA] hqxInit allocates the RGB to YUV table, so it must only run once
+//  however the scalers are first used.
+//
+//===========================================================================
+
+static void hqNxEnsureInit()
+{
+	static bool initdone = false;
+
+	if ( !initdone )
+	{
+		hqxInit();
+		initdone = true;
+	}
+}
+
+static unsigned char *hqNxHelper( hqNxRowsFunction hqNxFunction,
 							  const int N,
 							  unsigned char *inputBuffer,
 							  const int inWidth,
@@ -222,18 +298,13 @@ static unsigned char *hqNxHelper( void (*hqNxFunction) ( unsigned*, unsigned*, i
 							  int &outWidth,
 							  int &outHeight )
 {
-	static int initdone = false;
+	hqNxEnsureInit();
 
-	if (!initdone)
-	{
-		hqxInit();
-		initdone = true;
-	}
 	outWidth = N * inWidth;
 	outHeight = N *inHeight;
 
 	unsigned char * newBuffer = new unsigned char[outWidth*outHeight*4];
-	hqNxFunction( reinterpret_cast<unsigned*>(inputBuffer), reinterpret_cast<unsigned*>(newBuffer), inWidth, inHeight );
+	hqNxScale( hqNxFunction, N, reinterpret_cast<uint32_t*>(inputBuffer), reinterpret_cast<uint32_t*>(newBuffer), inWidth, inHeight, hqNxNumThreads() );
 	delete[] inputBuffer;
 	return newBuffer;
 }
@@ -302,11 +373,11 @@ unsigned char *gl_CreateUpsampledTextureBuffer ( const FTexture *inputTexture, u
 		case 3:
 			return scaleNxHelper( &scale4x, 4, inputBuffer, inWidth, inHeight, outWidth, outHeight );
 		case 4:
-			return hqNxHelper( &hq2x_32, 2, inputBuffer, inWidth, inHeight, outWidth, outHeight );
+			return hqNxHelper( &hq2x_32_rows, 2, inputBuffer, inWidth, inHeight, outWidth, outHeight );
 		case 5:
-			return hqNxHelper( &hq3x_32, 3, inputBuffer, inWidth, inHeight, outWidth, outHeight );
+			return hqNxHelper( &hq3x_32_rows, 3, inputBuffer, inWidth, inHeight, outWidth, outHeight );
 		case 6:
-			return hqNxHelper( &hq4x_32, 4, inputBuffer, inWidth, inHeight, outWidth, outHeight );
+			return hqNxHelper( &hq4x_32_rows, 4, inputBuffer, inWidth, inHeight, outWidth, outHeight );
 #ifdef _MSC_VER
 		case 7:
 			return hqNxAsmHelper( &HQnX_asm::hq2x_32, 2, inputBuffer, inWidth, inHeight, outWidth, outHeight );
@@ -319,3 +390,94 @@ unsigned char *gl_CreateUpsampledTextureBuffer ( const FTexture *inputTexture, u
 	}
 	return inputBuffer;
 }
+
+//===========================================================================
+// 
+// [ZA] CCMD hqresizebench
+//
+// Runs an hqNx scaler over every loaded texture that gl_texture_hqresize
+// would scale, once on a single thread and once split across threads, and
+// checks that both give the same result. Every texture is also scaled with
+// the scalar yuv_diff classifier, which both results must match. Load a
+// standard IWAD for numbers that can be compared between machines.
+//
+// hqresizebench [2|3|4]
+//
+//===========================================================================
+
+CCMD( hqresizebench )
+{
+	const int N = ( argv.argc() > 1 ) ? atoi( argv[1] ) : 4;
+	hqNxRowsFunction hqNxFunction, hqNxReference;
+
+	switch ( N )
+	{
+	case 2: hqNxFunction = hq2x_32_rows; hqNxReference = hq2x_32_rows_c; break;
+	case 3: hqNxFunction = hq3x_32_rows; hqNxReference = hq3x_32_rows_c; break;
+	case 4: hqNxFunction = hq4x_32_rows; hqNxReference = hq4x_32_rows_c; break;
+	default:
+		Printf( "Usage: hqresizebench [2|3|4]\n" );
+		return;
+	}
+
+	hqNxEnsureInit();
+
+	const int numThreads = hqNxNumThreads();
+	cycle_t referenceTime, singleTime, threadedTime;
+	int numTextures = 0, numMismatches = 0, numReferenceMismatches = 0;
+	QWORD numPixels = 0;
+
+	referenceTime.Reset();
+	singleTime.Reset();
+	threadedTime.Reset();
+
+	for ( int i = 0; i < TexMan.NumTextures(); ++i )
+	{
+		FTexture *tex = TexMan.ByIndex( i );
+		if ( tex == NULL || tex->UseType == FTexture::TEX_Null || tex->bHasCanvas )
+			continue;
+
+		const int width = tex->GetWidth();
+		const int height = tex->GetHeight();
+		if ( width <= 0 || height <= 0 || width > gl_texture_hqresize_maxinputsize || height > gl_texture_hqresize_maxinputsize )
+			continue;
+
+		FBitmap bmp;
+		if ( !bmp.Create( width, height ) )
+			continue;
+		tex->CopyTrueColorPixels( &bmp, 0, 0 );
+
+		uint32_t *input = reinterpret_cast<uint32_t*>( bmp.GetPixels() );
+		std::vector<uint32_t> reference( width * height * N * N );
+		std::vector<uint32_t> single( width * height * N * N );
+		std::vector<uint32_t> threaded( width * height * N * N );
+
+		referenceTime.Clock();
+		hqNxScale( hqNxReference, N, input, &reference[0], width, height, 1 );
+		referenceTime.Unclock();
+
+		singleTime.Clock();
+		hqNxScale( hqNxFunction, N, input, &single[0], width, height, 1 );
+		singleTime.Unclock();
+
+		threadedTime.Clock();
+		hqNxScale( hqNxFunction, N, input, &threaded[0], width, height, numThreads );
+		threadedTime.Unclock();
+
+		if ( single != reference )
+			++numReferenceMismatches;
+		if ( single != threaded )
+			++numMismatches;
+		++numTextures;
+		numPixels += width * height;
+	}
+
+	Printf( "hq%dx: %d textures, %llu source pixels\n", N, numTextures, (unsigned long long)numPixels );
+	Printf( "  scalar classifier, 1 thread: %.1f ms\n", referenceTime.TimeMS() );
+	Printf( "  1 thread: %.1f ms\n", singleTime.TimeMS() );
+	Printf( "  %d threads: %.1f ms\n", numThreads, threadedTime.TimeMS() );
+	if ( numReferenceMismatches > 0 )
+		Printf( TEXTCOLOR_RED "  %d textures were scaled differently from the scalar classifier!\n", numReferenceMismatches );
+	if ( numMismatches > 0 )
+		Printf( TEXTCOLOR_RED "  %d textures were scaled differently by the threaded scaler!\n", numMismatches );
+}
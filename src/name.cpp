@@ -36,6 +36,9 @@
 #include "name.h"
 #include "c_dispatch.h"
 #include "c_console.h"
+// [ZA] New #includes.
+#include "stats.h"
+#include "templates.h"
 
 // MACROS ------------------------------------------------------------------
 
@@ -69,9 +72,14 @@ FName::NameManager FName::NameData;
 bool FName::NameManager::Inited;
 
 // Define the predefined names.
-static const char *PredefinedNames[] =
+// [ZA] Their lengths are known at compile time, too.
+static const struct PredefinedName
 {
-#define xx(n) #n,
+	const char *Text;
+	size_t Length;
+} PredefinedNames[] =
+{
+#define xx(n) { #n, sizeof(#n) - 1 },
 #include "namedef.h"
 #undef xx
 };
@@ -90,37 +98,11 @@ static const char *PredefinedNames[] =
 
 int FName::NameManager::FindName (const char *text, bool noCreate)
 {
-	if (!Inited)
-	{
-		InitBuckets ();
-	}
-
 	if (text == NULL)
 	{
 		return 0;
 	}
-
-	unsigned int hash = MakeKey (text);
-	unsigned int bucket = hash % HASH_SIZE;
-	int scanner = Buckets[bucket];
-
-	// See if the name already exists.
-	while (scanner >= 0)
-	{
-		if (NameArray[scanner].Hash == hash && stricmp (NameArray[scanner].Text, text) == 0)
-		{
-			return scanner;
-		}
-		scanner = NameArray[scanner].NextHash;
-	}
-
-	// If we get here, then the name does not exist.
-	if (noCreate)
-	{
-		return 0;
-	}
-
-	return AddName (text, hash, bucket);
+	return FindName (text, strlen (text), noCreate);
 }
 
 //==========================================================================
@@ -128,6 +110,9 @@ int FName::NameManager::FindName (const char *text, bool noCreate)
 // The same as above, but the text length is also passed, for creating
 // a name from a substring or for speed if the length is already known.
 //
+// [ZA] The table is open addressed with linear probing. A slot is only
+// compared by text if both the hash and the length match.
+//
 //==========================================================================
 
 int FName::NameManager::FindName (const char *text, size_t textLen, bool noCreate)
@@ -143,19 +128,23 @@ int FName::NameManager::FindName (const char *text, size_t textLen, bool noCreat
 	}
 
 	unsigned int hash = MakeKey (text, textLen);
-	unsigned int bucket = hash % HASH_SIZE;
-	int scanner = Buckets[bucket];
+	unsigned int slot = hash & TableMask;
+
+	Lookups++;
 
 	// See if the name already exists.
-	while (scanner >= 0)
+	while (Table[slot].Index >= 0)
 	{
-		if (NameArray[scanner].Hash == hash &&
-			strnicmp (NameArray[scanner].Text, text, textLen) == 0 &&
-			NameArray[scanner].Text[textLen] == '\0')
+		if (Table[slot].Hash == hash)
 		{
-			return scanner;
+			const NameEntry &entry = NameArray[Table[slot].Index];
+			if (entry.Length == textLen && strnicmp (entry.Text, text, textLen) == 0)
+			{
+				return Table[slot].Index;
+			}
 		}
-		scanner = NameArray[scanner].NextHash;
+		slot = (slot + 1) & TableMask;
+		Probes++;
 	}
 
 	// If we get here, then the name does not exist.
@@ -164,7 +153,7 @@ int FName::NameManager::FindName (const char *text, size_t textLen, bool noCreat
 		return 0;
 	}
 
-	return AddName (text, hash, bucket);
+	return AddName (text, textLen, hash);
 }
 
 //==========================================================================
@@ -178,12 +167,46 @@ int FName::NameManager::FindName (const char *text, size_t textLen, bool noCreat
 void FName::NameManager::InitBuckets ()
 {
 	Inited = true;
-	memset (Buckets, -1, sizeof(Buckets));
+	ResizeTable (MIN_TABLE_SIZE);
 
 	// Register built-in names. 'None' must be name 0.
+	// [ZA] They are all different, so they can be added without looking
+	// them up first.
 	for (size_t i = 0; i < countof(PredefinedNames); ++i)
 	{
-		FindName (PredefinedNames[i], false);
+		AddName (PredefinedNames[i].Text, PredefinedNames[i].Length,
+			MakeKey (PredefinedNames[i].Text, PredefinedNames[i].Length));
+	}
+}
+
+//==========================================================================
+//
+// [ZA] FName :: NameManager :: ResizeTable
+//
+// Allocates a hash table with the given number of slots, which must be a
+// power of two, and puts every existing name into it.
+//
+//==========================================================================
+
+void FName::NameManager::ResizeTable (unsigned int size)
+{
+	if (Table != NULL)
+	{
+		M_Free (Table);
+	}
+	Table = (NameSlot *)M_Malloc (size * sizeof(NameSlot));
+	memset (Table, -1, size * sizeof(NameSlot));
+	TableMask = size - 1;
+
+	for (int i = 0; i < NumNames; ++i)
+	{
+		unsigned int slot = NameArray[i].Hash & TableMask;
+		while (Table[slot].Index >= 0)
+		{
+			slot = (slot + 1) & TableMask;
+		}
+		Table[slot].Hash = NameArray[i].Hash;
+		Table[slot].Index = i;
 	}
 }
 
@@ -195,11 +218,11 @@ void FName::NameManager::InitBuckets ()
 //
 //==========================================================================
 
-int FName::NameManager::AddName (const char *text, unsigned int hash, unsigned int bucket)
+int FName::NameManager::AddName (const char *text, size_t textLen, unsigned int hash)
 {
 	char *textstore;
 	NameBlock *block = Blocks;
-	size_t len = strlen (text) + 1;
+	size_t len = textLen + 1;
 
 	// Get a block large enough for the name. Only the first block in the
 	// list is ever considered for name storage.
@@ -210,7 +233,8 @@ int FName::NameManager::AddName (const char *text, unsigned int hash, unsigned i
 
 	// Copy the string into the block.
 	textstore = (char *)block + block->NextAlloc;
-	strcpy (textstore, text);
+	memcpy (textstore, text, textLen);
+	textstore[textLen] = '\0';
 	block->NextAlloc += len;
 
 	// Add an entry for the name to the NameArray
@@ -225,8 +249,23 @@ int FName::NameManager::AddName (const char *text, unsigned int hash, unsigned i
 
 	NameArray[NumNames].Text = textstore;
 	NameArray[NumNames].Hash = hash;
-	NameArray[NumNames].NextHash = Buckets[bucket];
-	Buckets[bucket] = NumNames;
+	NameArray[NumNames].Length = (unsigned int)textLen;
+
+	// [ZA] Keep the table at most half full, so probe sequences stay short.
+	if ((unsigned int)(NumNames + 1) * 2 > TableMask + 1)
+	{
+		NumNames++;
+		ResizeTable ((TableMask + 1) * 2);
+		return NumNames - 1;
+	}
+
+	unsigned int slot = hash & TableMask;
+	while (Table[slot].Index >= 0)
+	{
+		slot = (slot + 1) & TableMask;
+	}
+	Table[slot].Hash = hash;
+	Table[slot].Index = NumNames;
 
 	return NumNames++;
 }
@@ -283,7 +322,15 @@ FName::NameManager::~NameManager()
 		NameArray = NULL;
 	}
 	NumNames = MaxNames = 0;
-	memset (Buckets, -1, sizeof(Buckets));
+
+	// [ZA] Any name created after this point starts a new table.
+	if (Table != NULL)
+	{
+		M_Free (Table);
+		Table = NULL;
+	}
+	TableMask = 0;
+	Inited = false;
 }
 
 //==========================================================================
@@ -296,3 +343,87 @@ bool FName::IsPredefined() const
 {
 	return static_cast<unsigned>( Index ) < countof( PredefinedNames );
 }
+
+//==========================================================================
+//
+// [ZA] FName :: RunBenchmark
+//
+// Looks up every name that exists so far the given number of times, once
+// from a C string and once with its length already known, the way the
+// parsers and the network code do. After startup the table holds every
+// name that DECORATE, MAPINFO and the other lumps created.
+//
+//==========================================================================
+
+void FName::RunBenchmark (int rounds)
+{
+	NameManager &data = NameData;
+	const int numnames = data.NumNames;
+	TArray<FString> texts;
+	cycle_t cstr, withlen;
+	int dummy = 0;
+
+	if (numnames == 0)
+	{
+		return;
+	}
+
+	Printf ("%u lookups so far, %.2f extra probes per lookup\n",
+		data.Lookups, data.Lookups > 0 ? double(data.Probes) / data.Lookups : 0.);
+
+	// Copy the names, so that the comparisons can't just match pointers,
+	// and change their case, because lookups are case insensitive.
+	texts.Resize (numnames);
+	for (int i = 0; i < numnames; ++i)
+	{
+		texts[i] = data.NameArray[i].Text;
+		texts[i].ToUpper ();
+	}
+
+	cstr.Reset ();
+	withlen.Reset ();
+	for (int r = 0; r < rounds; ++r)
+	{
+		cstr.Clock ();
+		for (int i = 0; i < numnames; ++i)
+		{
+			dummy += data.FindName (texts[i].GetChars(), true);
+		}
+		cstr.Unclock ();
+
+		withlen.Clock ();
+		for (int i = 0; i < numnames; ++i)
+		{
+			dummy += data.FindName (texts[i].GetChars(), texts[i].Len(), true);
+		}
+		withlen.Unclock ();
+	}
+
+	const double total = double(numnames) * rounds;
+	Printf ("%d names, %u slots, %d rounds\n", numnames, data.TableMask + 1, rounds);
+	Printf ("From C strings:   %.3f ms, %.0f lookups/ms\n", cstr.TimeMS(), total / MAX (cstr.TimeMS(), 0.001));
+	Printf ("With known length: %.3f ms, %.0f lookups/ms\n", withlen.TimeMS(), total / MAX (withlen.TimeMS(), 0.001));
+
+	// Keep the lookups from being optimized away.
+	if (dummy == -1)
+	{
+		Printf ("\n");
+	}
+}
+
+//==========================================================================
+//
+// [ZA] CCMD namebench
+//
+//==========================================================================
+
+CCMD (namebench)
+{
+	int rounds = 100;
+
+	if (argv.argc() > 1)
+	{
+		rounds = clamp (atoi (argv[1]), 1, 100000);
+	}
+	FName::RunBenchmark (rounds);
+}
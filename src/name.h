@@ -89,6 +89,9 @@ public:
 	// [TP]
 	bool IsPredefined() const;
 
+	// [ZA] Used by the namebench console command.
+	static void RunBenchmark (int rounds);
+
 protected:
 	int Index;
 
@@ -96,7 +99,15 @@ protected:
 	{
 		char *Text;
 		unsigned int Hash;
-		int NextHash;
+		unsigned int Length;	// [ZA] Without the terminating 0.
+	};
+
+	// [ZA] One slot of the open addressed hash table. The hash is kept here
+	// as well, so that probing past other names doesn't touch NameArray.
+	struct NameSlot
+	{
+		unsigned int Hash;
+		int Index;
 	};
 
 	struct NameManager
@@ -106,19 +117,22 @@ protected:
 		// means this struct must only exist in the program's BSS section.
 		~NameManager();
 
-		enum { HASH_SIZE = 1024 };
+		enum { MIN_TABLE_SIZE = 4096 };
 		struct NameBlock;
 
 		NameBlock *Blocks;
 		NameEntry *NameArray;
 		int NumNames, MaxNames;
-		int Buckets[HASH_SIZE];
+		NameSlot *Table;
+		unsigned int TableMask;
+		unsigned int Lookups, Probes;
 
 		int FindName (const char *text, bool noCreate);
 		int FindName (const char *text, size_t textlen, bool noCreate);
-		int AddName (const char *text, unsigned int hash, unsigned int bucket);
+		int AddName (const char *text, size_t textlen, unsigned int hash);
 		NameBlock *AddBlock (size_t len);
 		void InitBuckets ();
+		void ResizeTable (unsigned int size);
 		static bool Inited;
 	};
 
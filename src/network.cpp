@@ -932,7 +932,7 @@ NETADDRESS_s NETWORK_GetFromAddress( void )
 
 //*****************************************************************************
 //
-void NETWORK_LaunchPacket( NETBUFFER_s *pBuffer, NETADDRESS_s Address )
+LONG NETWORK_LaunchPacket( NETBUFFER_s *pBuffer, NETADDRESS_s Address )
 {
 	LONG				lNumBytes;
 	INT					iNumBytesOut = sizeof(g_ucHuffmanBuffer);
@@ -941,7 +941,7 @@ void NETWORK_LaunchPacket( NETBUFFER_s *pBuffer, NETADDRESS_s Address )
 
 	// Nothing to do.
 	if ( pBuffer->ulCurrentSize == 0 )
-		return;
+		return 0;
 
 	// Convert the IP address to a socket address.
 	struct sockaddr_in SocketAddress;
@@ -968,37 +968,37 @@ void NETWORK_LaunchPacket( NETBUFFER_s *pBuffer, NETADDRESS_s Address )
 
 		// Wouldblock is silent.
 		if ( iError == WSAEWOULDBLOCK )
-			return;
+			return 0;
 
 		switch ( iError )
 		{
 		case WSAEACCES:
 
 			Printf( "NETWORK_LaunchPacket: Error #%d, WSAEACCES: Permission denied for address: %s\n", iError, Address.ToString() );
-			return;
+			return 0;
 		case WSAEAFNOSUPPORT:
 
 			Printf( "NETWORK_LaunchPacket: Error #%d, WSAEAFNOSUPPORT: Address %s incompatible with the requested protocol\n", iError, Address.ToString() );
-			return;
+			return 0;
 		case WSAEADDRNOTAVAIL:
 
 			Printf( "NETWORK_LaunchPacket: Error #%d, WSAEADDRENOTAVAIL: Address %s not available\n", iError, Address.ToString() );
-			return;
+			return 0;
 		case WSAEHOSTUNREACH:
 
 			Printf( "NETWORK_LaunchPacket: Error #%d, WSAEHOSTUNREACH: Address %s unreachable\n", iError, Address.ToString() );
-			return;				
+			return 0;				
 		default:
 
 			Printf( "NETWORK_LaunchPacket: Error #%d\n", iError );
-			return;
+			return 0;
 		}
 #else
 	if ( errno == EWOULDBLOCK )
-return;
+return 0;
 
           if ( errno == ECONNREFUSED )
-              return;
+              return 0;
 
 		Printf( "NETWORK_LaunchPacket: %s\n", strerror( errno ));
 		Printf( "NETWORK_LaunchPacket: Address %s\n", Address.ToString() );
@@ -1009,6 +1009,9 @@ return;
 	// Record this for our statistics window.
 	if ( NETWORK_GetState( ) == NETSTATE_SERVER )
 		SERVER_STATISTIC_AddToOutboundDataTransfer( lNumBytes );
+
+	// [ZA] Let the caller know how much actually went over the wire.
+	return ( MAX<LONG>( lNumBytes, 0 ));
 }
 
 //*****************************************************************************
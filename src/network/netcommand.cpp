@@ -47,6 +47,8 @@
 //-----------------------------------------------------------------------------
 
 #include "netcommand.h"
+#include "sv_demo.h"
+#include "nettraffic.h"
 
 //*****************************************************************************
 //
@@ -307,8 +309,49 @@ void NetCommand::sendCommandToClients ( ULONG ulPlayerExtra, ServerCommandFlags
 	if ( ( flags == 0 ) && ( ulPlayerExtra == MAXPLAYERS ) && ( command != SVC_MAPAUTHENTICATE ) && ( command != SVC_DISCONNECTPLAYER ) )
 		flags |= SVCF_SKIP_CLIENTS_WITHOUT_FULLUPDATE;
 
+	// [ZA] A server demo records the command once, not once per client.
+	if ( SERVERDEMO_IsRecording( ))
+		SERVERDEMO_RecordCommand( _buffer.pbData, _buffer.CalcSize( ), ulPlayerExtra, flags );
+
+	// [ZA] Gather the recipients first, so that a broadcast can be written to all of them in one go.
+	ULONG aulClients[MAXPLAYERS];
+	ULONG ulNumClients = 0;
 	for ( ClientIterator it ( ulPlayerExtra, flags ); it.notAtEnd(); ++it )
-		sendCommandToOneClient( *it );
+		aulClients[ulNumClients++] = *it;
+
+	if ( ulNumClients == 1 )
+		sendCommandToOneClient( aulClients[0] );
+	else if ( ulNumClients > 1 )
+		sendCommandToClientList( aulClients, ulNumClients );
+}
+
+//*****************************************************************************
+// [ZA] Does the same as calling sendCommandToOneClient for every client, but
+// checks the size of the command only once and launches all packets the
+// command doesn't fit into anymore before writing it to any of the buffers.
+//
+void NetCommand::sendCommandToClientList( const ULONG *pulClients, const ULONG ulNumClients )
+{
+	const ULONG ulSize = _buffer.CalcSize();
+	const ULONG ulMaxPacketSize = SERVER_GetMaxPacketSize( );
+	const bool bReliable = ( _unreliable == false );
+
+	// [BB] 5 = 1 + 4 (SVC_HEADER + packet number)
+	if ( ulSize + 5 >= ulMaxPacketSize )
+		SERVER_PrintWarning ( "NetCommand %s creates packets exceeding sv_maxpacketsize (%lu >= %lu)!\n", getHeaderAsString(), ulSize + 5, ulMaxPacketSize );
+
+	for ( ULONG ulIdx = 0; ulIdx < ulNumClients; ++ulIdx )
+	{
+		const ULONG ulBufferSize = getBufferForClient( pulClients[ulIdx] ).CalcSize();
+		if (( ulBufferSize > 0 ) && ( ulBufferSize + ulSize + 5 >= ulMaxPacketSize ))
+			SERVER_SendClientPacket( pulClients[ulIdx], bReliable );
+	}
+
+	for ( ULONG ulIdx = 0; ulIdx < ulNumClients; ++ulIdx )
+	{
+		getBytestreamForClient( pulClients[ulIdx] ).WriteBuffer( _buffer.pbData, ulSize );
+		NETTRAFFIC_AddCommandTraffic( pulClients[ulIdx], _buffer.pbData, ulSize, _unreliable );
+	}
 }
 
 //*****************************************************************************
@@ -330,6 +373,7 @@ void NetCommand::sendCommandToOneClient( ULONG i )
 	}
 
 	writeCommandToStream( getBytestreamForClient( i ));
+	NETTRAFFIC_AddCommandTraffic( i, _buffer.pbData, _buffer.ulCurrentSize, _unreliable );
 }
 
 //*****************************************************************************
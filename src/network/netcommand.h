@@ -85,6 +85,8 @@ class NetCommand {
 	NETBUFFER_s	_buffer;
 	bool		_unreliable;
 
+	void sendCommandToClientList ( const ULONG *pulClients, const ULONG ulNumClients );
+
 public:
 	NetCommand ( const SVC Header );
 	NetCommand ( const SVC2 Header2 );
@@ -49,6 +49,9 @@
 #include "network.h"
 #include "c_dispatch.h"
 #include "p_acs.h"
+#include "d_player.h"
+#include "sv_main.h"
+#include "network_enums.h"
 
 #include <map>
 #include <vector>
@@ -70,6 +73,128 @@ std::map<int, int> g_ACSScriptTrafficMap;
 
 CVAR( Bool, sv_measureoutboundtraffic, false, 0 )
 
+// [ZA] Extended commands are counted after the regular ones.
+#define	NUM_NETTRAFFIC_COMMANDS		( NUM_SERVER_COMMANDS + NUM_SVC2_COMMANDS )
+
+struct NetTrafficCounter
+{
+	unsigned int	Count;
+	unsigned int	Bytes;
+	unsigned int	EncodedBytes;
+};
+
+// [ZA] Everything the server sent during one second.
+struct NetTrafficSample
+{
+	// Indexed by command, then reliable (0) or unreliable (1).
+	NetTrafficCounter	Commands[NUM_NETTRAFFIC_COMMANDS][2];
+	NetTrafficCounter	Clients[MAXPLAYERS][NUM_NETTRAFFICKINDS];
+};
+
+static	std::vector<NetTrafficSample>	g_TrafficHistory;
+static	ULONG						g_ulCurrentTrafficSample = 0;
+static	ULONG						g_ulNumTrafficSamples = 0;
+static	ULONG						g_ulTrafficSampleTics = 0;
+
+// [ZA] Bytes of each command sent to each client since the last reset.
+static	std::vector<unsigned int>		g_ClientCommandTraffic;
+
+static	const char	*g_pszTrafficKindNames[NUM_NETTRAFFICKINDS] =
+{
+	"reliable",
+	"unreliable",
+	"retransmitted",
+};
+
+//*****************************************************************************
+//	FUNCTIONS
+
+static bool nettraffic_IsMeasuring( void )
+{
+	return (( NETWORK_GetState( ) == NETSTATE_SERVER ) && sv_measureoutboundtraffic );
+}
+
+//*****************************************************************************
+//
+static NetTrafficSample &nettraffic_GetCurrentSample( void )
+{
+	if ( g_TrafficHistory.empty( ))
+	{
+		g_TrafficHistory.resize( NETTRAFFIC_HISTORY_SECONDS );
+		memset( &g_TrafficHistory[0], 0, sizeof( NetTrafficSample ) * g_TrafficHistory.size( ));
+		g_ClientCommandTraffic.assign( MAXPLAYERS * NUM_NETTRAFFIC_COMMANDS, 0 );
+		g_ulCurrentTrafficSample = 0;
+		g_ulNumTrafficSamples = 1;
+		g_ulTrafficSampleTics = 0;
+	}
+
+	return ( g_TrafficHistory[g_ulCurrentTrafficSample] );
+}
+
+//*****************************************************************************
+//
+static int nettraffic_GetCommandIndex( const BYTE *pbCommand, const ULONG ulSize )
+{
+	if ( ulSize == 0 )
+		return ( -1 );
+
+	if ( pbCommand[0] == SVC_EXTENDEDCOMMAND )
+	{
+		if (( ulSize < 2 ) || ( pbCommand[1] >= NUM_SVC2_COMMANDS ))
+			return ( -1 );
+
+		return ( NUM_SERVER_COMMANDS + pbCommand[1] );
+	}
+
+	if ( pbCommand[0] >= NUM_SERVER_COMMANDS )
+		return ( -1 );
+
+	return ( pbCommand[0] );
+}
+
+//*****************************************************************************
+//
+static const char *nettraffic_GetCommandName( const int Index )
+{
+	if ( Index >= NUM_SERVER_COMMANDS )
+		return ( GetStringSVC2( static_cast<SVC2>( Index - NUM_SERVER_COMMANDS )));
+
+	return ( GetStringSVC( static_cast<SVC>( Index )));
+}
+
+//*****************************************************************************
+//
+// Adds up the last ulSeconds samples, the current one included.
+static void nettraffic_SumSamples( ULONG ulSeconds, NetTrafficSample &Sum )
+{
+	memset( &Sum, 0, sizeof( Sum ));
+	ulSeconds = MIN<ULONG>( ulSeconds, g_ulNumTrafficSamples );
+
+	for ( ULONG ulIdx = 0; ulIdx < ulSeconds; ulIdx++ )
+	{
+		const NetTrafficSample &Sample = g_TrafficHistory[( g_ulCurrentTrafficSample + NETTRAFFIC_HISTORY_SECONDS - ulIdx ) % NETTRAFFIC_HISTORY_SECONDS];
+
+		for ( int i = 0; i < NUM_NETTRAFFIC_COMMANDS; i++ )
+		{
+			for ( int j = 0; j < 2; j++ )
+			{
+				Sum.Commands[i][j].Count += Sample.Commands[i][j].Count;
+				Sum.Commands[i][j].Bytes += Sample.Commands[i][j].Bytes;
+			}
+		}
+
+		for ( int i = 0; i < MAXPLAYERS; i++ )
+		{
+			for ( int j = 0; j < NUM_NETTRAFFICKINDS; j++ )
+			{
+				Sum.Clients[i][j].Count += Sample.Clients[i][j].Count;
+				Sum.Clients[i][j].Bytes += Sample.Clients[i][j].Bytes;
+				Sum.Clients[i][j].EncodedBytes += Sample.Clients[i][j].EncodedBytes;
+			}
+		}
+	}
+}
+
 //*****************************************************************************
 //
 void NETTRAFFIC_AddActorTraffic ( const AActor* pActor, const int BytesUsed )
@@ -96,12 +221,69 @@ void NETTRAFFIC_AddACSScriptTraffic ( const int ScriptNum, const int BytesUsed )
 	g_ACSScriptTrafficMap [ ScriptNum ] += BytesUsed;
 }
 
+//*****************************************************************************
+//
+// [ZA] Called for every command written into a client's packet buffer. The size
+// is before Huffman encoding, which only happens to whole packets.
+void NETTRAFFIC_AddCommandTraffic ( const ULONG ulClient, const BYTE *pbCommand, const ULONG ulSize, const bool bUnreliable )
+{
+	if (( ulClient >= MAXPLAYERS ) || ( nettraffic_IsMeasuring( ) == false ))
+		return;
+
+	const int index = nettraffic_GetCommandIndex( pbCommand, ulSize );
+	if ( index < 0 )
+		return;
+
+	NetTrafficCounter &Counter = nettraffic_GetCurrentSample( ).Commands[index][bUnreliable];
+	Counter.Count++;
+	Counter.Bytes += ulSize;
+	g_ClientCommandTraffic[ulClient * NUM_NETTRAFFIC_COMMANDS + index] += ulSize;
+}
+
+//*****************************************************************************
+//
+// [ZA] Called for every packet that is launched to a client, with its size
+// before and after Huffman encoding.
+void NETTRAFFIC_AddPacketTraffic ( const ULONG ulClient, const NETTRAFFICKIND_e Kind, const ULONG ulSize, const ULONG ulEncodedSize )
+{
+	if (( ulClient >= MAXPLAYERS ) || ( nettraffic_IsMeasuring( ) == false ))
+		return;
+
+	NetTrafficCounter &Counter = nettraffic_GetCurrentSample( ).Clients[ulClient][Kind];
+	Counter.Count++;
+	Counter.Bytes += ulSize;
+	Counter.EncodedBytes += ulEncodedSize;
+}
+
+//*****************************************************************************
+//
+// [ZA] Moves on to the next sample once a second has passed.
+void NETTRAFFIC_Tick ( )
+{
+	if (( nettraffic_IsMeasuring( ) == false ) || g_TrafficHistory.empty( ))
+		return;
+
+	if ( ++g_ulTrafficSampleTics < TICRATE )
+		return;
+
+	g_ulTrafficSampleTics = 0;
+	g_ulCurrentTrafficSample = ( g_ulCurrentTrafficSample + 1 ) % NETTRAFFIC_HISTORY_SECONDS;
+	memset( &g_TrafficHistory[g_ulCurrentTrafficSample], 0, sizeof( NetTrafficSample ));
+	if ( g_ulNumTrafficSamples < NETTRAFFIC_HISTORY_SECONDS )
+		g_ulNumTrafficSamples++;
+}
+
 //*****************************************************************************
 //
 void NETTRAFFIC_Reset ( )
 {
 	g_actorTrafficMap.clear();
 	g_ACSScriptTrafficMap.clear();
+
+	// [ZA]
+	g_TrafficHistory.clear();
+	g_ClientCommandTraffic.clear();
+	g_ulNumTrafficSamples = 0;
 }
 
 //*****************************************************************************
@@ -147,3 +329,157 @@ CCMD( cleartrafficmeasure )
 {
 	NETTRAFFIC_Reset ();
 }
+
+//*****************************************************************************
+//
+// [ZA] Prints the traffic per command and per client over the last seconds.
+// If a client is given, also prints what each command cost that client since
+// the measurement was started.
+CCMD( dumpnettraffic )
+{
+	if ( NETWORK_GetState( ) != NETSTATE_SERVER )
+		return;
+
+	if ( g_TrafficHistory.empty( ))
+	{
+		Printf( "No traffic has been measured. Set sv_measureoutboundtraffic to true first.\n" );
+		return;
+	}
+
+	const ULONG ulSeconds = ( argv.argc( ) > 1 ) ? clamp<ULONG>( atoi( argv[1] ), 1, NETTRAFFIC_HISTORY_SECONDS ) : NETTRAFFIC_HISTORY_SECONDS;
+	NetTrafficSample *pSum = new NetTrafficSample;
+	nettraffic_SumSamples( ulSeconds, *pSum );
+
+	// The encoding ratio of the whole traffic is used to estimate what each command costs on the wire.
+	double rawBytes = 0, encodedBytes = 0;
+	for ( int i = 0; i < MAXPLAYERS; i++ )
+	{
+		for ( int j = 0; j < NUM_NETTRAFFICKINDS; j++ )
+		{
+			rawBytes += pSum->Clients[i][j].Bytes;
+			encodedBytes += pSum->Clients[i][j].EncodedBytes;
+		}
+	}
+	const double ratio = ( rawBytes > 0 ) ? ( encodedBytes / rawBytes ) : 1.0;
+
+	Printf( "Network traffic over the last %lu seconds (sizes in bytes, encoded ones estimated at %.0f%%):\n", MIN<ULONG>( ulSeconds, g_ulNumTrafficSamples ), ratio * 100 );
+	Printf( "%-40s %8s %10s %8s %10s %10s\n", "Command", "Reliable", "Bytes", "Unrel.", "Bytes", "Encoded" );
+
+	{
+		std::vector<std::pair<unsigned int, int>> commands;
+		for ( int i = 0; i < NUM_NETTRAFFIC_COMMANDS; i++ )
+		{
+			const unsigned int bytes = pSum->Commands[i][0].Bytes + pSum->Commands[i][1].Bytes;
+			if ( bytes > 0 )
+				commands.push_back( std::make_pair( bytes, i ));
+		}
+		std::sort( commands.begin(), commands.end(), std::greater<std::pair<unsigned int, int>>() );
+
+		for ( auto it = commands.cbegin(); it != commands.cend(); ++it )
+		{
+			const NetTrafficCounter *pCounters = pSum->Commands[(*it).second];
+			Printf( "%-40s %8u %10u %8u %10u %10u\n", nettraffic_GetCommandName( (*it).second ), pCounters[0].Count, pCounters[0].Bytes,
+				pCounters[1].Count, pCounters[1].Bytes, static_cast<unsigned int>( (*it).first * ratio ));
+		}
+	}
+
+	Printf( "\n%-3s %-24s %-14s %8s %10s %10s\n", "#", "Client", "Traffic", "Packets", "Bytes", "Encoded" );
+	for ( ULONG ulIdx = 0; ulIdx < MAXPLAYERS; ulIdx++ )
+	{
+		for ( int j = 0; j < NUM_NETTRAFFICKINDS; j++ )
+		{
+			const NetTrafficCounter &Counter = pSum->Clients[ulIdx][j];
+			if ( Counter.Count == 0 )
+				continue;
+
+			Printf( "%-3lu %-24s %-14s %8u %10u %10u\n", ulIdx, SERVER_IsValidClient( ulIdx ) ? players[ulIdx].userinfo.GetName() : "-",
+				g_pszTrafficKindNames[j], Counter.Count, Counter.Bytes, Counter.EncodedBytes );
+		}
+	}
+	delete pSum;
+
+	if ( argv.argc( ) > 2 )
+	{
+		const int client = atoi( argv[2] );
+		if (( client < 0 ) || ( client >= MAXPLAYERS ))
+		{
+			Printf( "Invalid client index %d.\n", client );
+			return;
+		}
+
+		std::vector<std::pair<unsigned int, int>> commands;
+		for ( int i = 0; i < NUM_NETTRAFFIC_COMMANDS; i++ )
+		{
+			if ( g_ClientCommandTraffic[client * NUM_NETTRAFFIC_COMMANDS + i] > 0 )
+				commands.push_back( std::make_pair( g_ClientCommandTraffic[client * NUM_NETTRAFFIC_COMMANDS + i], i ));
+		}
+		std::sort( commands.begin(), commands.end(), std::greater<std::pair<unsigned int, int>>() );
+
+		Printf( "\nBytes sent to client %d per command since the measurement started:\n", client );
+		for ( auto it = commands.cbegin(); it != commands.cend(); ++it )
+			Printf( "%-40s %10u\n", nettraffic_GetCommandName( (*it).second ), (*it).first );
+	}
+}
+
+//*****************************************************************************
+//
+// [ZA] Writes the whole history as CSV, one row per second and command or client.
+CCMD( writenettraffic )
+{
+	if ( NETWORK_GetState( ) != NETSTATE_SERVER )
+		return;
+
+	if ( argv.argc( ) < 2 )
+	{
+		Printf( "Usage: writenettraffic <filename>\n" );
+		return;
+	}
+
+	if ( g_TrafficHistory.empty( ))
+	{
+		Printf( "No traffic has been measured. Set sv_measureoutboundtraffic to true first.\n" );
+		return;
+	}
+
+	FILE *pFile = fopen( argv[1], "w" );
+	if ( pFile == NULL )
+	{
+		Printf( "Couldn't open %s for writing.\n", argv[1] );
+		return;
+	}
+
+	fprintf( pFile, "second,category,name,kind,count,bytes,encoded_bytes\n" );
+	for ( ULONG ulSecond = 0; ulSecond < g_ulNumTrafficSamples; ulSecond++ )
+	{
+		// Oldest sample first. The second is relative to the current one, which is 0.
+		const ULONG ulAge = g_ulNumTrafficSamples - 1 - ulSecond;
+		const NetTrafficSample &Sample = g_TrafficHistory[( g_ulCurrentTrafficSample + NETTRAFFIC_HISTORY_SECONDS - ulAge ) % NETTRAFFIC_HISTORY_SECONDS];
+
+		for ( int i = 0; i < NUM_NETTRAFFIC_COMMANDS; i++ )
+		{
+			for ( int j = 0; j < 2; j++ )
+			{
+				if ( Sample.Commands[i][j].Count > 0 )
+				{
+					fprintf( pFile, "%ld,command,%s,%s,%u,%u,\n", -static_cast<long>( ulAge ), nettraffic_GetCommandName( i ),
+						g_pszTrafficKindNames[j], Sample.Commands[i][j].Count, Sample.Commands[i][j].Bytes );
+				}
+			}
+		}
+
+		for ( int i = 0; i < MAXPLAYERS; i++ )
+		{
+			for ( int j = 0; j < NUM_NETTRAFFICKINDS; j++ )
+			{
+				if ( Sample.Clients[i][j].Count > 0 )
+				{
+					fprintf( pFile, "%ld,client,%d,%s,%u,%u,%u\n", -static_cast<long>( ulAge ), i, g_pszTrafficKindNames[j],
+						Sample.Clients[i][j].Count, Sample.Clients[i][j].Bytes, Sample.Clients[i][j].EncodedBytes );
+				}
+			}
+		}
+	}
+
+	fclose( pFile );
+	Printf( "Wrote %lu seconds of network traffic to %s.\n", g_ulNumTrafficSamples, argv[1] );
+}
@@ -50,8 +50,30 @@
 
 #include "actor.h"
 
+//*****************************************************************************
+//	DEFINES
+
+// [ZA] How many seconds of per-command and per-client traffic are kept.
+#define	NETTRAFFIC_HISTORY_SECONDS	60
+
+//*****************************************************************************
+enum NETTRAFFICKIND_e
+{
+	NETTRAFFIC_RELIABLE,
+	NETTRAFFIC_UNRELIABLE,
+	NETTRAFFIC_RETRANSMITTED,
+
+	NUM_NETTRAFFICKINDS
+};
+
+//*****************************************************************************
+//	PROTOTYPES
+
 void	NETTRAFFIC_AddActorTraffic ( const AActor* pActor, const int BytesUsed );
 void	NETTRAFFIC_AddACSScriptTraffic ( const int ScriptNum, const int BytesUsed );
+void	NETTRAFFIC_AddCommandTraffic ( const ULONG ulClient, const BYTE *pbCommand, const ULONG ulSize, const bool bUnreliable );
+void	NETTRAFFIC_AddPacketTraffic ( const ULONG ulClient, const NETTRAFFICKIND_e Kind, const ULONG ulSize, const ULONG ulEncodedSize );
+void	NETTRAFFIC_Tick ( );
 void	NETTRAFFIC_Reset ( );
 
 #endif	// __NETTRAFFIC_H__
@@ -52,6 +52,7 @@
 #include "../network.h"
 #include "../network_enums.h" 
 #include "packetarchive.h"
+#include "nettraffic.h"
 
 //*****************************************************************************
 //
@@ -201,7 +202,7 @@ void OutgoingPacketBuffer::ScheduleUnsentPacket ( const NETBUFFER_s &Packet )
 	{
 		++_packetsSentThisTick;
 		const int packetNumber = this->StorePacket ( Packet );
-		SendPacket( packetNumber, SERVER_GetClient ( _clientIdx )->Address );
+		SendPacket( packetNumber, SERVER_GetClient ( _clientIdx )->Address, false );
 	}
 	else
 	{
@@ -211,7 +212,7 @@ void OutgoingPacketBuffer::ScheduleUnsentPacket ( const NETBUFFER_s &Packet )
 
 //*****************************************************************************
 //
-bool OutgoingPacketBuffer::SendPacket( unsigned int packetNumber, const NETADDRESS_s &Address ) const
+bool OutgoingPacketBuffer::SendPacket( unsigned int packetNumber, const NETADDRESS_s &Address, bool retransmission ) const
 {
 	// Find the packet from the saved packet archive.
 	const BYTE* packetData;
@@ -229,7 +230,9 @@ bool OutgoingPacketBuffer::SendPacket( unsigned int packetNumber, const NETADDRE
 	TempBuffer.ByteStream.WriteLong( packetNumber );
 	if ( packetSize > 0 )
 		TempBuffer.ByteStream.WriteBuffer( packetData, packetSize );
-	NETWORK_LaunchPacket( &TempBuffer, Address );
+	const LONG encodedSize = NETWORK_LaunchPacket( &TempBuffer, Address );
+	// [ZA] Packets that are sent again because the client missed them are accounted separately.
+	NETTRAFFIC_AddPacketTraffic( _clientIdx, retransmission ? NETTRAFFIC_RETRANSMITTED : NETTRAFFIC_RELIABLE, TempBuffer.CalcSize(), encodedSize );
 	TempBuffer.Free();
 	return true;
 }
@@ -241,7 +244,7 @@ bool OutgoingPacketBuffer::SchedulePacket ( unsigned int packetNumber )
 	if ( ( _scheduledPacketIndices.Size() == 0 ) && ( _packetsSentThisTick < static_cast<unsigned int> ( sv_maxpacketspertick ) ) )
 	{
 		++_packetsSentThisTick;
-		return SendPacket( packetNumber, SERVER_GetClient ( _clientIdx )->Address );
+		return SendPacket( packetNumber, SERVER_GetClient ( _clientIdx )->Address, true );
 	}
 	else
 	{
@@ -278,14 +281,14 @@ void OutgoingPacketBuffer::ForceSendAll()
 	for ( unsigned int i = 0; i < _scheduledPacketIndices.Size(); ++i )
 	{
 		++_packetsSentThisTick;
-		SendPacket( _scheduledPacketIndices[i], SERVER_GetClient ( _clientIdx )->Address );
+		SendPacket( _scheduledPacketIndices[i], SERVER_GetClient ( _clientIdx )->Address, true );
 	}
 	_scheduledPacketIndices.Clear();
 	for ( unsigned int i = 0; i < _unsentPackets.Size(); ++i )
 	{
 		++_packetsSentThisTick;
 		const int packetNumber = this->StorePacket ( _unsentPackets[i] );
-		SendPacket ( packetNumber, SERVER_GetClient (_clientIdx)->Address );
+		SendPacket ( packetNumber, SERVER_GetClient (_clientIdx)->Address, false );
 		_unsentPackets[i].Free ();
 	}
 	_unsentPackets.Clear();
@@ -300,7 +303,7 @@ void OutgoingPacketBuffer::Tick ( )
 		for ( int i = 0; i < packetsToSend; ++i )
 		{
 			++_packetsSentThisTick;
-			if ( SendPacket( _scheduledPacketIndices[i], SERVER_GetClient( _clientIdx )->Address) == false )
+			if ( SendPacket( _scheduledPacketIndices[i], SERVER_GetClient( _clientIdx )->Address, true ) == false )
 			{
 				SERVER_KickPlayer( _clientIdx, "Too many missed packets.");
 				return;
@@ -315,7 +318,7 @@ void OutgoingPacketBuffer::Tick ( )
 		{
 			++_packetsSentThisTick;
 			const int packetNumber = this->StorePacket ( _unsentPackets[i] );
-			SendPacket ( packetNumber, SERVER_GetClient( _clientIdx )->Address );
+			SendPacket ( packetNumber, SERVER_GetClient( _clientIdx )->Address, false );
 			_unsentPackets[i].Free ();
 		}
 		_unsentPackets.Delete( 0, unsentPacketsToSend );
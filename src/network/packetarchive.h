@@ -98,7 +98,7 @@ class OutgoingPacketBuffer : public PacketArchive
 	TArray<unsigned int> _scheduledPacketIndices;
 	TArray<NETBUFFER_s> _unsentPackets;
 private:
-	bool SendPacket( unsigned int packetNumber, const NETADDRESS_s &Address ) const;
+	bool SendPacket( unsigned int packetNumber, const NETADDRESS_s &Address, bool retransmission ) const;
 public:
 	OutgoingPacketBuffer ( );
 	void SetClientIndex ( const unsigned int ClientIdx );
@@ -102,6 +102,13 @@ Revision History:
 //#include "driver.h"		/* use M.A.M.E. */
 #include "opl.h"
 
+/* [ZA] SSE2 is always available on x64, so the batched renderer can compute
+** four voices' operators at once there. */
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define FMOPL_SSE2
+#include <emmintrin.h>
+#endif
+
 /* compiler dependence */
 #ifndef OSD_CPU_H
 #define OSD_CPU_H
@@ -583,6 +590,7 @@ static INT32	LFO_PM;
 
 static bool CalcVoice (FM_OPL *OPL, int voice, float *buffer, int length);
 static bool CalcRhythm (FM_OPL *OPL, float *buffer, int length);
+static void CalcVoicesBatched (FM_OPL *OPL, int lastvoice, float *buffer, int length);	// [ZA]
 
 
 
@@ -645,125 +653,128 @@ INLINE void advance_lfo(FM_OPL *OPL)
 	LFO_PM = ((OPL->lfo_pm_cnt>>LFO_SH) & 7) | OPL->lfo_pm_depth_range;
 }
 
-/* advance to next sample */
-INLINE void advance(FM_OPL *OPL, int loch, int hich)
+/* [ZA] advance the envelope and phase generators of one slot by one EG tick */
+INLINE void advance_slot(FM_OPL *OPL, OPL_CH *CH, OPL_SLOT *op, INT32 lfo_pm)
 {
-	OPL_CH *CH;
-	OPL_SLOT *op;
-	int i;
-
-	OPL->eg_timer += OPL->eg_timer_add;
-	loch *= 2;
-	hich *= 2;
-
-	while (OPL->eg_timer >= OPL->eg_timer_overflow)
+	/* Envelope Generator */
+	switch(op->state)
 	{
-		OPL->eg_timer -= OPL->eg_timer_overflow;
+	case EG_ATT:		/* attack phase */
+		if ( !(OPL->eg_cnt & ((1<<op->eg_sh_ar)-1) ) )
+		{
+			op->volume += (~op->volume *
+                        		           (eg_inc[op->eg_sel_ar + ((OPL->eg_cnt>>op->eg_sh_ar)&7)])
+        			                          ) >>3;
 
-		OPL->eg_cnt++;
+			if (op->volume <= MIN_ATT_INDEX)
+			{
+				op->volume = MIN_ATT_INDEX;
+				op->state = EG_DEC;
+			}
 
-		for (i = loch; i <= hich + 1; i++)
+		}
+	break;
+
+	case EG_DEC:	/* decay phase */
+		if ( !(OPL->eg_cnt & ((1<<op->eg_sh_dr)-1) ) )
 		{
-			CH  = &OPL->P_CH[i/2];
-			op  = &CH->SLOT[i&1];
+			op->volume += eg_inc[op->eg_sel_dr + ((OPL->eg_cnt>>op->eg_sh_dr)&7)];
 
-			/* Envelope Generator */
-			switch(op->state)
-			{
-			case EG_ATT:		/* attack phase */
-				if ( !(OPL->eg_cnt & ((1<<op->eg_sh_ar)-1) ) )
-				{
-					op->volume += (~op->volume *
-	                        		           (eg_inc[op->eg_sel_ar + ((OPL->eg_cnt>>op->eg_sh_ar)&7)])
-        			                          ) >>3;
+			if ( op->volume >= (INT32)op->sl )
+				op->state = EG_SUS;
 
-					if (op->volume <= MIN_ATT_INDEX)
-					{
-						op->volume = MIN_ATT_INDEX;
-						op->state = EG_DEC;
-					}
+		}
+	break;
 
-				}
-			break;
+	case EG_SUS:	/* sustain phase */
 
-			case EG_DEC:	/* decay phase */
-				if ( !(OPL->eg_cnt & ((1<<op->eg_sh_dr)-1) ) )
-				{
-					op->volume += eg_inc[op->eg_sel_dr + ((OPL->eg_cnt>>op->eg_sh_dr)&7)];
+		/* this is important behaviour:
+		one can change percusive/non-percussive modes on the fly and
+		the chip will remain in sustain phase - verified on real YM3812 */
 
-					if ( op->volume >= (INT32)op->sl )
-						op->state = EG_SUS;
+		if(op->eg_type)		/* non-percussive mode */
+		{
+							/* do nothing */
+		}
+		else				/* percussive mode */
+		{
+			/* during sustain phase chip adds Release Rate (in percussive mode) */
+			if ( !(OPL->eg_cnt & ((1<<op->eg_sh_rr)-1) ) )
+			{
+				op->volume += eg_inc[op->eg_sel_rr + ((OPL->eg_cnt>>op->eg_sh_rr)&7)];
 
-				}
-			break;
+				if ( op->volume >= MAX_ATT_INDEX )
+					op->volume = MAX_ATT_INDEX;
+			}
+			/* else do nothing in sustain phase */
+		}
+	break;
 
-			case EG_SUS:	/* sustain phase */
+	case EG_REL:	/* release phase */
+		if ( !(OPL->eg_cnt & ((1<<op->eg_sh_rr)-1) ) )
+		{
+			op->volume += eg_inc[op->eg_sel_rr + ((OPL->eg_cnt>>op->eg_sh_rr)&7)];
 
-				/* this is important behaviour:
-				one can change percusive/non-percussive modes on the fly and
-				the chip will remain in sustain phase - verified on real YM3812 */
+			if ( op->volume >= MAX_ATT_INDEX )
+			{
+				op->volume = MAX_ATT_INDEX;
+				op->state = EG_OFF;
+			}
 
-				if(op->eg_type)		/* non-percussive mode */
-				{
-									/* do nothing */
-				}
-				else				/* percussive mode */
-				{
-					/* during sustain phase chip adds Release Rate (in percussive mode) */
-					if ( !(OPL->eg_cnt & ((1<<op->eg_sh_rr)-1) ) )
-					{
-						op->volume += eg_inc[op->eg_sel_rr + ((OPL->eg_cnt>>op->eg_sh_rr)&7)];
-
-						if ( op->volume >= MAX_ATT_INDEX )
-							op->volume = MAX_ATT_INDEX;
-					}
-					/* else do nothing in sustain phase */
-				}
-			break;
+		}
+	break;
 
-			case EG_REL:	/* release phase */
-				if ( !(OPL->eg_cnt & ((1<<op->eg_sh_rr)-1) ) )
-				{
-					op->volume += eg_inc[op->eg_sel_rr + ((OPL->eg_cnt>>op->eg_sh_rr)&7)];
+	default:
+	break;
+	}
 
-					if ( op->volume >= MAX_ATT_INDEX )
-					{
-						op->volume = MAX_ATT_INDEX;
-						op->state = EG_OFF;
-					}
+	/* Phase Generator */
+	if(op->vib)
+	{
+		UINT8 block;
+		unsigned int block_fnum = CH->block_fnum;
 
-				}
-			break;
+		unsigned int fnum_lfo   = (block_fnum&0x0380) >> 7;
 
-			default:
-			break;
-			}
+		signed int lfo_fn_table_index_offset = lfo_pm_table[lfo_pm + 16*fnum_lfo ];
 
-			/* Phase Generator */
-			if(op->vib)
-			{
-				UINT8 block;
-				unsigned int block_fnum = CH->block_fnum;
+		if (lfo_fn_table_index_offset)	/* LFO phase modulation active */
+		{
+			block_fnum += lfo_fn_table_index_offset;
+			block = (block_fnum&0x1c00) >> 10;
+			op->Cnt += (OPL->fn_tab[block_fnum&0x03ff] >> (7-block)) * op->mul;
+		}
+		else	/* LFO phase modulation  = zero */
+		{
+			op->Cnt += op->Incr;
+		}
+	}
+	else	/* LFO phase modulation disabled for this operator */
+	{
+		op->Cnt += op->Incr;
+	}
+}
 
-				unsigned int fnum_lfo   = (block_fnum&0x0380) >> 7;
+/* advance to next sample */
+INLINE void advance(FM_OPL *OPL, int loch, int hich)
+{
+	OPL_CH *CH;
+	int i;
 
-				signed int lfo_fn_table_index_offset = lfo_pm_table[LFO_PM + 16*fnum_lfo ];
+	OPL->eg_timer += OPL->eg_timer_add;
+	loch *= 2;
+	hich *= 2;
 
-				if (lfo_fn_table_index_offset)	/* LFO phase modulation active */
-				{
-					block_fnum += lfo_fn_table_index_offset;
-					block = (block_fnum&0x1c00) >> 10;
-					op->Cnt += (OPL->fn_tab[block_fnum&0x03ff] >> (7-block)) * op->mul;
-				}
-				else	/* LFO phase modulation  = zero */
-				{
-					op->Cnt += op->Incr;
-				}
-			}
-			else	/* LFO phase modulation disabled for this operator */
-			{
-				op->Cnt += op->Incr;
-			}
+	while (OPL->eg_timer >= OPL->eg_timer_overflow)
+	{
+		OPL->eg_timer -= OPL->eg_timer_overflow;
+
+		OPL->eg_cnt++;
+
+		for (i = loch; i <= hich + 1; i++)
+		{
+			CH  = &OPL->P_CH[i/2];
+			advance_slot(OPL, CH, &CH->SLOT[i&1], LFO_PM);
 		}
 	}
 }
@@ -1554,10 +1565,11 @@ class YM3812 : public OPLEmul
 {
 private:
 	FM_OPL Chip;
+	bool Batched;	// [ZA] Render all voices together instead of one at a time.
 
 public:
 	/* Create one of virtual YM3812 */
-	YM3812(bool stereo)
+	YM3812(bool stereo, bool batched)
 	{
 		init_tables();
 
@@ -1568,6 +1580,7 @@ public:
 		OPL_initalize(&Chip);
 
 		Chip.IsStereo = stereo;
+		Batched = batched;
 
 		Reset();
 	}
@@ -1607,26 +1620,33 @@ public:
 		UINT32 eg_timer_bak = Chip.eg_timer;
 		UINT32 eg_cnt_bak = Chip.eg_cnt;
 
-		UINT32 lfo_am_cnt_out = lfo_am_cnt_bak;
-		UINT32 eg_timer_out = eg_timer_bak;
-		UINT32 eg_cnt_out = eg_cnt_bak;
-
-		for (i = 0; i <= (rhythm ? 5 : 8); ++i)
+		if (Batched)
 		{
-			Chip.lfo_am_cnt = lfo_am_cnt_bak;
-			Chip.eg_timer = eg_timer_bak;
-			Chip.eg_cnt = eg_cnt_bak;
-			if (CalcVoice (&Chip, i, buffer, length))
+			CalcVoicesBatched (&Chip, rhythm ? 5 : 8, buffer, length);
+		}
+		else
+		{
+			UINT32 lfo_am_cnt_out = lfo_am_cnt_bak;
+			UINT32 eg_timer_out = eg_timer_bak;
+			UINT32 eg_cnt_out = eg_cnt_bak;
+
+			for (i = 0; i <= (rhythm ? 5 : 8); ++i)
 			{
-				lfo_am_cnt_out = Chip.lfo_am_cnt;
-				eg_timer_out = Chip.eg_timer;
-				eg_cnt_out = Chip.eg_cnt;
+				Chip.lfo_am_cnt = lfo_am_cnt_bak;
+				Chip.eg_timer = eg_timer_bak;
+				Chip.eg_cnt = eg_cnt_bak;
+				if (CalcVoice (&Chip, i, buffer, length))
+				{
+					lfo_am_cnt_out = Chip.lfo_am_cnt;
+					eg_timer_out = Chip.eg_timer;
+					eg_cnt_out = Chip.eg_cnt;
+				}
 			}
-		}
 
-		Chip.lfo_am_cnt = lfo_am_cnt_out;
-		Chip.eg_timer = eg_timer_out;
-		Chip.eg_cnt = eg_cnt_out;
+			Chip.lfo_am_cnt = lfo_am_cnt_out;
+			Chip.eg_timer = eg_timer_out;
+			Chip.eg_cnt = eg_cnt_out;
+		}
 
 		if (rhythm)		/* Rhythm part */
 		{
@@ -1662,10 +1682,10 @@ public:
 	}
 };
 
-OPLEmul *YM3812Create(bool stereo)
+OPLEmul *YM3812Create(bool stereo, bool batched)
 {
 	/* emulator create */
-	return new YM3812(stereo);
+	return new YM3812(stereo, batched);
 }
 
 // [RH] Render a whole voice at once. If nothing else, it lets us avoid
@@ -1731,3 +1751,279 @@ static bool CalcRhythm (FM_OPL *OPL, float *buffer, int length)
 	}
 	return true;
 }
+
+/* [ZA] Batched rendering.
+**
+** CalcVoice renders each voice over the whole block before moving on to
+** the next, so the LFO and the envelope timer are stepped once per voice
+** per sample. CalcVoicesBatched walks the block once, steps that shared
+** state a single time per sample and computes the operators of every
+** playing voice together, four at a time where SSE2 is available.
+**
+** The output is bit-identical to the one-voice-at-a-time path. The only
+** subtle part is the phase LFO: CalcVoice never rewinds lfo_pm_cnt, so
+** the n-th voice it renders sees the counter advanced by the samples of
+** the n voices before it. That offset is reproduced per voice below.
+*/
+
+#define BATCH_LANES		12		/* 9 voices, rounded up to the SIMD width */
+
+struct OPL_BATCH
+{
+	/* slot 1 */
+	INT32	TLL1[BATCH_LANES];
+	INT32	Vol1[BATCH_LANES];
+	UINT32	AM1[BATCH_LANES];
+	UINT32	Cnt1[BATCH_LANES];
+	INT32	Wave1[BATCH_LANES];
+	INT32	FBmul[BATCH_LANES];		/* 1<<FB, or 0 when feedback is off */
+	INT32	Out0[BATCH_LANES];		/* op1_out[0] */
+	INT32	Out1[BATCH_LANES];		/* op1_out[1] */
+	INT32	ConMask[BATCH_LANES];	/* -1 if slot 1 goes straight to the output */
+
+	/* slot 2 */
+	INT32	TLL2[BATCH_LANES];
+	INT32	Vol2[BATCH_LANES];
+	UINT32	AM2[BATCH_LANES];
+	UINT32	Cnt2[BATCH_LANES];
+	INT32	Wave2[BATCH_LANES];
+
+	float	Sample[BATCH_LANES];
+	float	LeftVol[BATCH_LANES];
+	float	RightVol[BATCH_LANES];
+};
+
+#ifdef FMOPL_SSE2
+
+/* SSE2 has no 32-bit multiply, so build one out of the 32x32->64 one. */
+static inline __m128i mullo_epi32_sse2(__m128i a, __m128i b)
+{
+	__m128i even = _mm_mul_epu32(a, b);
+	__m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+	return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0,0,2,0)),
+		_mm_shuffle_epi32(odd, _MM_SHUFFLE(0,0,2,0)));
+}
+
+/* The table lookups of op_calc for four operators. The lanes are moved
+** through general registers rather than memory to avoid store forwarding
+** stalls. */
+static inline INT32 op_lookup_lane(UINT32 env, UINT32 index)
+{
+	UINT32 p = (env<<4) + sin_tab[index];
+	return p >= TL_TAB_LEN ? 0 : tl_tab[p];
+}
+
+static inline __m128i op_lookup_sse2(__m128i env, __m128i index)
+{
+	INT32 r0 = op_lookup_lane(_mm_cvtsi128_si32(env), _mm_cvtsi128_si32(index));
+	INT32 r1 = op_lookup_lane(_mm_cvtsi128_si32(_mm_shuffle_epi32(env, 1)), _mm_cvtsi128_si32(_mm_shuffle_epi32(index, 1)));
+	INT32 r2 = op_lookup_lane(_mm_cvtsi128_si32(_mm_shuffle_epi32(env, 2)), _mm_cvtsi128_si32(_mm_shuffle_epi32(index, 2)));
+	INT32 r3 = op_lookup_lane(_mm_cvtsi128_si32(_mm_shuffle_epi32(env, 3)), _mm_cvtsi128_si32(_mm_shuffle_epi32(index, 3)));
+	return _mm_set_epi32(r3, r2, r1, r0);
+}
+
+/* OPL_CALC_CH for lanes l..l+3 */
+static inline void calc_lanes(OPL_BATCH *b, int l, UINT32 am)
+{
+#define LOAD(field)		_mm_loadu_si128((const __m128i *)&b->field[l])
+	const __m128i quiet = _mm_set1_epi32(ENV_QUIET);
+	const __m128i phase_mask = _mm_set1_epi32(~FREQ_MASK);
+	const __m128i sin_mask = _mm_set1_epi32(SIN_MASK);
+	const __m128i lfo_am = _mm_set1_epi32(am);
+	__m128i env, index, pm, outp, sounding;
+
+	/* SLOT 1 */
+	__m128i out0 = LOAD(Out0);
+	__m128i out1 = LOAD(Out1);
+	__m128i con = LOAD(ConMask);
+	__m128i fb = mullo_epi32_sse2(_mm_add_epi32(out0, out1), LOAD(FBmul));
+	_mm_storeu_si128((__m128i *)&b->Out0[l], out1);
+	pm = _mm_andnot_si128(con, out1);
+	outp = _mm_and_si128(con, out1);
+
+	env = _mm_add_epi32(_mm_add_epi32(LOAD(TLL1), LOAD(Vol1)), _mm_and_si128(lfo_am, LOAD(AM1)));
+	sounding = _mm_cmplt_epi32(env, quiet);
+	index = _mm_add_epi32(_mm_and_si128(phase_mask, LOAD(Cnt1)), fb);
+	index = _mm_add_epi32(_mm_and_si128(_mm_srai_epi32(index, FREQ_SH), sin_mask), LOAD(Wave1));
+	_mm_storeu_si128((__m128i *)&b->Out1[l], _mm_and_si128(sounding, op_lookup_sse2(env, index)));
+
+	/* SLOT 2 */
+	env = _mm_add_epi32(_mm_add_epi32(LOAD(TLL2), LOAD(Vol2)), _mm_and_si128(lfo_am, LOAD(AM2)));
+	sounding = _mm_cmplt_epi32(env, quiet);
+	index = _mm_add_epi32(_mm_and_si128(phase_mask, LOAD(Cnt2)), _mm_slli_epi32(pm, 16));
+	index = _mm_add_epi32(_mm_and_si128(_mm_srai_epi32(index, FREQ_SH), sin_mask), LOAD(Wave2));
+	outp = _mm_add_epi32(outp, op_lookup_sse2(env, index));
+
+	/* [RH] Convert to floating point. */
+	_mm_storeu_ps(&b->Sample[l], _mm_and_ps(_mm_castsi128_ps(sounding),
+		_mm_div_ps(_mm_cvtepi32_ps(outp), _mm_set1_ps(10240))));
+#undef LOAD
+}
+
+#else
+
+/* OPL_CALC_CH for lanes l..l+3 */
+static inline void calc_lanes(OPL_BATCH *b, int l, UINT32 am)
+{
+	for (int end = l + 4; l < end; ++l)
+	{
+		unsigned int env;
+		signed int out, pm, outp;
+
+		/* SLOT 1 */
+		out = b->Out0[l] + b->Out1[l];
+		b->Out0[l] = b->Out1[l];
+		pm = b->ConMask[l] ? 0 : b->Out0[l];
+		outp = b->ConMask[l] ? b->Out0[l] : 0;
+		b->Out1[l] = 0;
+		env = b->TLL1[l] + (UINT32)b->Vol1[l] + (am & b->AM1[l]);
+		if( env < ENV_QUIET )
+		{
+			b->Out1[l] = op_calc1(b->Cnt1[l], env, out * b->FBmul[l], b->Wave1[l]);
+		}
+
+		/* SLOT 2 */
+		b->Sample[l] = 0;
+		env = b->TLL2[l] + (UINT32)b->Vol2[l] + (am & b->AM2[l]);
+		if( env < ENV_QUIET )
+		{
+			outp += op_calc(b->Cnt2[l], env, pm, b->Wave2[l]);
+			/* [RH] Convert to floating point. */
+			b->Sample[l] = float(outp) / 10240;
+		}
+	}
+}
+
+#endif
+
+static void CalcVoicesBatched (FM_OPL *OPL, int lastvoice, float *buffer, int length)
+{
+	OPL_BATCH b;
+	OPL_CH *chans[BATCH_LANES];
+	int lanes = 0, padded;
+	int i, l;
+
+	for (i = 0; i <= lastvoice; ++i)
+	{
+		OPL_CH *CH = &OPL->P_CH[i];
+		if (CH->SLOT[0].state == EG_OFF && CH->SLOT[1].state == EG_OFF)
+		{ // Voice is not playing, so don't do anything for it
+			continue;
+		}
+		chans[lanes] = CH;
+		b.TLL1[lanes] = CH->SLOT[SLOT1].TLL;
+		b.Vol1[lanes] = CH->SLOT[SLOT1].volume;
+		b.AM1[lanes] = CH->SLOT[SLOT1].AMmask;
+		b.Cnt1[lanes] = CH->SLOT[SLOT1].Cnt;
+		b.Wave1[lanes] = CH->SLOT[SLOT1].wavetable;
+		b.FBmul[lanes] = CH->SLOT[SLOT1].FB ? 1 << CH->SLOT[SLOT1].FB : 0;
+		b.Out0[lanes] = CH->SLOT[SLOT1].op1_out[0];
+		b.Out1[lanes] = CH->SLOT[SLOT1].op1_out[1];
+		b.ConMask[lanes] = CH->SLOT[SLOT1].CON ? -1 : 0;
+		b.TLL2[lanes] = CH->SLOT[SLOT2].TLL;
+		b.Vol2[lanes] = CH->SLOT[SLOT2].volume;
+		b.AM2[lanes] = CH->SLOT[SLOT2].AMmask;
+		b.Cnt2[lanes] = CH->SLOT[SLOT2].Cnt;
+		b.Wave2[lanes] = CH->SLOT[SLOT2].wavetable;
+		b.LeftVol[lanes] = CH->LeftVol;
+		b.RightVol[lanes] = CH->RightVol;
+		lanes++;
+	}
+	if (lanes == 0)
+	{
+		return;
+	}
+	if (lanes == 1)
+	{ // Nothing to share with a single voice, and three padding lanes to waste.
+		CalcVoice (OPL, int(chans[0] - OPL->P_CH), buffer, length);
+		return;
+	}
+
+	/* Pad out the last group with lanes that are always silent. */
+	padded = (lanes + 3) & ~3;
+	for (l = lanes; l < padded; ++l)
+	{
+		b.TLL1[l] = b.TLL2[l] = ENV_QUIET;
+		b.Vol1[l] = b.Vol2[l] = 0;
+		b.AM1[l] = b.AM2[l] = 0;
+		b.Cnt1[l] = b.Cnt2[l] = 0;
+		b.Wave1[l] = b.Wave2[l] = 0;
+		b.FBmul[l] = b.Out0[l] = b.Out1[l] = b.ConMask[l] = 0;
+	}
+
+	/* CalcVoice would leave lfo_pm_cnt this far ahead after each voice. */
+	const UINT32 pm_voice_step = OPL->lfo_pm_inc * (UINT32)length;
+	UINT32 pm_cnt = OPL->lfo_pm_cnt;
+
+	for (i = 0; i < length; ++i)
+	{
+		UINT8 tmp;
+
+		/* LFO, as advance_lfo */
+		OPL->lfo_am_cnt += OPL->lfo_am_inc;
+		if (OPL->lfo_am_cnt >= (UINT32)(LFO_AM_TAB_ELEMENTS<<LFO_SH) )
+			OPL->lfo_am_cnt -= (LFO_AM_TAB_ELEMENTS<<LFO_SH);
+
+		tmp = lfo_am_table[ OPL->lfo_am_cnt >> LFO_SH ];
+		const UINT32 am = OPL->lfo_am_depth ? tmp : tmp>>2;
+		pm_cnt += OPL->lfo_pm_inc;
+
+		for (l = 0; l < padded; l += 4)
+		{
+			calc_lanes(&b, l, am);
+		}
+
+		/* Mix in voice order, so the float sums round exactly as before. */
+		if (!OPL->IsStereo)
+		{
+			for (l = 0; l < lanes; ++l)
+			{
+				buffer[i] += b.Sample[l];
+			}
+		}
+		else
+		{
+			for (l = 0; l < lanes; ++l)
+			{
+				buffer[i*2] += b.Sample[l] * b.LeftVol[l];
+				buffer[i*2+1] += b.Sample[l] * b.RightVol[l];
+			}
+		}
+
+		/* Envelope and phase generators, as advance */
+		OPL->eg_timer += OPL->eg_timer_add;
+		if (OPL->eg_timer >= OPL->eg_timer_overflow)
+		{
+			do
+			{
+				OPL->eg_timer -= OPL->eg_timer_overflow;
+
+				OPL->eg_cnt++;
+
+				UINT32 voice_pm_cnt = pm_cnt;
+				for (l = 0; l < lanes; ++l)
+				{
+					INT32 lfo_pm = ((voice_pm_cnt>>LFO_SH) & 7) | OPL->lfo_pm_depth_range;
+					advance_slot(OPL, chans[l], &chans[l]->SLOT[SLOT1], lfo_pm);
+					advance_slot(OPL, chans[l], &chans[l]->SLOT[SLOT2], lfo_pm);
+					voice_pm_cnt += pm_voice_step;
+				}
+			} while (OPL->eg_timer >= OPL->eg_timer_overflow);
+
+			for (l = 0; l < lanes; ++l)
+			{
+				b.Vol1[l] = chans[l]->SLOT[SLOT1].volume;
+				b.Cnt1[l] = chans[l]->SLOT[SLOT1].Cnt;
+				b.Vol2[l] = chans[l]->SLOT[SLOT2].volume;
+				b.Cnt2[l] = chans[l]->SLOT[SLOT2].Cnt;
+			}
+		}
+	}
+
+	for (l = 0; l < lanes; ++l)
+	{
+		chans[l]->SLOT[SLOT1].op1_out[0] = b.Out0[l];
+		chans[l]->SLOT[SLOT1].op1_out[1] = b.Out1[l];
+	}
+	OPL->lfo_pm_cnt += pm_voice_step * lanes;
+}
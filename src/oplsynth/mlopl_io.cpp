@@ -48,6 +48,7 @@
 #define HALF_PI (PI*0.5)
 
 EXTERN_CVAR(Int, opl_core)
+EXTERN_CVAR(Bool, opl_batched)	// [ZA]
 
 OPLio::~OPLio()
 {
@@ -332,7 +333,7 @@ int OPLio::OPLinit(uint numchips, bool stereo, bool initopl3)
 	}
 	for (i = 0; i < numchips; ++i)
 	{
-		OPLEmul *chip = IsOPL3 ? (opl_core == 1 ? DBOPLCreate(stereo) : JavaOPLCreate(stereo)) : YM3812Create(stereo);
+		OPLEmul *chip = IsOPL3 ? (opl_core == 1 ? DBOPLCreate(stereo) : JavaOPLCreate(stereo)) : YM3812Create(stereo, opl_batched);
 		if (chip == NULL)
 		{
 			break;
@@ -17,7 +17,7 @@ public:
 	virtual void SetPanning(int c, float left, float right) = 0;
 };
 
-OPLEmul *YM3812Create(bool stereo);
+OPLEmul *YM3812Create(bool stereo, bool batched);
 OPLEmul *DBOPLCreate(bool stereo);
 OPLEmul *JavaOPLCreate(bool stereo);
 
@@ -57,6 +57,13 @@
 #include "team.h" // [CK]
 #include "doomdata.h"
 #include "v_palette.h"
+// [ZA] New #includes.
+#include "r_utility.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define PARTICLE_SSE2
+#include <emmintrin.h>
+#endif
 
 // [CK] Prototypes
 static void MakeFountain (fixed_t x, fixed_t y, fixed_t z, fixed_t radius, fixed_t height, int color1, int color2);
@@ -75,11 +82,15 @@ FRandom pr_railtrail("RailTrail");
 
 // [RH] particle globals
 WORD			NumParticles;
-WORD			ActiveParticles;
-WORD			InactiveParticles;
+WORD			NumActiveParticles;	// [ZA] Particles[0..NumActiveParticles) are in use.
 particle_t		*Particles;
 TArray<WORD>	ParticlesInSubsec;
 
+// [ZA] Set whenever a particle was spawned, moved or removed since the subsectors
+// lists were last built, so P_FindParticleSubsectors can skip unchanged frames.
+static bool		ParticleListsDirty = true;
+static bool		ParticleListsEnabled;
+
 static int grey1, grey2, grey3, grey4, red, red2, red3, red4, green, blue, yellow, black,
 		   red1, green1, blue1, yellow1, yellow2, yellow3, purple, purple1, purple2, purple3, white,
 		   rblue1, rblue2, rblue3, rblue4, orange, yorange, dred,  dred2,
@@ -151,12 +162,11 @@ static int* g_rainbowParticleColors[] =
 inline particle_t *NewParticle (void)
 {
 	particle_t *result = NULL;
-	if (InactiveParticles != NO_PARTICLE)
+	if (NumActiveParticles < NumParticles)
 	{
-		result = Particles + InactiveParticles;
-		InactiveParticles = result->tnext;
-		result->tnext = ActiveParticles;
-		ActiveParticles = WORD(result - Particles);
+		result = Particles + NumActiveParticles++;
+		memset (result, 0, sizeof(particle_t));
+		ParticleListsDirty = true;
 	}
 	return result;
 }
@@ -194,7 +204,8 @@ void P_InitParticles ()
 		NumParticles = r_maxparticles;
 
 	// This should be good, but eh...
-	NumParticles = clamp<WORD>(NumParticles, 100, 65535);
+	// [ZA] 65535 is NO_PARTICLE, so it can't be a valid index.
+	NumParticles = clamp<WORD>(NumParticles, 100, NO_PARTICLE - 1);
 
 	P_DeinitParticles();
 	Particles = new particle_t[NumParticles];
@@ -213,39 +224,46 @@ void P_DeinitParticles()
 
 void P_ClearParticles ()
 {
-	int i;
-
 	memset (Particles, 0, NumParticles * sizeof(particle_t));
-	ActiveParticles = NO_PARTICLE;
-	InactiveParticles = 0;
-	for (i = 0; i < NumParticles-1; i++)
-		Particles[i].tnext = i + 1;
-	Particles[i].tnext = NO_PARTICLE;
+	NumActiveParticles = 0;
+	ParticleListsDirty = true;
 }
 
-// Group particles by subsectors. Because particles are always
-// in motion, there is little benefit to caching this information
-// from one frame to the next.
+// Group particles by subsectors.
+// [ZA] Particles only move once per tic, so P_ThinkParticles keeps each particle's
+// subsector up to date and this only needs to relink the lists when something
+// changed. New particles have no subsector yet and are looked up here.
 
 void P_FindParticleSubsectors ()
 {
 	if (ParticlesInSubsec.Size() < (size_t)numsubsectors)
 	{
 		ParticlesInSubsec.Reserve (numsubsectors - ParticlesInSubsec.Size());
+		ParticleListsDirty = true;
 	}
 
+	if (!ParticleListsDirty && ParticleListsEnabled == r_particles)
+	{
+		return;
+	}
+	ParticleListsDirty = false;
+	ParticleListsEnabled = r_particles;
+
 	clearbufshort (&ParticlesInSubsec[0], numsubsectors, NO_PARTICLE);
 
 	if (!r_particles)
 	{
 		return;
 	}
-	for (WORD i = ActiveParticles; i != NO_PARTICLE; i = Particles[i].tnext)
+	for (WORD i = 0; i < NumActiveParticles; i++)
 	{
-		subsector_t *ssec = R_PointInSubsector (Particles[i].x, Particles[i].y);
-		int ssnum = int(ssec-subsectors);
-		Particles[i].subsector = ssec;
-		Particles[i].snext = ParticlesInSubsec[ssnum];
+		particle_t *particle = &Particles[i];
+		if (particle->subsector == NULL)
+		{
+			particle->subsector = R_PointInSubsector (particle->x, particle->y);
+		}
+		int ssnum = int(particle->subsector-subsectors);
+		particle->snext = ParticlesInSubsec[ssnum];
 		ParticlesInSubsec[ssnum] = i;
 	}
 }
@@ -289,39 +307,67 @@ void P_InitEffects ()
 }
 
 
+//
+// [ZA] P_MoveParticle
+//
+// Adds the velocity to the position and the acceleration to the velocity.
+// The SSE2 version does this in two overlapping steps: x,y,z,velx gets
+// velx,vely,velz,accx added to it, then vely,velz gets accy,accz added.
+//
+static inline void P_MoveParticle (particle_t *particle)
+{
+#ifdef PARTICLE_SSE2
+	fixed_t *p = &particle->x;
+	__m128i pos = _mm_loadu_si128 ((const __m128i *)p);
+	__m128i vel = _mm_loadu_si128 ((const __m128i *)(p + 3));
+	__m128i vel2 = _mm_loadl_epi64 ((const __m128i *)(p + 4));
+	__m128i acc2 = _mm_loadl_epi64 ((const __m128i *)(p + 7));
+	_mm_storeu_si128 ((__m128i *)p, _mm_add_epi32 (pos, vel));
+	_mm_storel_epi64 ((__m128i *)(p + 4), _mm_add_epi32 (vel2, acc2));
+#else
+	particle->x += particle->velx;
+	particle->y += particle->vely;
+	particle->z += particle->velz;
+	particle->velx += particle->accx;
+	particle->vely += particle->accy;
+	particle->velz += particle->accz;
+#endif
+}
+
 void P_ThinkParticles ()
 {
-	int i;
-	particle_t *particle, *prev;
+	WORD i = 0;
+
+	if (NumActiveParticles > 0)
+	{
+		ParticleListsDirty = true;
+	}
 
-	i = ActiveParticles;
-	prev = NULL;
-	while (i != NO_PARTICLE)
+	while (i < NumActiveParticles)
 	{
+		particle_t *particle = Particles + i;
 		BYTE oldtrans;
 
-		particle = Particles + i;
-		i = particle->tnext;
 		oldtrans = particle->trans;
 		particle->trans -= particle->fade;
 		if (oldtrans < particle->trans || --particle->ttl == 0)
 		{ // The particle has expired, so free it
-			memset (particle, 0, sizeof(particle_t));
-			if (prev)
-				prev->tnext = i;
-			else
-				ActiveParticles = i;
-			particle->tnext = InactiveParticles;
-			InactiveParticles = (int)(particle - Particles);
+			// [ZA] Move the last active particle into its place. That one
+			// hasn't been updated yet, so look at this slot again.
+			if (--NumActiveParticles != i)
+			{
+				*particle = Particles[NumActiveParticles];
+			}
 			continue;
 		}
-		particle->x += particle->velx;
-		particle->y += particle->vely;
-		particle->z += particle->velz;
-		particle->velx += particle->accx;
-		particle->vely += particle->accy;
-		particle->velz += particle->accz;
-		prev = particle;
+
+		const bool moved = (particle->velx | particle->vely) != 0;
+		P_MoveParticle (particle);
+		if (moved || particle->subsector == NULL)
+		{
+			particle->subsector = R_PointInSubsector (particle->x, particle->y);
+		}
+		i++;
 	}
 }
 
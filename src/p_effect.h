@@ -53,6 +53,9 @@
 struct subsector_t;
 
 // [RH] Particle details
+// [ZA] The active particles are packed at the start of Particles. P_ThinkParticles
+// relies on position, velocity and acceleration being nine consecutive fixed_t's
+// followed by at least eight more bytes.
 struct particle_t
 {
 	fixed_t	x,y,z;
@@ -64,12 +67,12 @@ struct particle_t
 	BYTE	bright:1;
 	BYTE	fade;
 	int		color;
-	WORD	tnext;
 	WORD	snext;
 	subsector_t * subsector;
 };
 
 extern particle_t *Particles;
+extern WORD				NumActiveParticles;
 extern TArray<WORD>		ParticlesInSubsec;
 
 const WORD NO_PARTICLE = 0xffff;
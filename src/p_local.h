@@ -463,6 +463,7 @@ enum ESightFlags
 
 void	P_ResetSightCounters (bool full);
 void	P_ResetSpawnCounters( void ); // [BC]
+void	P_ResetRadiusAttackCounters( void ); // [ZA]
 bool	P_TalkFacing (AActor *player);
 void	P_UseLines (player_t* player);
 bool	P_UsePuzzleItem (AActor *actor, int itemType);
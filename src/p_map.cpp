@@ -66,6 +66,8 @@
 #include "unlagged.h"
 #include "d_netinf.h"
 #include "v_video.h"
+// [ZA] New #includes.
+#include "stats.h"
 
 // [BB] Helper function to handle ZADF_UNBLOCK_PLAYERS.
 bool P_CheckUnblock ( AActor *pActor1, AActor *pActor2 )
@@ -5627,6 +5629,24 @@ CUSTOM_CVAR(Float, splashfactor, 1.f, CVAR_SERVERINFO)
 		selfthrustscale = 1.f / self;
 }
 
+//==========================================================================
+//
+// [ZA] Radius attack statistics
+//
+//==========================================================================
+
+enum
+{
+	RADCOUNT_Explosions,
+	RADCOUNT_Candidates,
+	RADCOUNT_Sight,
+	NUM_RADCOUNTS
+};
+
+static int RadiusDepth;
+static cycle_t RadiusCycles, StaleRadiusCycles;
+static int RadiusCounts[NUM_RADCOUNTS], StaleRadiusCounts[NUM_RADCOUNTS];
+
 //==========================================================================
 //
 // P_RadiusAttack
@@ -5654,6 +5674,13 @@ void P_RadiusAttack(AActor *bombspot, AActor *bombsource, int bombdamage, int bo
 		bombsource = bombspot;
 	}
 
+	// [ZA] Only time the outermost explosion, nested ones are part of it.
+	if (RadiusDepth++ == 0)
+	{
+		RadiusCycles.Clock();
+	}
+	RadiusCounts[RADCOUNT_Explosions]++;
+
 	while ((thing = it.Next()))
 	{
 		// Vulnerable actors can be damaged by radius attacks even if not shootable
@@ -5661,6 +5688,8 @@ void P_RadiusAttack(AActor *bombspot, AActor *bombsource, int bombdamage, int bo
 		if (!((thing->flags & MF_SHOOTABLE) || (thing->flags6 & MF6_VULNERABLE)))
 			continue;
 
+		RadiusCounts[RADCOUNT_Candidates]++; // [ZA]
+
 		// Boss spider and cyborg and Heretic's ep >= 2 bosses
 		// take no damage from concussion.
 		if (thing->flags3 & MF3_NORADIUSDMG && !(bombspot->flags4 & MF4_FORCERADIUSDMG))
@@ -5747,7 +5776,11 @@ void P_RadiusAttack(AActor *bombspot, AActor *bombsource, int bombdamage, int bo
 			points *= thing->GetClass()->Meta.GetMetaFixed(AMETA_RDFactor, FRACUNIT) / (double)FRACUNIT;
 
 			// points and bombdamage should be the same sign
-			if ((points * bombdamage) > 0 && P_CheckSight(thing, bombspot, SF_IGNOREVISIBILITY | SF_IGNOREWATERBOUNDARY))
+			if ((points * bombdamage) <= 0)
+				continue;
+
+			RadiusCounts[RADCOUNT_Sight]++; // [ZA]
+			if (P_CheckSight(thing, bombspot, SF_IGNOREVISIBILITY | SF_IGNOREWATERBOUNDARY))
 			{ // OK to damage; target is in direct path
 				double velz;
 				double thrust;
@@ -5855,6 +5888,7 @@ void P_RadiusAttack(AActor *bombspot, AActor *bombsource, int bombdamage, int bo
 			if (dist >= bombdistance)
 				continue;  // out of range
 
+			RadiusCounts[RADCOUNT_Sight]++; // [ZA]
 			if (P_CheckSight(thing, bombspot, SF_IGNOREVISIBILITY | SF_IGNOREWATERBOUNDARY))
 			{ // OK to damage; target is in direct path
 				dist = clamp<int>(dist - fulldamagedistance, 0, dist);
@@ -5874,10 +5908,38 @@ void P_RadiusAttack(AActor *bombspot, AActor *bombsource, int bombdamage, int bo
 		}
 	}
 
+	if (--RadiusDepth == 0)
+	{
+		RadiusCycles.Unclock();
+	}
+
 	// [BB] If the bombsource is a player and hit another player with his attack, potentially give him a medal.
 	PLAYER_CheckStruckPlayer( bombsource );
 }
 
+//==========================================================================
+//
+// [ZA] P_ResetRadiusAttackCounters
+//
+//==========================================================================
+
+void P_ResetRadiusAttackCounters ()
+{
+	StaleRadiusCycles = RadiusCycles;
+	memcpy (StaleRadiusCounts, RadiusCounts, sizeof(RadiusCounts));
+	RadiusCycles.Reset();
+	memset (RadiusCounts, 0, sizeof(RadiusCounts));
+}
+
+ADD_STAT (radiusattack)
+{
+	FString out;
+	out.Format ("%04.1f ms, %d explosions, %d candidates, %d sight checks",
+		StaleRadiusCycles.TimeMS(), StaleRadiusCounts[RADCOUNT_Explosions], StaleRadiusCounts[RADCOUNT_Candidates],
+		StaleRadiusCounts[RADCOUNT_Sight]);
+	return out;
+}
+
 //==========================================================================
 //
 // SECTOR HEIGHT CHANGING
@@ -372,6 +372,11 @@ void AActor::Serialize (FArchive &arc)
 		<< pPickupSpot
 		<< Rune;
 
+	// [ZA] Client demo keyframes are restored without any player bodies being spawned
+	// first, so the netIDs stay valid and must match the ones the recorded server used.
+	if ( arc.IsDemoKeyframe( ))
+		arc << NetID;
+
 	{
 		FString tagstr;
 		if (arc.IsStoring() && Tag != NULL && Tag->Len() > 0) tagstr = *Tag;
@@ -385,8 +390,14 @@ void AActor::Serialize (FArchive &arc)
 
 	if (arc.IsLoading ())
 	{
+		// [ZA] Keyframes bring their netIDs along.
+		if ( arc.IsDemoKeyframe( ))
+		{
+			if ( NetID != 0 )
+				g_ActorNetIDList.useID ( NetID, this );
+		}
 		// [BB] If the the actor needs one, generate a new netID.
-		if ( !( NetworkFlags & NETFL_NONETID ) && !( NetworkFlags & NETFL_SERVERSIDEONLY ) )
+		else if ( !( NetworkFlags & NETFL_NONETID ) && !( NetworkFlags & NETFL_SERVERSIDEONLY ) )
 		{
 			NetID = g_ActorNetIDList.getNewID( );
 			g_ActorNetIDList.useID ( NetID, this );
@@ -4761,7 +4772,15 @@ template <typename T>
 void IDList<T>::clear( void )
 {
 	for ( unsigned int i = 0; i <= ( std::numeric_limits<unsigned short>::max )( ); i++ )
-		freeID ( i );
+	{
+		_entries[i].bFree = true;
+		_entries[i].pActor = NULL;
+	}
+
+	// [ZA] Every ID but zero is free.
+	memset ( _freeBits, 0xFF, sizeof ( _freeBits ));
+	memset ( _freeWords, 0xFF, sizeof ( _freeWords ));
+	markUsed ( 0 );
 
 	_firstFreeID = 1;
 }
@@ -4796,7 +4815,71 @@ void IDList<T>::useID ( const unsigned short netID, T *actor )
 
 		_entries[netID].bFree = false;
 		_entries[netID].pActor = actor;
+		markUsed ( netID );
+	}
+}
+
+//*****************************************************************************
+//
+// [ZA] Index of the lowest set bit of a non-zero word.
+static inline int idlist_CountTrailingZeros ( QWORD bits )
+{
+#if defined(__GNUC__)
+	return __builtin_ctzll ( bits );
+#elif defined(_MSC_VER) && defined(_M_X64)
+	unsigned long index;
+	_BitScanForward64 ( &index, bits );
+	return static_cast<int> ( index );
+#elif defined(_MSC_VER)
+	unsigned long index;
+	if ( _BitScanForward ( &index, static_cast<DWORD> ( bits )))
+		return static_cast<int> ( index );
+	_BitScanForward ( &index, static_cast<DWORD> ( bits >> 32 ));
+	return static_cast<int> ( index ) + 32;
+#else
+	int index = 0;
+	while (( bits & 1 ) == 0 )
+	{
+		bits >>= 1;
+		index++;
+	}
+	return index;
+#endif
+}
+
+//*****************************************************************************
+//
+// [ZA] Returns the lowest free ID that is not below start, or -1 if there is
+// none.
+template <typename T>
+int IDList<T>::findFreeID ( const unsigned int start ) const
+{
+	unsigned int word = start >> 6;
+	QWORD bits = _freeBits[word] & ( ~UCONST64(0) << ( start & 63 ));
+
+	if ( bits == 0 )
+	{
+		// [ZA] Look for the next word with a free ID in the summary.
+		const unsigned int nextWord = word + 1;
+		if ( nextWord >= NUM_FREEBITS_WORDS )
+			return ( -1 );
+
+		unsigned int summaryWord = nextWord >> 6;
+		QWORD summary = _freeWords[summaryWord] & ( ~UCONST64(0) << ( nextWord & 63 ));
+
+		while ( summary == 0 )
+		{
+			if ( ++summaryWord == NUM_FREEWORDS_WORDS )
+				return ( -1 );
+
+			summary = _freeWords[summaryWord];
+		}
+
+		word = ( summaryWord << 6 ) + idlist_CountTrailingZeros ( summary );
+		bits = _freeBits[word];
 	}
+
+	return static_cast<int> (( word << 6 ) + idlist_CountTrailingZeros ( bits ));
 }
 
 //*****************************************************************************
@@ -4807,32 +4890,33 @@ template <typename T>
 unsigned short IDList<T>::getNewID( void )
 {
 	// Actor's network ID is the first availible net ID.
-	unsigned short id = _firstFreeID;
+	// [ZA] IDs are still handed out round-robin, so that a freed ID is not
+	// reused while clients may still refer to its previous owner.
+	int id = findFreeID ( _firstFreeID );
 
-	do
-	{
-		if ( _firstFreeID == ( std::numeric_limits<unsigned short>::max )( ))
-			_firstFreeID = 1;
-		else
-			_firstFreeID++;
+	if ( id < 0 )
+		id = findFreeID ( 1 );
 
-		if ( _firstFreeID == id )
+	if ( id < 0 )
+	{
+		// [BB] In case there is no free netID, the server has to abort the current game.
+		if ( NETWORK_GetState( ) == NETSTATE_SERVER )
 		{
-			// [BB] In case there is no free netID, the server has to abort the current game.
-			if ( NETWORK_GetState( ) == NETSTATE_SERVER )
-			{
-				// [BB] We can only spawn (MAX_NETID-2) actors with netID, because ID zero is reserved and
-				// we already check that a new ID for the next actor is available when assign a net ID.
-				Printf( "ACTOR_GetNewNetID: Network ID limit reached (>=%u actors)\n", ( std::numeric_limits<unsigned short>::max )( ));
-				CountActors ( );
-				I_Error ("Network ID limit reached (>=%u actors)!\n", ( std::numeric_limits<unsigned short>::max )( ));
-			}
-
-			return ( 0 );
+			// [BB] ID zero is reserved, so we can only spawn MAX_NETID-1 actors with a netID.
+			Printf( "ACTOR_GetNewNetID: Network ID limit reached (>=%u actors)\n", ( std::numeric_limits<unsigned short>::max )( ));
+			CountActors ( );
+			I_Error ("Network ID limit reached (>=%u actors)!\n", ( std::numeric_limits<unsigned short>::max )( ));
 		}
-	} while ( _entries[_firstFreeID].bFree == false );
 
-	return ( id );
+		return ( 0 );
+	}
+
+	if ( id == ( std::numeric_limits<unsigned short>::max )( ))
+		_firstFreeID = 1;
+	else
+		_firstFreeID = static_cast<unsigned short> ( id + 1 );
+
+	return static_cast<unsigned short> ( id );
 }
 
 template class IDList<AActor>;
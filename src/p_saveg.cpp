@@ -56,11 +56,15 @@
 #include "deathmatch.h"
 #include "cl_demo.h"
 #include "network.h"
+#include "md5.h"
+#include "version.h"
+#include "c_cvars.h"
 
 static void CopyPlayer (player_t *dst, player_t *src, const char *name);
 static void ReadOnePlayer (FArchive &arc, bool skipload);
 static void ReadMultiplePlayers (FArchive &arc, int numPlayers, int numPlayersNow, bool skipload);
 static void SpawnExtraPlayers ();
+static void SerializeDemoKeyframePlayers (FArchive &arc);
 
 inline FArchive &operator<< (FArchive &arc, FLinkedSector &link)
 {
@@ -76,6 +80,14 @@ void P_SerializePlayers (FArchive &arc, bool skipload)
 	BYTE numPlayers, numPlayersNow;
 	int i;
 
+	// [ZA] Client demo keyframes store the players by their slots, the demo
+	// always replays them in the same slots anyway.
+	if (arc.IsDemoKeyframe())
+	{
+		SerializeDemoKeyframePlayers (arc);
+		return;
+	}
+
 	// Count the number of players present right now.
 	for (numPlayersNow = 0, i = 0; i < MAXPLAYERS; ++i)
 	{
@@ -280,6 +292,38 @@ static void ReadMultiplePlayers (FArchive &arc, int numPlayers, int numPlayersNo
 	delete[] nametemp;
 }
 
+// [ZA] Stores / restores all players of a client demo keyframe by their slots.
+static void SerializeDemoKeyframePlayers (FArchive &arc)
+{
+	for (int i = 0; i < MAXPLAYERS; ++i)
+	{
+		bool ingame = playeringame[i];
+		arc << ingame;
+
+		if (arc.IsStoring())
+		{
+			if (ingame)
+				players[i].Serialize (arc);
+		}
+		else
+		{
+			playeringame[i] = ingame;
+			if (ingame)
+			{
+				player_t playerTemp;
+				playerTemp.Serialize (arc);
+				CopyPlayer (&players[i], &playerTemp, players[i].userinfo.GetName());
+			}
+			// The bodies of players that were not in the game at that time
+			// were already destroyed together with all other thinkers.
+			else
+			{
+				players[i].mo = NULL;
+			}
+		}
+	}
+}
+
 static void CopyPlayer (player_t *dst, player_t *src, const char *name)
 {
 	// The userinfo needs to be saved for real players, but it
@@ -354,19 +398,428 @@ static void SpawnExtraPlayers ()
 	}
 }
 
+//
+// [ZA] World baselines
+//
+// Right before a level's snapshot would be restored, the state of every
+// sector and line of the freshly loaded map is fingerprinted. Snapshots
+// then only need to store the elements whose fingerprint has changed,
+// since restoring a snapshot always starts from a freshly loaded map.
+//
+
+CVAR (Bool, save_deltasnapshots, true, CVAR_ARCHIVE|CVAR_GLOBALCONFIG)
+
+struct FWorldFingerprint
+{
+	BYTE Digest[16];
+};
+
+// Hashes everything an archive writes to it.
+class FFingerprintFile : public FFile
+{
+public:
+	bool Open (const char *, EOpenMode) { return true; }
+	void Close () {}
+	void Flush () {}
+	EOpenMode Mode () const { return EWriting; }
+	bool IsPersistent () const { return false; }
+	bool IsOpen () const { return true; }
+	FFile &Write (const void *mem, unsigned int len) { Context.Update ((const BYTE *)mem, len); return *this; }
+	FFile &Read (void *, unsigned int) { return *this; }
+	unsigned int Tell () const { return 0; }
+	FFile &Seek (int, ESeekPos) { return *this; }
+
+	void Final (BYTE digest[16]) { Context.Final (digest); Context.Init (); }
+
+private:
+	MD5Context Context;
+};
+
+static FString						g_BaselineMap;
+static bool							g_bBaselineClientMode;
+static TArray<FWorldFingerprint>	g_SectorBaseline;
+static TArray<FWorldFingerprint>	g_LineBaseline;
+static TArray<DWORD>				g_LineFlagsBaseline;
+
+//
+// P_SerializeSector
+//
+static void P_SerializeSector (FArchive &arc, sector_t *sec)
+{
+	arc << sec->floorplane
+		<< sec->ceilingplane;
+	if (SaveVersion < 3223)
+	{
+		BYTE bytelight;
+		arc << bytelight;
+		sec->lightlevel = bytelight;
+	}
+	else
+	{
+		arc << sec->lightlevel;
+	}
+	arc << sec->special
+		<< sec->tag
+		<< sec->soundtraversed
+		<< sec->seqType
+		<< sec->friction
+		<< sec->movefactor
+		<< sec->floordata
+		<< sec->ceilingdata
+		<< sec->lightingdata
+		<< sec->stairlock
+		<< sec->prevsec
+		<< sec->nextsec
+		<< sec->planes[sector_t::floor]
+		<< sec->planes[sector_t::ceiling]
+		<< sec->heightsec
+		<< sec->bottommap << sec->midmap << sec->topmap
+		<< sec->gravity
+		<< sec->damage
+		<< sec->mod
+		<< sec->SoundTarget
+		<< sec->SecActTarget
+		<< sec->sky
+		<< sec->MoreFlags
+		<< sec->Flags
+		<< sec->FloorSkyBox << sec->CeilingSkyBox
+		<< sec->ZoneNumber
+		<< sec->secretsector
+		<< sec->interpolations[0]
+		<< sec->interpolations[1]
+		<< sec->interpolations[2]
+		<< sec->interpolations[3]
+		<< sec->SeqName;
+
+	sec->e->Serialize(arc);
+	if (arc.IsStoring ())
+	{
+		arc << sec->ColorMap->Color
+			<< sec->ColorMap->Fade;
+		BYTE sat = sec->ColorMap->Desaturate;
+		arc << sat;
+	}
+	else
+	{
+		PalEntry color, fade;
+		BYTE desaturate;
+		arc << color << fade
+			<< desaturate;
+		sec->ColorMap = GetSpecialLights (color, fade, desaturate);
+	}
+	// begin of GZDoom additions
+	arc << sec->reflect[sector_t::ceiling] << sec->reflect[sector_t::floor];
+	// end of GZDoom additions
+
+	// [BC]
+	arc << sec->floorOrCeiling
+		<< sec->bCeilingHeightChange
+		<< sec->bFloorHeightChange
+		<< sec->SavedCeilingPlane
+		<< sec->SavedFloorPlane
+		<< sec->SavedCeilingTexZ
+		<< sec->SavedFloorTexZ
+		<< sec->bFlatChange
+		<< sec->SavedFloorPic
+		<< sec->SavedCeilingPic
+		<< sec->bLightChange
+		<< sec->SavedLightLevel;
+	if (arc.IsStoring ())
+	{
+		arc << sec->SavedColorMap->Color
+			<< sec->SavedColorMap->Fade;
+		BYTE sat = sec->SavedColorMap->Desaturate;
+		arc << sat;
+	}
+	else
+	{
+		PalEntry color, fade;
+		BYTE desaturate;
+		arc << color << fade
+			<< desaturate;
+		sec->SavedColorMap = GetSpecialLights (color, fade, desaturate);
+	}
+	arc << sec->SavedGravity
+		<< sec->SavedFloorXOffset
+		<< sec->SavedFloorYOffset
+		<< sec->SavedCeilingXOffset
+		<< sec->SavedCeilingYOffset
+		<< sec->SavedFloorXScale
+		<< sec->SavedFloorYScale
+		<< sec->SavedCeilingXScale
+		<< sec->SavedCeilingYScale
+		<< sec->SavedFloorAngle
+		<< sec->SavedCeilingAngle
+		<< sec->SavedBaseFloorAngle
+		<< sec->SavedBaseFloorYOffset
+		<< sec->SavedBaseCeilingAngle
+		<< sec->SavedBaseCeilingYOffset
+		<< sec->SavedFriction
+		<< sec->SavedMoveFactor
+		<< sec->SavedSpecial
+		<< sec->SavedDamage
+		<< sec->SavedMOD
+		<< sec->SavedCeilingReflect
+		<< sec->SavedFloorReflect;
+}
+
+//
+// P_SerializeLine
+//
+static void P_SerializeLine (FArchive &arc, line_t *li)
+{
+	int j;
+
+	arc << li->flags
+		<< li->activation
+		<< li->special
+		<< li->Alpha
+		<< li->id;
+	if (P_IsACSSpecial(li->special))
+	{
+		P_SerializeACSScriptNumber(arc, li->args[0], false);
+	}
+	else
+	{
+		arc << li->args[0];
+	}
+	arc << li->args[1] << li->args[2] << li->args[3] << li->args[4];
+	// [BC]
+	arc << li->TexChangeFlags
+		<< li->SavedSpecial
+		<< li->SavedArgs[0] << li->SavedArgs[1] << li->SavedArgs[2] << li->SavedArgs[3] << li->SavedArgs[4]
+		<< li->SavedFlags
+		<< li->SavedAlpha;
+
+	for (j = 0; j < 2; j++)
+	{
+		if (li->sidedef[j] == NULL)
+			continue;
+
+		side_t *si = li->sidedef[j];
+		arc << si->textures[side_t::top]
+			<< si->textures[side_t::mid]
+			<< si->textures[side_t::bottom]
+			<< si->Light
+			<< si->Flags
+			<< si->LeftSide
+			<< si->RightSide
+			<< si->Index;
+		DBaseDecal::SerializeChain (arc, &si->AttachedDecals);
+		// [BC]
+		arc << si->SavedFlags;
+	}
+}
+
+//
+// P_FingerprintSector / P_FingerprintLine
+//
+// Returns false if the element references any objects. Those never match
+// the freshly loaded map, because its thinkers are replaced on restore.
+//
+static bool P_FingerprintSector (FArchive &arc, FFingerprintFile &file, sector_t *sec, FWorldFingerprint &print)
+{
+	arc.ResetFingerprintObjects ();
+	P_SerializeSector (arc, sec);
+	file.Final (print.Digest);
+	return !arc.HasFingerprintObjects ();
+}
+
+static bool P_FingerprintLine (FArchive &arc, FFingerprintFile &file, line_t *li, FWorldFingerprint &print)
+{
+	arc.ResetFingerprintObjects ();
+	P_SerializeLine (arc, li);
+	file.Final (print.Digest);
+	return !arc.HasFingerprintObjects ();
+}
+
+//
+// P_CaptureWorldBaseline
+//
+void P_CaptureWorldBaseline ()
+{
+	int i;
+
+	g_BaselineMap = level.mapname;
+	g_bBaselineClientMode = NETWORK_InClientMode ();
+	g_SectorBaseline.Clear ();
+	g_LineBaseline.Clear ();
+	g_LineFlagsBaseline.Clear ();
+
+	// Clients only keep track of the line flags.
+	if ( g_bBaselineClientMode )
+	{
+		g_LineFlagsBaseline.Resize (numlines);
+		for (i = 0; i < numlines; i++)
+			g_LineFlagsBaseline[i] = lines[i].flags;
+		return;
+	}
+
+	int savedVersion = SaveVersion;
+	FFingerprintFile file;
+	FArchive arc (file);
+
+	SaveVersion = SAVEVER;
+	arc.SetFingerprint ();
+	g_SectorBaseline.Resize (numsectors);
+	for (i = 0; i < numsectors; i++)
+		P_FingerprintSector (arc, file, &sectors[i], g_SectorBaseline[i]);
+	g_LineBaseline.Resize (numlines);
+	for (i = 0; i < numlines; i++)
+		P_FingerprintLine (arc, file, &lines[i], g_LineBaseline[i]);
+	SaveVersion = savedVersion;
+}
+
+//
+// P_HasWorldBaseline
+//
+static bool P_HasWorldBaseline ()
+{
+	if ( save_deltasnapshots == false )
+		return false;
+
+	if ( g_BaselineMap.CompareNoCase (level.mapname) != 0 || g_bBaselineClientMode != NETWORK_InClientMode () )
+		return false;
+
+	if ( g_bBaselineClientMode )
+		return g_LineFlagsBaseline.Size () == (unsigned)numlines;
+
+	return g_SectorBaseline.Size () == (unsigned)numsectors && g_LineBaseline.Size () == (unsigned)numlines;
+}
+
+//
+// P_SerializeWorldDelta
+//
+// Only the sectors and lines that changed are stored, each preceded by its
+// index. Everything else is left as the freshly loaded map has it.
+//
+static void P_SerializeWorldDelta (FArchive &arc)
+{
+	DWORD count, index;
+	unsigned int i;
+
+	if (arc.IsStoring ())
+	{
+		TArray<DWORD> changedSectors, changedLines;
+		FFingerprintFile file;
+		FArchive fingerprint (file);
+		FWorldFingerprint print;
+
+		fingerprint.SetFingerprint ();
+		for (i = 0; i < (unsigned)numsectors; i++)
+		{
+			if (!P_FingerprintSector (fingerprint, file, &sectors[i], print) || memcmp (print.Digest, g_SectorBaseline[i].Digest, 16))
+				changedSectors.Push (i);
+		}
+		for (i = 0; i < (unsigned)numlines; i++)
+		{
+			if (!P_FingerprintLine (fingerprint, file, &lines[i], print) || memcmp (print.Digest, g_LineBaseline[i].Digest, 16))
+				changedLines.Push (i);
+		}
+
+		count = changedSectors.Size ();
+		arc << count;
+		for (i = 0; i < changedSectors.Size (); i++)
+		{
+			arc << changedSectors[i];
+			P_SerializeSector (arc, &sectors[changedSectors[i]]);
+		}
+		count = changedLines.Size ();
+		arc << count;
+		for (i = 0; i < changedLines.Size (); i++)
+		{
+			arc << changedLines[i];
+			P_SerializeLine (arc, &lines[changedLines[i]]);
+		}
+	}
+	else
+	{
+		arc << count;
+		for (i = 0; i < count; i++)
+		{
+			arc << index;
+			if (index >= (unsigned)numsectors)
+				I_Error ("Level snapshot references sector %u, but the map only has %d", index, numsectors);
+			P_SerializeSector (arc, &sectors[index]);
+		}
+		arc << count;
+		for (i = 0; i < count; i++)
+		{
+			arc << index;
+			if (index >= (unsigned)numlines)
+				I_Error ("Level snapshot references line %u, but the map only has %d", index, numlines);
+			P_SerializeLine (arc, &lines[index]);
+		}
+	}
+}
+
+//
+// P_SerializeLineFlagsDelta
+//
+static void P_SerializeLineFlagsDelta (FArchive &arc)
+{
+	DWORD count, index;
+	unsigned int i;
+
+	if (arc.IsStoring ())
+	{
+		count = 0;
+		for (i = 0; i < (unsigned)numlines; i++)
+		{
+			if (lines[i].flags != g_LineFlagsBaseline[i])
+				count++;
+		}
+		arc << count;
+		for (i = 0; i < (unsigned)numlines; i++)
+		{
+			if (lines[i].flags != g_LineFlagsBaseline[i])
+			{
+				index = i;
+				arc << index << lines[i].flags;
+			}
+		}
+	}
+	else
+	{
+		arc << count;
+		for (i = 0; i < count; i++)
+		{
+			arc << index;
+			if (index >= (unsigned)numlines)
+				I_Error ("Level snapshot references line %u, but the map only has %d", index, numlines);
+			arc << lines[index].flags;
+		}
+	}
+}
+
 //
 // P_ArchiveWorld
 //
 void P_SerializeWorld (FArchive &arc)
 {
-	int i, j;
+	int i;
 	sector_t *sec;
 	line_t *li;
 	zone_t *zn;
+	// [ZA] Does this archive only hold what differs from the freshly loaded map?
+	BYTE delta = false;
+
+	if (SaveVersion >= 4507)
+	{
+		if (arc.IsStoring ())
+			delta = arc.IsWorldDelta () && P_HasWorldBaseline ();
+		arc << delta;
+	}
 
 	// [BC] In client mode, just archive whether or not the line's been seen.
 	if ( NETWORK_InClientMode() )
 	{
+		if ( delta )
+		{
+			P_SerializeLineFlagsDelta (arc);
+			return;
+		}
+
 		// do lines
 		for (i = 0, li = lines; i < numlines; i++, li++)
 		{
@@ -376,167 +829,22 @@ void P_SerializeWorld (FArchive &arc)
 		return;
 	}
 
-	// do sectors
-	for (i = 0, sec = sectors; i < numsectors; i++, sec++)
+	if ( delta )
 	{
-		arc << sec->floorplane
-			<< sec->ceilingplane;
-		if (SaveVersion < 3223)
-		{
-			BYTE bytelight;
-			arc << bytelight;
-			sec->lightlevel = bytelight;
-		}
-		else
-		{
-			arc << sec->lightlevel;
-		}
-		arc << sec->special
-			<< sec->tag
-			<< sec->soundtraversed
-			<< sec->seqType
-			<< sec->friction
-			<< sec->movefactor
-			<< sec->floordata
-			<< sec->ceilingdata
-			<< sec->lightingdata
-			<< sec->stairlock
-			<< sec->prevsec
-			<< sec->nextsec
-			<< sec->planes[sector_t::floor]
-			<< sec->planes[sector_t::ceiling]
-			<< sec->heightsec
-			<< sec->bottommap << sec->midmap << sec->topmap
-			<< sec->gravity
-			<< sec->damage
-			<< sec->mod
-			<< sec->SoundTarget
-			<< sec->SecActTarget
-			<< sec->sky
-			<< sec->MoreFlags
-			<< sec->Flags
-			<< sec->FloorSkyBox << sec->CeilingSkyBox
-			<< sec->ZoneNumber
-			<< sec->secretsector
-			<< sec->interpolations[0]
-			<< sec->interpolations[1]
-			<< sec->interpolations[2]
-			<< sec->interpolations[3]
-			<< sec->SeqName;
-
-		sec->e->Serialize(arc);
-		if (arc.IsStoring ())
-		{
-			arc << sec->ColorMap->Color
-				<< sec->ColorMap->Fade;
-			BYTE sat = sec->ColorMap->Desaturate;
-			arc << sat;
-		}
-		else
+		P_SerializeWorldDelta (arc);
+	}
+	else
+	{
+		// do sectors
+		for (i = 0, sec = sectors; i < numsectors; i++, sec++)
 		{
-			PalEntry color, fade;
-			BYTE desaturate;
-			arc << color << fade
-				<< desaturate;
-			sec->ColorMap = GetSpecialLights (color, fade, desaturate);
+			P_SerializeSector (arc, sec);
 		}
-		// begin of GZDoom additions
-		arc << sec->reflect[sector_t::ceiling] << sec->reflect[sector_t::floor];
-		// end of GZDoom additions
 
-		// [BC]
-		arc << sec->floorOrCeiling
-			<< sec->bCeilingHeightChange
-			<< sec->bFloorHeightChange
-			<< sec->SavedCeilingPlane
-			<< sec->SavedFloorPlane
-			<< sec->SavedCeilingTexZ
-			<< sec->SavedFloorTexZ
-			<< sec->bFlatChange
-			<< sec->SavedFloorPic
-			<< sec->SavedCeilingPic
-			<< sec->bLightChange
-			<< sec->SavedLightLevel;
-		if (arc.IsStoring ())
-		{
-			arc << sec->SavedColorMap->Color
-				<< sec->SavedColorMap->Fade;
-			BYTE sat = sec->SavedColorMap->Desaturate;
-			arc << sat;
-		}
-		else
-		{
-			PalEntry color, fade;
-			BYTE desaturate;
-			arc << color << fade
-				<< desaturate;
-			sec->SavedColorMap = GetSpecialLights (color, fade, desaturate);
-		}
-		arc << sec->SavedGravity
-			<< sec->SavedFloorXOffset
-			<< sec->SavedFloorYOffset
-			<< sec->SavedCeilingXOffset
-			<< sec->SavedCeilingYOffset
-			<< sec->SavedFloorXScale
-			<< sec->SavedFloorYScale
-			<< sec->SavedCeilingXScale
-			<< sec->SavedCeilingYScale
-			<< sec->SavedFloorAngle
-			<< sec->SavedCeilingAngle
-			<< sec->SavedBaseFloorAngle
-			<< sec->SavedBaseFloorYOffset
-			<< sec->SavedBaseCeilingAngle
-			<< sec->SavedBaseCeilingYOffset
-			<< sec->SavedFriction
-			<< sec->SavedMoveFactor
-			<< sec->SavedSpecial
-			<< sec->SavedDamage
-			<< sec->SavedMOD
-			<< sec->SavedCeilingReflect
-			<< sec->SavedFloorReflect;
-	}
-
-	// do lines
-	for (i = 0, li = lines; i < numlines; i++, li++)
-	{
-		arc << li->flags
-			<< li->activation
-			<< li->special
-			<< li->Alpha
-			<< li->id;
-		if (P_IsACSSpecial(li->special))
-		{
-			P_SerializeACSScriptNumber(arc, li->args[0], false);
-		}
-		else
+		// do lines
+		for (i = 0, li = lines; i < numlines; i++, li++)
 		{
-			arc << li->args[0];
-		}
-		arc << li->args[1] << li->args[2] << li->args[3] << li->args[4];
-		// [BC]
-		arc << li->TexChangeFlags
-			<< li->SavedSpecial
-			<< li->SavedArgs[0] << li->SavedArgs[1] << li->SavedArgs[2] << li->SavedArgs[3] << li->SavedArgs[4]
-			<< li->SavedFlags
-			<< li->SavedAlpha;
-
-		for (j = 0; j < 2; j++)
-		{
-			if (li->sidedef[j] == NULL)
-				continue;
-
-			side_t *si = li->sidedef[j];
-			arc << si->textures[side_t::top]
-				<< si->textures[side_t::mid]
-				<< si->textures[side_t::bottom]
-				<< si->Light
-				<< si->Flags
-				<< si->LeftSide
-				<< si->RightSide
-				<< si->Index;
-			DBaseDecal::SerializeChain (arc, &si->AttachedDecals);
-			// [BC]
-			arc << si->SavedFlags;
+			P_SerializeLine (arc, li);
 		}
 	}
 
@@ -47,6 +47,9 @@ void P_SerializePolyobjs (FArchive &arc);
 void P_SerializeSubsectors(FArchive &arc);
 void P_SerializeSounds (FArchive &arc);
 
+// [ZA] Remembers the freshly loaded map, so snapshots only need to store what changed.
+void P_CaptureWorldBaseline ();
+
 void P_ReadACSDefereds (PNGHandle *png);
 void P_WriteACSDefereds (FILE *file);
 
@@ -0,0 +1,781 @@
+//-----------------------------------------------------------------------------
+//
+// Zandronum Source
+// Copyright (C) 2026 Zandronum Development Team
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 3. Neither the name of the Zandronum Development Team nor the names of its
+//    contributors may be used to endorse or promote products derived from this
+//    software without specific prior written permission.
+// 4. Redistributions in any form must be accompanied by information on how to
+//    obtain complete source code for the software and any accompanying
+//    software that uses the software. The source code must either be included
+//    in the distribution or be available for no more than the cost of
+//    distribution plus a nominal fee, and must be freely redistributable
+//    under reasonable conditions. For an executable file, complete source
+//    code means the source code for all modules it contains. It does not
+//    include source code for modules or files that typically accompany the
+//    major components of the operating system on which the executable file
+//    runs.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+//
+// Filename: p_sectorvis.cpp
+//
+// Description: Builds a conservative sector visibility matrix for maps without a REJECT lump.
+//
+// Many maps, particularly newer ones, ship with an empty REJECT lump, so
+// every P_CheckSight call has to trace through the blockmap. This builds
+// the sector-to-sector potential visibility a REJECT lump would have held
+// and installs it as the reject matrix.
+//
+// Visibility is computed in 2D with portal flow over the two-sided lines
+// between different sectors. Heights, doors and line flags are ignored,
+// since they can all change while the map is running, so a sector is only
+// rejected if no straight line can get to it through the map's geometry.
+//
+// The result is stored in the cache directory, keyed by the MD5 of the map.
+//
+//-----------------------------------------------------------------------------
+
+#include <algorithm>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <zlib.h>
+
+#include "doomtype.h"
+#include "c_cvars.h"
+#include "cmdlib.h"
+#include "i_system.h"
+#include "m_misc.h"
+#include "m_swap.h"
+#include "p_local.h"
+#include "p_sectorvis.h"
+#include "p_setup.h"
+#include "r_defs.h"
+#include "r_state.h"
+#include "stats.h"
+#include "templates.h"
+
+// Bump this whenever the layout of the cache file or the way the matrix is
+// computed changes.
+#define SECTORVIS_VERSION	2
+
+// Larger maps would need more than 32 MB for the matrix.
+#define SECTORVIS_MAXSECTORS	16384
+
+// Portal flow work allowed per source sector before giving up on it and
+// treating everything it connects to as visible.
+#define SECTORVIS_MAXSTEPS	50000
+
+// How far outside of a clipping line (in map units) a point may still be
+// considered inside. Errs on the side of seeing too much.
+#define SECTORVIS_EPSILON	0.5
+
+CVAR (Bool, sv_buildreject, false, CVAR_ARCHIVE|CVAR_GLOBALCONFIG)
+
+//==========================================================================
+//
+// Geometry
+//
+//==========================================================================
+
+struct FVisSeg
+{
+	double x1, y1, x2, y2;
+};
+
+struct FVisPortal
+{
+	FVisSeg Seg;
+	int Line;
+	int Sector;		// The sector on the other side
+	double Sign;	// Side of the line the other sector is on
+};
+
+// Signed distance of (x,y) from the line through a and b, positive on the left.
+static inline double DistFromLine (double ax, double ay, double bx, double by, double x, double y)
+{
+	const double dx = bx - ax, dy = by - ay;
+
+	return (dx * (y - ay) - dy * (x - ax)) / sqrt (dx*dx + dy*dy);
+}
+
+//==========================================================================
+//
+// ClipSeg
+//
+// Cuts away the part of seg that is more than SECTORVIS_EPSILON on the
+// wrong side of the line through a and b. The kept side is the one with
+// the same sign as keep. Returns false if nothing is left.
+//
+//==========================================================================
+
+static bool ClipSeg (FVisSeg &seg, double ax, double ay, double bx, double by, double keep)
+{
+	const double d1 = DistFromLine (ax, ay, bx, by, seg.x1, seg.y1) * keep + SECTORVIS_EPSILON;
+	const double d2 = DistFromLine (ax, ay, bx, by, seg.x2, seg.y2) * keep + SECTORVIS_EPSILON;
+
+	if (d1 < 0 && d2 < 0)
+	{
+		return false;
+	}
+	if (d1 < 0)
+	{
+		const double t = d1 / (d1 - d2);
+		seg.x1 += (seg.x2 - seg.x1) * t;
+		seg.y1 += (seg.y2 - seg.y1) * t;
+	}
+	else if (d2 < 0)
+	{
+		const double t = d2 / (d2 - d1);
+		seg.x2 += (seg.x1 - seg.x2) * t;
+		seg.y2 += (seg.y1 - seg.y2) * t;
+	}
+	return true;
+}
+
+//==========================================================================
+//
+// ClipToSeparators
+//
+// Clips target to the area behind pass that can be seen from source
+// through pass. The area is bounded by the lines through one end of
+// source and one end of pass that have the rest of source and pass on
+// opposite sides.
+//
+//==========================================================================
+
+static bool ClipToSeparators (const FVisSeg &source, const FVisSeg &pass, FVisSeg &target)
+{
+	const double sx[2] = { source.x1, source.x2 }, sy[2] = { source.y1, source.y2 };
+	const double px[2] = { pass.x1, pass.x2 }, py[2] = { pass.y1, pass.y2 };
+
+	for (int i = 0; i < 2; ++i)
+	{
+		for (int j = 0; j < 2; ++j)
+		{
+			const double dx = px[j] - sx[i], dy = py[j] - sy[i];
+
+			// Portals that share a vertex say nothing about each other.
+			if (dx*dx + dy*dy < SECTORVIS_EPSILON * SECTORVIS_EPSILON)
+			{
+				continue;
+			}
+
+			const double sside = DistFromLine (sx[i], sy[i], px[j], py[j], sx[1-i], sy[1-i]);
+			const double pside = DistFromLine (sx[i], sy[i], px[j], py[j], px[1-j], py[1-j]);
+
+			if ((sside < -SECTORVIS_EPSILON && pside > SECTORVIS_EPSILON) ||
+				(sside > SECTORVIS_EPSILON && pside < -SECTORVIS_EPSILON))
+			{
+				if (!ClipSeg (target, sx[i], sy[i], px[j], py[j], pside > 0 ? 1. : -1.))
+				{
+					return false;
+				}
+			}
+		}
+	}
+	return true;
+}
+
+//==========================================================================
+//
+// FSectorVisBuilder
+//
+//==========================================================================
+
+class FSectorVisBuilder
+{
+public:
+	FSectorVisBuilder ();
+	bool CheckClosedSectors () const;
+	void Build (BYTE *reject);
+
+	int NumFallbacks;
+
+private:
+	struct FFrame
+	{
+		int Sector;
+		FVisSeg Source;
+		FVisSeg Pass;
+		const FVisPortal *PassPortal;
+		unsigned int NextPortal;
+	};
+
+	void FlowFrom (int sector);
+	void FloodFrom (int sector);
+	const BYTE *GetMightSee (unsigned int portal);
+	bool AddsNothing (const BYTE *mightsee) const;
+
+	inline void SetVisible (int to)
+	{
+		Row[to >> 3] |= 1 << (to & 7);
+	}
+
+	TArray<FVisPortal> Portals;
+	TArray<unsigned int> FirstPortal;	// per sector, plus an end marker
+	TArray<FFrame> Stack;
+	TArray<bool> OnPath;
+	TArray<BYTE> MightSee;				// per portal, a row of sectors
+	TArray<bool> MightSeeDone;
+	TArray<bool> SelfReferencing;		// per sector
+	size_t RowBytes;
+	BYTE *Row;
+};
+
+FSectorVisBuilder::FSectorVisBuilder ()
+{
+	TArray<int> counts;
+
+	NumFallbacks = 0;
+	Row = NULL;
+	counts.Resize (numsectors + 1);
+	memset (&counts[0], 0, sizeof(int) * (numsectors + 1));
+	SelfReferencing.Resize (numsectors);
+	memset (&SelfReferencing[0], 0, sizeof(bool) * numsectors);
+
+	for (int i = 0; i < numlines; ++i)
+	{
+		const line_t *line = &lines[i];
+		if (line->frontsector != NULL && line->backsector != NULL)
+		{
+			if (line->frontsector == line->backsector)
+			{
+				SelfReferencing[int(line->frontsector - sectors)] = true;
+			}
+			else
+			{
+				counts[int(line->frontsector - sectors)]++;
+				counts[int(line->backsector - sectors)]++;
+			}
+		}
+	}
+
+	FirstPortal.Resize (numsectors + 1);
+	FirstPortal[0] = 0;
+	for (int i = 0; i < numsectors; ++i)
+	{
+		FirstPortal[i + 1] = FirstPortal[i] + counts[i];
+		counts[i] = FirstPortal[i];
+	}
+	Portals.Resize (FirstPortal[numsectors]);
+
+	for (int i = 0; i < numlines; ++i)
+	{
+		const line_t *line = &lines[i];
+		if (line->frontsector == NULL || line->backsector == NULL || line->frontsector == line->backsector)
+		{
+			continue;
+		}
+
+		FVisSeg seg = { FIXED2DBL(line->v1->x), FIXED2DBL(line->v1->y), FIXED2DBL(line->v2->x), FIXED2DBL(line->v2->y) };
+		const int front = int(line->frontsector - sectors);
+		const int back = int(line->backsector - sectors);
+
+		// The front sector is on the right of the line, the back sector on the left.
+		FVisPortal &toback = Portals[counts[front]++];
+		toback.Seg = seg;
+		toback.Line = i;
+		toback.Sector = back;
+		toback.Sign = 1;
+
+		FVisPortal &tofront = Portals[counts[back]++];
+		tofront.Seg = seg;
+		tofront.Line = i;
+		tofront.Sector = front;
+		tofront.Sign = -1;
+	}
+
+	OnPath.Resize (numsectors);
+	memset (&OnPath[0], 0, sizeof(bool) * numsectors);
+
+	RowBytes = (numsectors + 7) / 8;
+}
+
+//==========================================================================
+//
+// FSectorVisBuilder :: CheckClosedSectors
+//
+// Portal flow assumes a line of sight leaving a sector can only enter one
+// of its neighbors. That is only true if every sector's outline is closed,
+// so broken maps get no matrix at all.
+//
+//==========================================================================
+
+bool FSectorVisBuilder::CheckClosedSectors () const
+{
+	TArray<QWORD> ends;
+
+	for (int i = 0; i < numlines; ++i)
+	{
+		const line_t *line = &lines[i];
+
+		for (int side = 0; side < 2; ++side)
+		{
+			const sector_t *sec = side == 0 ? line->frontsector : line->backsector;
+			if (sec == NULL)
+			{
+				continue;
+			}
+
+			const QWORD secnum = QWORD(sec - sectors) << 32;
+			ends.Push (secnum | DWORD(line->v1 - vertexes));
+			ends.Push (secnum | DWORD(line->v2 - vertexes));
+		}
+	}
+
+	if (ends.Size() == 0)
+	{
+		return true;
+	}
+
+	// Every vertex must be used by an even number of each sector's lines.
+	std::sort (&ends[0], &ends[0] + ends.Size());
+	for (unsigned int i = 0; i < ends.Size(); i += 2)
+	{
+		if (i + 1 == ends.Size() || ends[i] != ends[i + 1])
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+//==========================================================================
+//
+// FSectorVisBuilder :: Build
+//
+// Fills reject with a bit for every pair of sectors that cannot see each
+// other, in the same layout as a REJECT lump.
+//
+//==========================================================================
+
+void FSectorVisBuilder::Build (BYTE *reject)
+{
+	const size_t rowbytes = RowBytes;
+	TArray<BYTE> vis;
+
+	// Skip the pruning on maps where it would need too much memory.
+	if (double(Portals.Size()) * rowbytes <= 64. * 1024 * 1024)
+	{
+		MightSee.Resize (unsigned(Portals.Size() * rowbytes));
+		MightSeeDone.Resize (Portals.Size());
+		if (Portals.Size() > 0)
+		{
+			memset (&MightSeeDone[0], 0, sizeof(bool) * Portals.Size());
+		}
+	}
+
+	vis.Resize (unsigned(rowbytes * numsectors));
+	memset (&vis[0], 0, rowbytes * numsectors);
+
+	for (int i = 0; i < numsectors; ++i)
+	{
+		Row = &vis[unsigned(rowbytes * i)];
+		FlowFrom (i);
+	}
+
+	// Sight works both ways, so keep a pair if either direction found it.
+	const size_t rejectsize = (size_t(numsectors) * numsectors + 7) / 8;
+	memset (reject, 0xFF, rejectsize);
+
+	for (int i = 0; i < numsectors; ++i)
+	{
+		const BYTE *row = &vis[unsigned(rowbytes * i)];
+
+		for (int j = 0; j < numsectors; ++j)
+		{
+			if ((row[j >> 3] & (1 << (j & 7))) || (vis[unsigned(rowbytes * j + (i >> 3))] & (1 << (i & 7))))
+			{
+				const size_t pnum = size_t(i) * numsectors + j;
+				reject[pnum >> 3] &= ~(1 << (pnum & 7));
+			}
+		}
+	}
+
+	// A sector with lines that have it on both sides is usually drawn as part
+	// of whatever surrounds it (deep water, invisible bridges), and its lines
+	// are no portals to anywhere. Nothing can be said about what it sees.
+	for (int i = 0; i < numsectors; ++i)
+	{
+		if (!SelfReferencing[i])
+		{
+			continue;
+		}
+
+		for (int j = 0; j < numsectors; ++j)
+		{
+			const size_t from = size_t(i) * numsectors + j;
+			const size_t to = size_t(j) * numsectors + i;
+			reject[from >> 3] &= ~(1 << (from & 7));
+			reject[to >> 3] &= ~(1 << (to & 7));
+		}
+	}
+}
+
+//==========================================================================
+//
+// FSectorVisBuilder :: FlowFrom
+//
+// Follows every chain of portals that a straight line starting in the
+// given sector could pass through. Each step narrows the part of the
+// first portal and the current portal the line can still go through,
+// like the vis tools for Quake do in 3D.
+//
+//==========================================================================
+
+void FSectorVisBuilder::FlowFrom (int sector)
+{
+	int steps = 0;
+
+	SetVisible (sector);
+	OnPath[sector] = true;
+
+	for (unsigned int p = FirstPortal[sector]; p < FirstPortal[sector + 1]; ++p)
+	{
+		const FVisPortal &first = Portals[p];
+
+		// Neighbors are always visible.
+		SetVisible (first.Sector);
+		if (OnPath[first.Sector])
+		{
+			continue;
+		}
+
+		FFrame root = { first.Sector, first.Seg, first.Seg, &first, FirstPortal[first.Sector] };
+		Stack.Push (root);
+		OnPath[first.Sector] = true;
+
+		while (Stack.Size() > 0)
+		{
+			FFrame &frame = Stack.Last();
+
+			if (frame.NextPortal == FirstPortal[frame.Sector + 1])
+			{
+				OnPath[frame.Sector] = false;
+				Stack.Pop ();
+				continue;
+			}
+
+			const FVisPortal &next = Portals[frame.NextPortal++];
+			if (next.Line == frame.PassPortal->Line || OnPath[next.Sector])
+			{
+				continue;
+			}
+
+			if (++steps > SECTORVIS_MAXSTEPS)
+			{
+				// Too much work; fall back to everything this sector connects to.
+				for (unsigned int i = 0; i < Stack.Size(); ++i)
+				{
+					OnPath[Stack[i].Sector] = false;
+				}
+				Stack.Clear ();
+				OnPath[sector] = false;
+				NumFallbacks++;
+				FloodFrom (sector);
+				return;
+			}
+
+			// The line has to continue on the far side of the portal it came through.
+			FVisSeg target = next.Seg;
+			const FVisSeg &passline = frame.PassPortal->Seg;
+			if (!ClipSeg (target, passline.x1, passline.y1, passline.x2, passline.y2, frame.PassPortal->Sign))
+			{
+				continue;
+			}
+
+			// And it has to be a line that also went through the source portal.
+			// For the first hop source and pass are the same, so any target works.
+			const bool firsthop = (Stack.Size() == 1);
+			if (!firsthop && !ClipToSeparators (frame.Source, frame.Pass, target))
+			{
+				continue;
+			}
+
+			SetVisible (next.Sector);
+
+			// Nothing to gain from going on if everything behind this portal
+			// is already known to be visible.
+			const BYTE *mightsee = GetMightSee (unsigned(&next - &Portals[0]));
+			if (mightsee != NULL && AddsNothing (mightsee))
+			{
+				continue;
+			}
+
+			// Narrow the source to what can still reach the new portal.
+			FVisSeg source = frame.Source;
+			if (!firsthop && !ClipToSeparators (target, frame.Pass, source))
+			{
+				continue;
+			}
+
+			FFrame child = { next.Sector, source, target, &next, FirstPortal[next.Sector] };
+			OnPath[next.Sector] = true;
+			Stack.Push (child);
+		}
+	}
+
+	OnPath[sector] = false;
+}
+
+//==========================================================================
+//
+// FSectorVisBuilder :: GetMightSee
+//
+// Returns a rough superset of the sectors that can be seen through a
+// portal: everything that can be reached through portals that are at
+// least partly in front of it. A line of sight that went through the
+// portal never comes back to its near side, so nothing else can be seen.
+//
+//==========================================================================
+
+const BYTE *FSectorVisBuilder::GetMightSee (unsigned int portal)
+{
+	if (MightSeeDone.Size() == 0)
+	{
+		return NULL;
+	}
+
+	BYTE *row = &MightSee[unsigned(portal * RowBytes)];
+	if (MightSeeDone[portal])
+	{
+		return row;
+	}
+
+	const FVisPortal &base = Portals[portal];
+	TArray<int> queue;
+
+	memset (row, 0, RowBytes);
+	queue.Push (base.Sector);
+	row[base.Sector >> 3] |= 1 << (base.Sector & 7);
+
+	for (unsigned int head = 0; head < queue.Size(); ++head)
+	{
+		const int sec = queue[head];
+
+		for (unsigned int p = FirstPortal[sec]; p < FirstPortal[sec + 1]; ++p)
+		{
+			const FVisPortal &next = Portals[p];
+			if (next.Line == base.Line || (row[next.Sector >> 3] & (1 << (next.Sector & 7))))
+			{
+				continue;
+			}
+
+			FVisSeg seg = next.Seg;
+			if (ClipSeg (seg, base.Seg.x1, base.Seg.y1, base.Seg.x2, base.Seg.y2, base.Sign))
+			{
+				row[next.Sector >> 3] |= 1 << (next.Sector & 7);
+				queue.Push (next.Sector);
+			}
+		}
+	}
+
+	MightSeeDone[portal] = true;
+	return row;
+}
+
+//==========================================================================
+//
+// FSectorVisBuilder :: AddsNothing
+//
+//==========================================================================
+
+bool FSectorVisBuilder::AddsNothing (const BYTE *mightsee) const
+{
+	for (size_t i = 0; i < RowBytes; ++i)
+	{
+		if (mightsee[i] & ~Row[i])
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+//==========================================================================
+//
+// FSectorVisBuilder :: FloodFrom
+//
+// Marks every sector reachable through any chain of portals.
+//
+//==========================================================================
+
+void FSectorVisBuilder::FloodFrom (int sector)
+{
+	TArray<int> queue;
+	TArray<bool> seen;
+
+	seen.Resize (numsectors);
+	memset (&seen[0], 0, sizeof(bool) * numsectors);
+	queue.Push (sector);
+	seen[sector] = true;
+
+	for (unsigned int head = 0; head < queue.Size(); ++head)
+	{
+		const int sec = queue[head];
+
+		SetVisible (sec);
+		for (unsigned int p = FirstPortal[sec]; p < FirstPortal[sec + 1]; ++p)
+		{
+			if (!seen[Portals[p].Sector])
+			{
+				seen[Portals[p].Sector] = true;
+				queue.Push (Portals[p].Sector);
+			}
+		}
+	}
+}
+
+//==========================================================================
+//
+// Cache file
+//
+//==========================================================================
+
+static FString CreateCacheName (const BYTE md5[16], bool create)
+{
+	FString path = M_GetCachePath(create);
+	path << "/sectorvis";
+	if (create) CreatePath(path);
+
+	path << '/';
+	for (int i = 0; i < 16; ++i)
+	{
+		path.AppendFormat ("%02x", md5[i]);
+	}
+	path << ".zvc";
+	return path;
+}
+
+static bool LoadCachedReject (const BYTE md5[16], BYTE *reject, size_t rejectsize)
+{
+	char magic[4];
+	DWORD header[3];
+	long filelen;
+	uLongf outlen;
+	BYTE *compressed = NULL;
+	bool ok = false;
+
+	FString path = CreateCacheName(md5, false);
+	FILE *f = fopen(path, "rb");
+	if (f == NULL) return false;
+
+	if (fread(magic, 1, 4, f) != 4 || memcmp(magic, "ZVIS", 4)) goto done;
+	if (fread(header, 4, 3, f) != 3) goto done;
+	if (LittleLong(header[0]) != SECTORVIS_VERSION || LittleLong(header[1]) != DWORD(numsectors) ||
+		LittleLong(header[2]) != DWORD(numlines)) goto done;
+
+	filelen = ftell(f);
+	fseek(f, 0, SEEK_END);
+	filelen = ftell(f) - filelen;
+	fseek(f, -filelen, SEEK_END);
+	if (filelen <= 0) goto done;
+
+	compressed = new BYTE[filelen];
+	if (fread(compressed, 1, filelen, f) != (size_t)filelen) goto done;
+	outlen = uLongf(rejectsize);
+	ok = uncompress(reject, &outlen, compressed, filelen) == Z_OK && outlen == rejectsize;
+
+done:
+	delete[] compressed;
+	fclose(f);
+	return ok;
+}
+
+static void SaveCachedReject (const BYTE md5[16], const BYTE *reject, size_t rejectsize)
+{
+	uLongf outlen = compressBound(uLong(rejectsize));
+	BYTE *compressed = new BYTE[outlen];
+
+	if (compress(compressed, &outlen, reject, uLong(rejectsize)) == Z_OK)
+	{
+		DWORD header[3] = { LittleLong(DWORD(SECTORVIS_VERSION)), LittleLong(DWORD(numsectors)), LittleLong(DWORD(numlines)) };
+		FString path = CreateCacheName(md5, true);
+		FILE *f = fopen(path, "wb");
+
+		if (f != NULL)
+		{
+			if (fwrite("ZVIS", 4, 1, f) != 1 || fwrite(header, 4, 3, f) != 3 || fwrite(compressed, outlen, 1, f) != 1)
+			{
+				Printf("Error saving sector visibility to file %s\n", path.GetChars());
+			}
+			fclose(f);
+		}
+		else
+		{
+			Printf("Cannot open sector visibility file %s for writing\n", path.GetChars());
+		}
+	}
+	delete[] compressed;
+}
+
+//==========================================================================
+//
+// P_BuildSectorVisibility
+//
+// Called after P_LoadReject. Does nothing unless the map came without a
+// usable REJECT lump.
+//
+//==========================================================================
+
+void P_BuildSectorVisibility (MapData *map)
+{
+	if (!sv_buildreject || rejectmatrix != NULL || numsectors <= 1 || numsectors > SECTORVIS_MAXSECTORS)
+	{
+		return;
+	}
+
+	const size_t rejectsize = (size_t(numsectors) * numsectors + 7) / 8;
+	BYTE md5[16];
+	BYTE *reject = new BYTE[rejectsize];
+
+	map->GetChecksum(md5);
+	if (LoadCachedReject (md5, reject, rejectsize))
+	{
+		rejectmatrix = reject;
+		return;
+	}
+
+	FSectorVisBuilder builder;
+	if (!builder.CheckClosedSectors ())
+	{
+		DPrintf ("Not building sector visibility: the map has unclosed sectors.\n");
+		delete[] reject;
+		return;
+	}
+
+	cycle_t buildtime;
+	buildtime.Reset();
+	buildtime.Clock();
+	builder.Build (reject);
+	buildtime.Unclock();
+
+	DPrintf ("Sector visibility took %.3f ms (%d of %d sectors fell back to flooding)\n",
+		buildtime.TimeMS(), builder.NumFallbacks, numsectors);
+
+	rejectmatrix = reject;
+	SaveCachedReject (md5, reject, rejectsize);
+}
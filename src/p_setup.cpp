@@ -90,6 +90,8 @@
 
 // [BB] New #includes..
 #include "gl/dynlights/gl_dynlight.h"
+// [ZA] New #includes.
+#include "p_sectorvis.h"
 
 #define MISSING_TEXTURE_WARN_LIMIT		20
 
@@ -4356,6 +4358,8 @@ void P_SetupLevel (char *lumpname, int position)
 
 	times[11].Clock();
 	P_LoadReject (map, buildmap);
+	// [ZA] Maps without a REJECT lump can get a computed one.
+	P_BuildSectorVisibility (map);
 	times[11].Unclock();
 
 	times[12].Clock();
@@ -127,6 +127,9 @@ void P_Ticker (void)
 
 	P_NewPspriteTick();
 
+	// [ZA] The server needs these too, it is where most explosions happen.
+	P_ResetRadiusAttackCounters ();
+
 	// [BC] Server doesn't need any of this.
 	if ( NETWORK_GetState( ) != NETSTATE_SERVER )
 	{
@@ -398,6 +401,9 @@ void P_Ticker (void)
 	// which are called by DThinker::RunThinkers (). The client only knows these tids once the
 	// server send him a full update, i.e. CLIENT_GetConnectionState() == CTS_ACTIVE.
 	// I have no idea if this has unwanted side effects. Has to be checked.
+	// [ZA] Objects freed during this tic are swept at the end of it.
+	GC::DeferSweep = true;
+
 	if(( NETWORK_GetState( ) != NETSTATE_CLIENT ) || (CLIENT_GetConnectionState() == CTS_ACTIVE))
 		DThinker::RunThinkers ();
 
@@ -437,4 +443,7 @@ void P_Ticker (void)
 			TEAM_Tick( );
 		}
 	}
+
+	// [ZA] Now do the sweeping that was put off during the tic.
+	GC::SweepTail ();
 }
@@ -46,6 +46,8 @@
 #include "gi.h"
 #include "stats.h"
 #include "x86.h"
+// [ZA] New #includes.
+#include "r_thread.h"
 
 #undef RANGECHECK
 
@@ -66,7 +68,7 @@ BYTE*			viewimage;
 extern "C" {
 int				halfviewwidth;
 int				ylookup[MAXHEIGHT];
-BYTE			*dc_destorg;
+DRAWER_TLS BYTE	*dc_destorg;
 }
 int 			scaledviewwidth;
 
@@ -85,43 +87,50 @@ void (*R_DrawSpanMaskedTranslucent)(void);
 void (*R_DrawSpanAddClamp)(void);
 void (*R_DrawSpanMaskedAddClamp)(void);
 void (STACK_ARGS *rt_map4cols)(int,int,int);
+#ifndef X86_ASM
+void (STACK_ARGS *rt_shaded4cols)(int,int,int);
+void (STACK_ARGS *rt_add4cols)(int,int,int);
+void (STACK_ARGS *rt_addclamp4cols)(int,int,int);
+void (STACK_ARGS *rt_subclamp4cols)(int,int,int);
+void (STACK_ARGS *rt_revsubclamp4cols)(int,int,int);
+#endif
 
 //
 // R_DrawColumn
 // Source is the top of the column to scale.
 //
 extern "C" {
-int				dc_pitch=0xABadCafe;	// [RH] Distance between rows
-
-lighttable_t*	dc_colormap; 
-int 			dc_x; 
-int 			dc_yl; 
-int 			dc_yh; 
-fixed_t 		dc_iscale; 
-fixed_t 		dc_texturemid;
-fixed_t			dc_texturefrac;
-int				dc_color;				// [RH] Color for column filler
-DWORD			dc_srccolor;
-DWORD			*dc_srcblend;			// [RH] Source and destination
-DWORD			*dc_destblend;			// blending lookups
+DRAWER_TLS int				dc_pitch=0xABadCafe;	// [RH] Distance between rows
+
+DRAWER_TLS lighttable_t*	dc_colormap; 
+DRAWER_TLS int 			dc_x; 
+DRAWER_TLS int 			dc_yl; 
+DRAWER_TLS int 			dc_yh; 
+DRAWER_TLS fixed_t 		dc_iscale; 
+DRAWER_TLS fixed_t 		dc_texturemid;
+DRAWER_TLS fixed_t			dc_texturefrac;
+DRAWER_TLS int				dc_color;				// [RH] Color for column filler
+DRAWER_TLS DWORD			dc_srccolor;
+DRAWER_TLS DWORD			*dc_srcblend;			// [RH] Source and destination
+DRAWER_TLS DWORD			*dc_destblend;			// blending lookups
 
 // first pixel in a column (possibly virtual) 
-const BYTE*		dc_source;				
+DRAWER_TLS const BYTE*		dc_source;				
 
-BYTE*			dc_dest;
-int				dc_count;
+DRAWER_TLS BYTE*			dc_dest;
+DRAWER_TLS int				dc_count;
 
-DWORD			vplce[4];
-DWORD			vince[4];
-BYTE*			palookupoffse[4];
-const BYTE*		bufplce[4];
+DRAWER_TLS DWORD			vplce[4];
+DRAWER_TLS DWORD			vince[4];
+DRAWER_TLS BYTE*			palookupoffse[4];
+DRAWER_TLS const BYTE*		bufplce[4];
 
 // just for profiling 
 int 			dccount;
 }
 
 int dc_fillcolor;
-BYTE *dc_translation;
+DRAWER_TLS BYTE *dc_translation;
 BYTE shadetables[NUMCOLORMAPS*16*256];
 FDynamicColormap ShadeFakeColormap[16];
 BYTE identitymap[256];
@@ -184,6 +193,9 @@ void R_InitShadeMaps()
 // 
 void R_DrawColumnP_C (void)
 {
+	if (DrawerQueue.IsRecording ())
+		return DrawerQueue.QueueColumn (R_DrawColumnP_C);
+
 	int 				count;
 	BYTE*				dest;
 	fixed_t 			frac;
@@ -230,6 +242,9 @@ void R_DrawColumnP_C (void)
 // [RH] Just fills a column with a color
 void R_FillColumnP (void)
 {
+	if (DrawerQueue.IsRecording ())
+		return DrawerQueue.QueueColumn (R_FillColumnP);
+
 	int 				count;
 	BYTE*				dest;
 
@@ -254,6 +269,9 @@ void R_FillColumnP (void)
 
 void R_FillAddColumn (void)
 {
+	if (DrawerQueue.IsRecording ())
+		return DrawerQueue.QueueColumn (R_FillAddColumn);
+
 	int count;
 	BYTE *dest;
 
@@ -281,6 +299,9 @@ void R_FillAddColumn (void)
 
 void R_FillAddClampColumn (void)
 {
+	if (DrawerQueue.IsRecording ())
+		return DrawerQueue.QueueColumn (R_FillAddClampColumn);
+
 	int count;
 	BYTE *dest;
 
@@ -314,6 +335,9 @@ void R_FillAddClampColumn (void)
 
 void R_FillSubClampColumn (void)
 {
+	if (DrawerQueue.IsRecording ())
+		return DrawerQueue.QueueColumn (R_FillSubClampColumn);
+
 	int count;
 	BYTE *dest;
 
@@ -346,6 +370,9 @@ void R_FillSubClampColumn (void)
 
 void R_FillRevSubClampColumn (void)
 {
+	if (DrawerQueue.IsRecording ())
+		return DrawerQueue.QueueColumn (R_FillRevSubClampColumn);
+
 	int count;
 	BYTE *dest;
 
@@ -379,12 +406,10 @@ void R_FillRevSubClampColumn (void)
 //
 // Spectre/Invisibility.
 //
-#define FUZZTABLE	50
-
 extern "C"
 {
 int 	fuzzoffset[FUZZTABLE+1];	// [RH] +1 for the assembly routine
-int 	fuzzpos = 0; 
+DRAWER_TLS int fuzzpos = 0; 
 int		fuzzviewheight;
 }
 /*
@@ -444,6 +469,14 @@ void R_DrawFuzzColumnP_C (void)
 
 	count++;
 
+	// [ZA] The queue cannot tell where the fuzz table will be afterwards.
+	if (DrawerQueue.IsRecording ())
+	{
+		DrawerQueue.QueueFuzz (R_DrawFuzzColumnP_C);
+		fuzzpos = (fuzzpos + count) % FUZZTABLE;
+		return;
+	}
+
 	dest = ylookup[dc_yl] + dc_x + dc_destorg;
 
 	// colormap #6 is used for shading (of 0-31, a bit brighter than average)
@@ -543,6 +576,9 @@ algorithm that uses RGB tables.
 
 void R_DrawAddColumnP_C (void)
 {
+	if (DrawerQueue.IsRecording ())
+		return DrawerQueue.QueueColumn (R_DrawAddColumnP_C);
+
 	int count;
 	BYTE *dest;
 	fixed_t frac;
@@ -589,6 +625,9 @@ void R_DrawAddColumnP_C (void)
 
 void R_DrawTranslatedColumnP_C (void)
 { 
+	if (DrawerQueue.IsRecording ())
+		return DrawerQueue.QueueColumn (R_DrawTranslatedColumnP_C);
+
 	int 				count;
 	BYTE*				dest;
 	fixed_t 			frac;
@@ -623,6 +662,9 @@ void R_DrawTranslatedColumnP_C (void)
 // Draw a column that is both translated and translucent
 void R_DrawTlatedAddColumnP_C (void)
 {
+	if (DrawerQueue.IsRecording ())
+		return DrawerQueue.QueueColumn (R_DrawTlatedAddColumnP_C);
+
 	int count;
 	BYTE *dest;
 	fixed_t frac;
@@ -664,6 +706,9 @@ void R_DrawTlatedAddColumnP_C (void)
 // levels for a base color stored in dc_color.
 void R_DrawShadedColumnP_C (void)
 {
+	if (DrawerQueue.IsRecording ())
+		return DrawerQueue.QueueColumn (R_DrawShadedColumnP_C);
+
 	int  count;
 	BYTE *dest;
 	fixed_t frac, fracstep;
@@ -700,6 +745,9 @@ void R_DrawShadedColumnP_C (void)
 // Add source to destination, clamping it to white
 void R_DrawAddClampColumnP_C ()
 {
+	if (DrawerQueue.IsRecording ())
+		return DrawerQueue.QueueColumn (R_DrawAddClampColumnP_C);
+
 	int count;
 	BYTE *dest;
 	fixed_t frac;
@@ -741,6 +789,9 @@ void R_DrawAddClampColumnP_C ()
 // Add translated source to destination, clamping it to white
 void R_DrawAddClampTranslatedColumnP_C ()
 {
+	if (DrawerQueue.IsRecording ())
+		return DrawerQueue.QueueColumn (R_DrawAddClampTranslatedColumnP_C);
+
 	int count;
 	BYTE *dest;
 	fixed_t frac;
@@ -783,6 +834,9 @@ void R_DrawAddClampTranslatedColumnP_C ()
 // Subtract destination from source, clamping it to black
 void R_DrawSubClampColumnP_C ()
 {
+	if (DrawerQueue.IsRecording ())
+		return DrawerQueue.QueueColumn (R_DrawSubClampColumnP_C);
+
 	int count;
 	BYTE *dest;
 	fixed_t frac;
@@ -823,6 +877,9 @@ void R_DrawSubClampColumnP_C ()
 // Subtract destination from source, clamping it to black
 void R_DrawSubClampTranslatedColumnP_C ()
 {
+	if (DrawerQueue.IsRecording ())
+		return DrawerQueue.QueueColumn (R_DrawSubClampTranslatedColumnP_C);
+
 	int count;
 	BYTE *dest;
 	fixed_t frac;
@@ -864,6 +921,9 @@ void R_DrawSubClampTranslatedColumnP_C ()
 // Subtract source from destination, clamping it to black
 void R_DrawRevSubClampColumnP_C ()
 {
+	if (DrawerQueue.IsRecording ())
+		return DrawerQueue.QueueColumn (R_DrawRevSubClampColumnP_C);
+
 	int count;
 	BYTE *dest;
 	fixed_t frac;
@@ -904,6 +964,9 @@ void R_DrawRevSubClampColumnP_C ()
 // Subtract source from destination, clamping it to black
 void R_DrawRevSubClampTranslatedColumnP_C ()
 {
+	if (DrawerQueue.IsRecording ())
+		return DrawerQueue.QueueColumn (R_DrawRevSubClampTranslatedColumnP_C);
+
 	int count;
 	BYTE *dest;
 	fixed_t frac;
@@ -965,23 +1028,23 @@ void R_DrawRevSubClampTranslatedColumnP_C ()
 // swapped.
 //
 extern "C" {
-int						ds_color;				// [RH] color for non-textured spans
+DRAWER_TLS int						ds_color;				// [RH] color for non-textured spans
 
-int 					ds_y;
-int 					ds_x1;
-int 					ds_x2;
+DRAWER_TLS int 					ds_y;
+DRAWER_TLS int 					ds_x1;
+DRAWER_TLS int 					ds_x2;
 
-lighttable_t*			ds_colormap;
+DRAWER_TLS lighttable_t*			ds_colormap;
 
-dsfixed_t 				ds_xfrac;
-dsfixed_t 				ds_yfrac;
-dsfixed_t 				ds_xstep;
-dsfixed_t 				ds_ystep;
-int						ds_xbits;
-int						ds_ybits;
+DRAWER_TLS dsfixed_t 				ds_xfrac;
+DRAWER_TLS dsfixed_t 				ds_yfrac;
+DRAWER_TLS dsfixed_t 				ds_xstep;
+DRAWER_TLS dsfixed_t 				ds_ystep;
+DRAWER_TLS int						ds_xbits;
+DRAWER_TLS int						ds_ybits;
 
 // start of a floor/ceiling tile image 
-const BYTE*				ds_source;
+DRAWER_TLS const BYTE*				ds_source;
 
 // just for profiling
 int 					dscount;
@@ -1063,6 +1126,9 @@ void R_SetupSpanBits(FTexture *tex)
 #ifndef X86_ASM
 void R_DrawSpanP_C (void)
 {
+	if (DrawerQueue.IsRecording ())
+		return DrawerQueue.QueueSpan (R_DrawSpanP_C);
+
 	dsfixed_t			xfrac;
 	dsfixed_t			yfrac;
 	dsfixed_t			xstep;
@@ -1134,6 +1200,9 @@ void R_DrawSpanP_C (void)
 // [RH] Draw a span with holes
 void R_DrawSpanMaskedP_C (void)
 {
+	if (DrawerQueue.IsRecording ())
+		return DrawerQueue.QueueSpan (R_DrawSpanMaskedP_C);
+
 	dsfixed_t			xfrac;
 	dsfixed_t			yfrac;
 	dsfixed_t			xstep;
@@ -1197,6 +1266,9 @@ void R_DrawSpanMaskedP_C (void)
 
 void R_DrawSpanTranslucentP_C (void)
 {
+	if (DrawerQueue.IsRecording ())
+		return DrawerQueue.QueueSpan (R_DrawSpanTranslucentP_C);
+
 	dsfixed_t			xfrac;
 	dsfixed_t			yfrac;
 	dsfixed_t			xstep;
@@ -1257,6 +1329,9 @@ void R_DrawSpanTranslucentP_C (void)
 
 void R_DrawSpanMaskedTranslucentP_C (void)
 {
+	if (DrawerQueue.IsRecording ())
+		return DrawerQueue.QueueSpan (R_DrawSpanMaskedTranslucentP_C);
+
 	dsfixed_t			xfrac;
 	dsfixed_t			yfrac;
 	dsfixed_t			xstep;
@@ -1331,6 +1406,9 @@ void R_DrawSpanMaskedTranslucentP_C (void)
 
 void R_DrawSpanAddClampP_C (void)
 {
+	if (DrawerQueue.IsRecording ())
+		return DrawerQueue.QueueSpan (R_DrawSpanAddClampP_C);
+
 	dsfixed_t			xfrac;
 	dsfixed_t			yfrac;
 	dsfixed_t			xstep;
@@ -1397,6 +1475,9 @@ void R_DrawSpanAddClampP_C (void)
 
 void R_DrawSpanMaskedAddClampP_C (void)
 {
+	if (DrawerQueue.IsRecording ())
+		return DrawerQueue.QueueSpan (R_DrawSpanMaskedAddClampP_C);
+
 	dsfixed_t			xfrac;
 	dsfixed_t			yfrac;
 	dsfixed_t			xstep;
@@ -1478,6 +1559,9 @@ void R_DrawSpanMaskedAddClampP_C (void)
 // [RH] Just fill a span with a color
 void R_FillSpan (void)
 {
+	if (DrawerQueue.IsRecording ())
+		return DrawerQueue.QueueSpan (R_FillSpan);
+
 	memset (ylookup[ds_y] + ds_x1 + dc_destorg, ds_color, ds_x2 - ds_x1 + 1);
 }
 
@@ -1490,7 +1574,7 @@ void R_FillSpan (void)
 // Actually, this is just R_DrawColumn with an extra width parameter.
 
 #ifndef X86_ASM
-static const BYTE *slabcolormap;
+static DRAWER_TLS const BYTE *slabcolormap;
 
 extern "C" void R_SetupDrawSlabC(const BYTE *colormap)
 {
@@ -1499,6 +1583,9 @@ extern "C" void R_SetupDrawSlabC(const BYTE *colormap)
 
 extern "C" void STACK_ARGS R_DrawSlabC(int dx, fixed_t v, int dy, fixed_t vi, const BYTE *vptr, BYTE *p)
 {
+	if (DrawerQueue.IsRecording ())
+		return DrawerQueue.QueueSlab (R_DrawSlabC, dx, v, dy, vi, vptr, p);
+
 	int x;
 	const BYTE *colormap = slabcolormap;
 	int pitch = dc_pitch;
@@ -1579,7 +1666,7 @@ extern "C" void STACK_ARGS R_DrawSlabC(int dx, fixed_t v, int dy, fixed_t vi, co
 
 #ifndef X86_ASM
 static DWORD STACK_ARGS vlinec1 ();
-static int vlinebits;
+static DRAWER_TLS int vlinebits;
 
 DWORD (STACK_ARGS *dovline1)() = vlinec1;
 DWORD (STACK_ARGS *doprevline1)() = vlinec1;
@@ -1595,7 +1682,7 @@ void (STACK_ARGS *dovline4)() = vlinec4;
 
 static DWORD STACK_ARGS mvlinec1();
 static void STACK_ARGS mvlinec4();
-static int mvlinebits;
+static DRAWER_TLS int mvlinebits;
 
 DWORD (STACK_ARGS *domvline1)() = mvlinec1;
 void (STACK_ARGS *domvline4)() = mvlinec4;
@@ -1666,6 +1753,9 @@ void setupvline (int fracbits)
 #if !defined(X86_ASM)
 DWORD STACK_ARGS vlinec1 ()
 {
+	if (DrawerQueue.IsRecording ())
+		return DrawerQueue.QueueLine1 (vlinec1);
+
 	DWORD fracstep = dc_iscale;
 	DWORD frac = dc_texturefrac;
 	BYTE *colormap = dc_colormap;
@@ -1687,6 +1777,9 @@ DWORD STACK_ARGS vlinec1 ()
 
 void STACK_ARGS vlinec4 ()
 {
+	if (DrawerQueue.IsRecording ())
+		return DrawerQueue.QueueLine4 (vlinec4);
+
 	BYTE *dest = dc_dest;
 	int count = dc_count;
 	int bits = vlinebits;
@@ -1717,6 +1810,9 @@ void setupmvline (int fracbits)
 #if !defined(X86_ASM)
 DWORD STACK_ARGS mvlinec1 ()
 {
+	if (DrawerQueue.IsRecording ())
+		return DrawerQueue.QueueLine1 (mvlinec1);
+
 	DWORD fracstep = dc_iscale;
 	DWORD frac = dc_texturefrac;
 	BYTE *colormap = dc_colormap;
@@ -1742,6 +1838,9 @@ DWORD STACK_ARGS mvlinec1 ()
 
 void STACK_ARGS mvlinec4 ()
 {
+	if (DrawerQueue.IsRecording ())
+		return DrawerQueue.QueueLine4 (mvlinec4);
+
 	BYTE *dest = dc_dest;
 	int count = dc_count;
 	int bits = mvlinebits;
@@ -1795,6 +1894,10 @@ static void R_DrawFogBoundaryLine (int y, int x)
 
 void R_DrawFogBoundary (int x1, int x2, short *uclip, short *dclip)
 {
+	// [ZA] The fog spans are drawn with a different colormap every few
+	// rows, so let everything queued so far reach the screen first.
+	DrawerQueue.Flush ();
+
 	// This is essentially the same as R_MapVisPlane but with an extra step
 	// to create new horizontal spans whenever the light changes enough that
 	// we need to use a new colormap.
@@ -1882,15 +1985,129 @@ void R_DrawFogBoundary (int x1, int x2, short *uclip, short *dclip)
 	}
 }
 
-int tmvlinebits;
+static DRAWER_TLS int tmvlinebits;
 
 void setuptmvline (int bits)
 {
 	tmvlinebits = bits;
 }
 
+//==========================================================================
+//
+// FDrawerState :: Save
+//
+// [ZA] Copies everything the drawers read from globals, so a queued
+// command can be replayed later on another thread.
+//
+//==========================================================================
+
+void FDrawerState::Save ()
+{
+	DestOrg = dc_destorg;
+	Dest = dc_dest;
+	Source = dc_source;
+	Colormap = dc_colormap;
+	Translation = dc_translation;
+	SrcBlend = dc_srcblend;
+	DestBlend = dc_destblend;
+	Temp = dc_temp;
+	Pitch = dc_pitch;
+	X = dc_x;
+	YL = dc_yl;
+	YH = dc_yh;
+	Count = dc_count;
+	IScale = dc_iscale;
+	TextureMid = dc_texturemid;
+	TextureFrac = dc_texturefrac;
+	Color = dc_color;
+	SrcColor = dc_srccolor;
+
+	memcpy (VPlce, vplce, sizeof(VPlce));
+	memcpy (VInce, vince, sizeof(VInce));
+	memcpy (PalookupOffse, palookupoffse, sizeof(PalookupOffse));
+	memcpy (BufPlce, bufplce, sizeof(BufPlce));
+
+	SpanSource = ds_source;
+	SpanColormap = ds_colormap;
+	SpanColor = ds_color;
+	SpanY = ds_y;
+	SpanX1 = ds_x1;
+	SpanX2 = ds_x2;
+	SpanXFrac = ds_xfrac;
+	SpanYFrac = ds_yfrac;
+	SpanXStep = ds_xstep;
+	SpanYStep = ds_ystep;
+	SpanXBits = ds_xbits;
+	SpanYBits = ds_ybits;
+
+#ifndef X86_ASM
+	SlabColormap = slabcolormap;
+	VLineBits = vlinebits;
+	MVLineBits = mvlinebits;
+#endif
+	TMVLineBits = tmvlinebits;
+	FuzzPos = fuzzpos;
+}
+
+//==========================================================================
+//
+// FDrawerState :: Restore
+//
+//==========================================================================
+
+void FDrawerState::Restore () const
+{
+	dc_destorg = DestOrg;
+	dc_dest = Dest;
+	dc_source = Source;
+	dc_colormap = Colormap;
+	dc_translation = Translation;
+	dc_srcblend = SrcBlend;
+	dc_destblend = DestBlend;
+	dc_temp = Temp;
+	dc_pitch = Pitch;
+	dc_x = X;
+	dc_yl = YL;
+	dc_yh = YH;
+	dc_count = Count;
+	dc_iscale = IScale;
+	dc_texturemid = TextureMid;
+	dc_texturefrac = TextureFrac;
+	dc_color = Color;
+	dc_srccolor = SrcColor;
+
+	memcpy (vplce, VPlce, sizeof(VPlce));
+	memcpy (vince, VInce, sizeof(VInce));
+	memcpy (palookupoffse, PalookupOffse, sizeof(PalookupOffse));
+	memcpy (bufplce, BufPlce, sizeof(BufPlce));
+
+	ds_source = SpanSource;
+	ds_colormap = SpanColormap;
+	ds_color = SpanColor;
+	ds_y = SpanY;
+	ds_x1 = SpanX1;
+	ds_x2 = SpanX2;
+	ds_xfrac = SpanXFrac;
+	ds_yfrac = SpanYFrac;
+	ds_xstep = SpanXStep;
+	ds_ystep = SpanYStep;
+	ds_xbits = SpanXBits;
+	ds_ybits = SpanYBits;
+
+#ifndef X86_ASM
+	slabcolormap = SlabColormap;
+	vlinebits = VLineBits;
+	mvlinebits = MVLineBits;
+#endif
+	tmvlinebits = TMVLineBits;
+	fuzzpos = FuzzPos;
+}
+
 fixed_t tmvline1_add ()
 {
+	if (DrawerQueue.IsRecording ())
+		return DrawerQueue.QueueLine1 (tmvline1_add);
+
 	DWORD fracstep = dc_iscale;
 	DWORD frac = dc_texturefrac;
 	BYTE *colormap = dc_colormap;
@@ -1922,6 +2139,9 @@ fixed_t tmvline1_add ()
 
 void tmvline4_add ()
 {
+	if (DrawerQueue.IsRecording ())
+		return DrawerQueue.QueueLine4 (tmvline4_add);
+
 	BYTE *dest = dc_dest;
 	int count = dc_count;
 	int bits = tmvlinebits;
@@ -1949,6 +2169,9 @@ void tmvline4_add ()
 
 fixed_t tmvline1_addclamp ()
 {
+	if (DrawerQueue.IsRecording ())
+		return DrawerQueue.QueueLine1 (tmvline1_addclamp);
+
 	DWORD fracstep = dc_iscale;
 	DWORD frac = dc_texturefrac;
 	BYTE *colormap = dc_colormap;
@@ -1985,6 +2208,9 @@ fixed_t tmvline1_addclamp ()
 
 void tmvline4_addclamp ()
 {
+	if (DrawerQueue.IsRecording ())
+		return DrawerQueue.QueueLine4 (tmvline4_addclamp);
+
 	BYTE *dest = dc_dest;
 	int count = dc_count;
 	int bits = tmvlinebits;
@@ -2017,6 +2243,9 @@ void tmvline4_addclamp ()
 
 fixed_t tmvline1_subclamp ()
 {
+	if (DrawerQueue.IsRecording ())
+		return DrawerQueue.QueueLine1 (tmvline1_subclamp);
+
 	DWORD fracstep = dc_iscale;
 	DWORD frac = dc_texturefrac;
 	BYTE *colormap = dc_colormap;
@@ -2052,6 +2281,9 @@ fixed_t tmvline1_subclamp ()
 
 void tmvline4_subclamp ()
 {
+	if (DrawerQueue.IsRecording ())
+		return DrawerQueue.QueueLine4 (tmvline4_subclamp);
+
 	BYTE *dest = dc_dest;
 	int count = dc_count;
 	int bits = tmvlinebits;
@@ -2083,6 +2315,9 @@ void tmvline4_subclamp ()
 
 fixed_t tmvline1_revsubclamp ()
 {
+	if (DrawerQueue.IsRecording ())
+		return DrawerQueue.QueueLine1 (tmvline1_revsubclamp);
+
 	DWORD fracstep = dc_iscale;
 	DWORD frac = dc_texturefrac;
 	BYTE *colormap = dc_colormap;
@@ -2118,6 +2353,9 @@ fixed_t tmvline1_revsubclamp ()
 
 void tmvline4_revsubclamp ()
 {
+	if (DrawerQueue.IsRecording ())
+		return DrawerQueue.QueueLine4 (tmvline4_revsubclamp);
+
 	BYTE *dest = dc_dest;
 	int count = dc_count;
 	int bits = tmvlinebits;
@@ -2196,11 +2434,38 @@ void R_InitColumnDrawers ()
 	R_DrawSpan					= R_DrawSpanP_C;
 	R_DrawSpanMasked			= R_DrawSpanMaskedP_C;
 	rt_map4cols					= rt_map4cols_c;
+	rt_shaded4cols				= rt_shaded4cols_c;
+	rt_add4cols					= rt_add4cols_c;
+	rt_addclamp4cols			= rt_addclamp4cols_c;
+	rt_subclamp4cols			= rt_subclamp4cols_c;
+	rt_revsubclamp4cols			= rt_revsubclamp4cols_c;
 #endif
 	R_DrawSpanTranslucent		= R_DrawSpanTranslucentP_C;
 	R_DrawSpanMaskedTranslucent = R_DrawSpanMaskedTranslucentP_C;
 	R_DrawSpanAddClamp			= R_DrawSpanAddClampP_C;
 	R_DrawSpanMaskedAddClamp	= R_DrawSpanMaskedAddClampP_C;
+
+#ifdef R_DRAWER_SIMD
+	// [ZA] Every x86-64 CPU has SSE2.
+	if (CPU.bAVX2)
+	{
+		rt_shaded4cols			= rt_shaded4cols_avx2;
+		rt_add4cols				= rt_add4cols_avx2;
+		rt_addclamp4cols		= rt_addclamp4cols_avx2;
+		rt_subclamp4cols		= rt_subclamp4cols_avx2;
+		rt_revsubclamp4cols		= rt_revsubclamp4cols_avx2;
+	}
+	else
+	{
+		rt_shaded4cols			= rt_shaded4cols_sse2;
+		rt_add4cols				= rt_add4cols_sse2;
+		rt_addclamp4cols		= rt_addclamp4cols_sse2;
+		rt_subclamp4cols		= rt_subclamp4cols_sse2;
+		rt_revsubclamp4cols		= rt_revsubclamp4cols_sse2;
+	}
+	R_DrawSpanTranslucent		= R_DrawSpanTranslucentP_SSE2;
+	R_DrawSpanAddClamp			= R_DrawSpanAddClampP_SSE2;
+#endif
 }
 
 // [RH] Choose column drawers in a single place
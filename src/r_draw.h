@@ -23,37 +23,48 @@
 #ifndef __R_DRAW__
 #define __R_DRAW__
 
+#include "doomtype.h"
 #include "r_defs.h"
 
+// [ZA] The C drawers keep their state in thread-local variables, so that the
+// drawer threads (see r_thread.h) can each run the same drawer calls. The
+// assembly drawers need real globals, so there is only one set with them.
+#if !defined(X86_ASM) && !defined(X64_ASM)
+#define R_DRAWER_THREADS
+#define DRAWER_TLS thread_local
+#else
+#define DRAWER_TLS
+#endif
+
 extern "C" int			ylookup[MAXHEIGHT];
 
-extern "C" int			dc_pitch;		// [RH] Distance between rows
+extern "C" DRAWER_TLS int			dc_pitch;		// [RH] Distance between rows
 
-extern "C" lighttable_t*dc_colormap;
-extern "C" int			dc_x;
-extern "C" int			dc_yl;
-extern "C" int			dc_yh;
-extern "C" fixed_t		dc_iscale;
-extern "C" fixed_t		dc_texturemid;
-extern "C" fixed_t		dc_texturefrac;
-extern "C" int			dc_color;		// [RH] For flat colors (no texturing)
-extern "C" DWORD		dc_srccolor;
-extern "C" DWORD		*dc_srcblend;
-extern "C" DWORD		*dc_destblend;
+extern "C" DRAWER_TLS lighttable_t*dc_colormap;
+extern "C" DRAWER_TLS int			dc_x;
+extern "C" DRAWER_TLS int			dc_yl;
+extern "C" DRAWER_TLS int			dc_yh;
+extern "C" DRAWER_TLS fixed_t		dc_iscale;
+extern "C" DRAWER_TLS fixed_t		dc_texturemid;
+extern "C" DRAWER_TLS fixed_t		dc_texturefrac;
+extern "C" DRAWER_TLS int			dc_color;		// [RH] For flat colors (no texturing)
+extern "C" DRAWER_TLS DWORD		dc_srccolor;
+extern "C" DRAWER_TLS DWORD		*dc_srcblend;
+extern "C" DRAWER_TLS DWORD		*dc_destblend;
 
 // first pixel in a column
-extern "C" const BYTE*	dc_source;
+extern "C" DRAWER_TLS const BYTE*	dc_source;
 
-extern "C" BYTE			*dc_dest, *dc_destorg;
-extern "C" int			dc_count;
+extern "C" DRAWER_TLS BYTE			*dc_dest, *dc_destorg;
+extern "C" DRAWER_TLS int			dc_count;
 
-extern "C" DWORD		vplce[4];
-extern "C" DWORD		vince[4];
-extern "C" BYTE*		palookupoffse[4];
-extern "C" const BYTE*	bufplce[4];
+extern "C" DRAWER_TLS DWORD		vplce[4];
+extern "C" DRAWER_TLS DWORD		vince[4];
+extern "C" DRAWER_TLS BYTE*		palookupoffse[4];
+extern "C" DRAWER_TLS const BYTE*	bufplce[4];
 
 // [RH] Temporary buffer for column drawing
-extern "C" BYTE			*dc_temp;
+extern "C" DRAWER_TLS BYTE			*dc_temp;
 extern "C" unsigned int	dc_tspans[4][MAXHEIGHT];
 extern "C" unsigned int	*dc_ctspan[4];
 extern "C" unsigned int	horizspans[4];
@@ -144,8 +155,8 @@ void rt_tlaterevsubclamp1col (int hx, int sx, int yl, int yh);
 void STACK_ARGS rt_map4cols_c (int sx, int yl, int yh);
 void STACK_ARGS rt_add4cols_c (int sx, int yl, int yh);
 void STACK_ARGS rt_addclamp4cols_c (int sx, int yl, int yh);
-void STACK_ARGS rt_subclamp4cols (int sx, int yl, int yh);
-void STACK_ARGS rt_revsubclamp4cols (int sx, int yl, int yh);
+void STACK_ARGS rt_subclamp4cols_c (int sx, int yl, int yh);
+void STACK_ARGS rt_revsubclamp4cols_c (int sx, int yl, int yh);
 
 void STACK_ARGS rt_tlate4cols (int sx, int yl, int yh);
 void STACK_ARGS rt_tlateadd4cols (int sx, int yl, int yh);
@@ -172,13 +183,39 @@ extern void (STACK_ARGS *rt_map4cols)(int sx, int yl, int yh);
 #define rt_shaded4cols		rt_shaded4cols_asm
 #define rt_add4cols			rt_add4cols_asm
 #define rt_addclamp4cols	rt_addclamp4cols_asm
+#define rt_subclamp4cols	rt_subclamp4cols_c
+#define rt_revsubclamp4cols	rt_revsubclamp4cols_c
 #else
 #define rt_copy1col			rt_copy1col_c
 #define rt_copy4cols		rt_copy4cols_c
 #define rt_map1col			rt_map1col_c
-#define rt_shaded4cols		rt_shaded4cols_c
-#define rt_add4cols			rt_add4cols_c
-#define rt_addclamp4cols	rt_addclamp4cols_c
+
+// [ZA] These have SIMD versions, so R_InitColumnDrawers picks one to fit the CPU.
+extern void (STACK_ARGS *rt_shaded4cols)(int sx, int yl, int yh);
+extern void (STACK_ARGS *rt_add4cols)(int sx, int yl, int yh);
+extern void (STACK_ARGS *rt_addclamp4cols)(int sx, int yl, int yh);
+extern void (STACK_ARGS *rt_subclamp4cols)(int sx, int yl, int yh);
+extern void (STACK_ARGS *rt_revsubclamp4cols)(int sx, int yl, int yh);
+#endif
+
+// [ZA] SIMD drawers for x86-64, from r_drawt_simd.cpp.
+#if !defined(X86_ASM) && (defined(__amd64__) || defined(_M_X64))
+#define R_DRAWER_SIMD
+
+void STACK_ARGS rt_shaded4cols_sse2 (int sx, int yl, int yh);
+void STACK_ARGS rt_add4cols_sse2 (int sx, int yl, int yh);
+void STACK_ARGS rt_addclamp4cols_sse2 (int sx, int yl, int yh);
+void STACK_ARGS rt_subclamp4cols_sse2 (int sx, int yl, int yh);
+void STACK_ARGS rt_revsubclamp4cols_sse2 (int sx, int yl, int yh);
+
+void STACK_ARGS rt_shaded4cols_avx2 (int sx, int yl, int yh);
+void STACK_ARGS rt_add4cols_avx2 (int sx, int yl, int yh);
+void STACK_ARGS rt_addclamp4cols_avx2 (int sx, int yl, int yh);
+void STACK_ARGS rt_subclamp4cols_avx2 (int sx, int yl, int yh);
+void STACK_ARGS rt_revsubclamp4cols_avx2 (int sx, int yl, int yh);
+
+void R_DrawSpanTranslucentP_SSE2 (void);
+void R_DrawSpanAddClampP_SSE2 (void);
 #endif
 
 void rt_draw4cols (int sx);
@@ -214,11 +251,13 @@ void	R_DrawSpanMaskedP_C (void);
 
 void	R_DrawSpanTranslucentP_C (void);
 void	R_DrawSpanMaskedTranslucentP_C (void);
+void	R_DrawSpanAddClampP_C (void);	// [ZA]
 
 void	R_DrawTlatedLucentColumnP_C (void);
 #define R_DrawTlatedLucentColumn R_DrawTlatedLucentColumnP_C
 
 void	R_FillColumnP (void);
+void	R_FillAddColumn (void);	// [ZA]
 void	R_FillColumnHorizP (void);
 void	R_FillSpan (void);
 
@@ -233,32 +272,34 @@ void	R_FillSpan (void);
 extern "C" void			   R_SetupDrawSlab(const BYTE *colormap);
 extern "C" void STACK_ARGS R_DrawSlab(int dx, fixed_t v, int dy, fixed_t vi, const BYTE *vptr, BYTE *p);
 
-extern "C" int				ds_y;
-extern "C" int				ds_x1;
-extern "C" int				ds_x2;
+extern "C" DRAWER_TLS int				ds_y;
+extern "C" DRAWER_TLS int				ds_x1;
+extern "C" DRAWER_TLS int				ds_x2;
 
-extern "C" lighttable_t*	ds_colormap;
+extern "C" DRAWER_TLS lighttable_t*	ds_colormap;
 
-extern "C" dsfixed_t		ds_xfrac;
-extern "C" dsfixed_t		ds_yfrac;
-extern "C" dsfixed_t		ds_xstep;
-extern "C" dsfixed_t		ds_ystep;
-extern "C" int				ds_xbits;
-extern "C" int				ds_ybits;
+extern "C" DRAWER_TLS dsfixed_t		ds_xfrac;
+extern "C" DRAWER_TLS dsfixed_t		ds_yfrac;
+extern "C" DRAWER_TLS dsfixed_t		ds_xstep;
+extern "C" DRAWER_TLS dsfixed_t		ds_ystep;
+extern "C" DRAWER_TLS int				ds_xbits;
+extern "C" DRAWER_TLS int				ds_ybits;
 extern "C" fixed_t			ds_alpha;
 
 // start of a 64*64 tile image
-extern "C" const BYTE*		ds_source;
+extern "C" DRAWER_TLS const BYTE*		ds_source;
 
-extern "C" int				ds_color;		// [RH] For flat color (no texturing)
+extern "C" DRAWER_TLS int				ds_color;		// [RH] For flat color (no texturing)
 
 extern BYTE shadetables[/*NUMCOLORMAPS*16*256*/];
 extern FDynamicColormap ShadeFakeColormap[16];
 extern BYTE identitymap[256];
-extern BYTE *dc_translation;
+extern DRAWER_TLS BYTE *dc_translation;
 
 // [RH] Added for muliresolution support
 void R_InitShadeMaps();
+#define FUZZTABLE	50
+extern "C" DRAWER_TLS int fuzzpos;
 void R_InitFuzzTable (int fuzzoff);
 
 // [RH] Consolidate column drawer selection
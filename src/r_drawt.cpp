@@ -46,6 +46,8 @@
 #include "r_main.h"
 #include "r_things.h"
 #include "v_video.h"
+// [ZA] New #includes.
+#include "r_thread.h"
 
 // I should have commented this stuff better.
 //
@@ -58,7 +60,7 @@
 // horizspan is advanced up to dc_ctspan when drawing from dc_temp to the screen.
 
 BYTE dc_tempbuff[MAXHEIGHT*4];
-BYTE *dc_temp;
+DRAWER_TLS BYTE *dc_temp;
 unsigned int dc_tspans[4][MAXHEIGHT];
 unsigned int *dc_ctspan[4];
 unsigned int *horizspan[4];
@@ -73,6 +75,9 @@ extern "C" void R_SetupAddClampCol();
 // Copies one span at hx to the screen at sx.
 void rt_copy1col_c (int hx, int sx, int yl, int yh)
 {
+	if (DrawerQueue.IsRecording ())
+		return DrawerQueue.QueuePost1 (rt_copy1col_c, hx, sx, yl, yh);
+
 	BYTE *source;
 	BYTE *dest;
 	int count;
@@ -114,6 +119,9 @@ void rt_copy1col_c (int hx, int sx, int yl, int yh)
 // Copies all four spans to the screen starting at sx.
 void STACK_ARGS rt_copy4cols_c (int sx, int yl, int yh)
 {
+	if (DrawerQueue.IsRecording ())
+		return DrawerQueue.QueuePost4 (rt_copy4cols_c, sx, yl, yh);
+
 	int *source;
 	int *dest;
 	int count;
@@ -147,6 +155,9 @@ void STACK_ARGS rt_copy4cols_c (int sx, int yl, int yh)
 // Maps one span at hx to the screen at sx.
 void rt_map1col_c (int hx, int sx, int yl, int yh)
 {
+	if (DrawerQueue.IsRecording ())
+		return DrawerQueue.QueuePost1 (rt_map1col_c, hx, sx, yl, yh);
+
 	BYTE *colormap;
 	BYTE *source;
 	BYTE *dest;
@@ -182,6 +193,9 @@ void rt_map1col_c (int hx, int sx, int yl, int yh)
 // Maps all four spans to the screen starting at sx.
 void STACK_ARGS rt_map4cols_c (int sx, int yl, int yh)
 {
+	if (DrawerQueue.IsRecording ())
+		return DrawerQueue.QueuePost4 (rt_map4cols_c, sx, yl, yh);
+
 	BYTE *colormap;
 	BYTE *source;
 	BYTE *dest;
@@ -315,6 +329,9 @@ void rt_Translate4cols(const BYTE *translation, int yl, int yh)
 // Translates one span at hx to the screen at sx.
 void rt_tlate1col (int hx, int sx, int yl, int yh)
 {
+	if (DrawerQueue.IsRecording ())
+		return DrawerQueue.QueuePost1 (rt_tlate1col, hx, sx, yl, yh);
+
 	rt_Translate1col(dc_translation, hx, yl, yh);
 	rt_map1col(hx, sx, yl, yh);
 }
@@ -322,6 +339,9 @@ void rt_tlate1col (int hx, int sx, int yl, int yh)
 // Translates all four spans to the screen starting at sx.
 void STACK_ARGS rt_tlate4cols (int sx, int yl, int yh)
 {
+	if (DrawerQueue.IsRecording ())
+		return DrawerQueue.QueuePost4 (rt_tlate4cols, sx, yl, yh);
+
 	rt_Translate4cols(dc_translation, yl, yh);
 	rt_map4cols(sx, yl, yh);
 }
@@ -329,6 +349,9 @@ void STACK_ARGS rt_tlate4cols (int sx, int yl, int yh)
 // Adds one span at hx to the screen at sx without clamping.
 void rt_add1col (int hx, int sx, int yl, int yh)
 {
+	if (DrawerQueue.IsRecording ())
+		return DrawerQueue.QueuePost1 (rt_add1col, hx, sx, yl, yh);
+
 	BYTE *colormap;
 	BYTE *source;
 	BYTE *dest;
@@ -363,6 +386,9 @@ void rt_add1col (int hx, int sx, int yl, int yh)
 // Adds all four spans to the screen starting at sx without clamping.
 void STACK_ARGS rt_add4cols_c (int sx, int yl, int yh)
 {
+	if (DrawerQueue.IsRecording ())
+		return DrawerQueue.QueuePost4 (rt_add4cols_c, sx, yl, yh);
+
 	BYTE *colormap;
 	BYTE *source;
 	BYTE *dest;
@@ -419,6 +445,9 @@ void STACK_ARGS rt_add4cols_c (int sx, int yl, int yh)
 // Translates and adds one span at hx to the screen at sx without clamping.
 void rt_tlateadd1col (int hx, int sx, int yl, int yh)
 {
+	if (DrawerQueue.IsRecording ())
+		return DrawerQueue.QueuePost1 (rt_tlateadd1col, hx, sx, yl, yh);
+
 	rt_Translate1col(dc_translation, hx, yl, yh);
 	rt_add1col(hx, sx, yl, yh);
 }
@@ -426,6 +455,9 @@ void rt_tlateadd1col (int hx, int sx, int yl, int yh)
 // Translates and adds all four spans to the screen starting at sx without clamping.
 void STACK_ARGS rt_tlateadd4cols (int sx, int yl, int yh)
 {
+	if (DrawerQueue.IsRecording ())
+		return DrawerQueue.QueuePost4 (rt_tlateadd4cols, sx, yl, yh);
+
 	rt_Translate4cols(dc_translation, yl, yh);
 	rt_add4cols(sx, yl, yh);
 }
@@ -433,6 +465,9 @@ void STACK_ARGS rt_tlateadd4cols (int sx, int yl, int yh)
 // Shades one span at hx to the screen at sx.
 void rt_shaded1col (int hx, int sx, int yl, int yh)
 {
+	if (DrawerQueue.IsRecording ())
+		return DrawerQueue.QueuePost1 (rt_shaded1col, hx, sx, yl, yh);
+
 	DWORD *fgstart;
 	BYTE *colormap;
 	BYTE *source;
@@ -464,6 +499,9 @@ void rt_shaded1col (int hx, int sx, int yl, int yh)
 // Shades all four spans to the screen starting at sx.
 void STACK_ARGS rt_shaded4cols_c (int sx, int yl, int yh)
 {
+	if (DrawerQueue.IsRecording ())
+		return DrawerQueue.QueuePost4 (rt_shaded4cols_c, sx, yl, yh);
+
 	DWORD *fgstart;
 	BYTE *colormap;
 	BYTE *source;
@@ -509,6 +547,9 @@ void STACK_ARGS rt_shaded4cols_c (int sx, int yl, int yh)
 // Adds one span at hx to the screen at sx with clamping.
 void rt_addclamp1col (int hx, int sx, int yl, int yh)
 {
+	if (DrawerQueue.IsRecording ())
+		return DrawerQueue.QueuePost1 (rt_addclamp1col, hx, sx, yl, yh);
+
 	BYTE *colormap;
 	BYTE *source;
 	BYTE *dest;
@@ -545,6 +586,9 @@ void rt_addclamp1col (int hx, int sx, int yl, int yh)
 // Adds all four spans to the screen starting at sx with clamping.
 void STACK_ARGS rt_addclamp4cols_c (int sx, int yl, int yh)
 {
+	if (DrawerQueue.IsRecording ())
+		return DrawerQueue.QueuePost4 (rt_addclamp4cols_c, sx, yl, yh);
+
 	BYTE *colormap;
 	BYTE *source;
 	BYTE *dest;
@@ -609,6 +653,9 @@ void STACK_ARGS rt_addclamp4cols_c (int sx, int yl, int yh)
 // Translates and adds one span at hx to the screen at sx with clamping.
 void rt_tlateaddclamp1col (int hx, int sx, int yl, int yh)
 {
+	if (DrawerQueue.IsRecording ())
+		return DrawerQueue.QueuePost1 (rt_tlateaddclamp1col, hx, sx, yl, yh);
+
 	rt_Translate1col(dc_translation, hx, yl, yh);
 	rt_addclamp1col(hx, sx, yl, yh);
 }
@@ -616,6 +663,9 @@ void rt_tlateaddclamp1col (int hx, int sx, int yl, int yh)
 // Translates and adds all four spans to the screen starting at sx with clamping.
 void STACK_ARGS rt_tlateaddclamp4cols (int sx, int yl, int yh)
 {
+	if (DrawerQueue.IsRecording ())
+		return DrawerQueue.QueuePost4 (rt_tlateaddclamp4cols, sx, yl, yh);
+
 	rt_Translate4cols(dc_translation, yl, yh);
 	rt_addclamp4cols(sx, yl, yh);
 }
@@ -623,6 +673,9 @@ void STACK_ARGS rt_tlateaddclamp4cols (int sx, int yl, int yh)
 // Subtracts one span at hx to the screen at sx with clamping.
 void rt_subclamp1col (int hx, int sx, int yl, int yh)
 {
+	if (DrawerQueue.IsRecording ())
+		return DrawerQueue.QueuePost1 (rt_subclamp1col, hx, sx, yl, yh);
+
 	BYTE *colormap;
 	BYTE *source;
 	BYTE *dest;
@@ -656,8 +709,11 @@ void rt_subclamp1col (int hx, int sx, int yl, int yh)
 }
 
 // Subtracts all four spans to the screen starting at sx with clamping.
-void STACK_ARGS rt_subclamp4cols (int sx, int yl, int yh)
+void STACK_ARGS rt_subclamp4cols_c (int sx, int yl, int yh)
 {
+	if (DrawerQueue.IsRecording ())
+		return DrawerQueue.QueuePost4 (rt_subclamp4cols_c, sx, yl, yh);
+
 	BYTE *colormap;
 	BYTE *source;
 	BYTE *dest;
@@ -718,6 +774,9 @@ void STACK_ARGS rt_subclamp4cols (int sx, int yl, int yh)
 // Translates and subtracts one span at hx to the screen at sx with clamping.
 void rt_tlatesubclamp1col (int hx, int sx, int yl, int yh)
 {
+	if (DrawerQueue.IsRecording ())
+		return DrawerQueue.QueuePost1 (rt_tlatesubclamp1col, hx, sx, yl, yh);
+
 	rt_Translate1col(dc_translation, hx, yl, yh);
 	rt_subclamp1col(hx, sx, yl, yh);
 }
@@ -725,6 +784,9 @@ void rt_tlatesubclamp1col (int hx, int sx, int yl, int yh)
 // Translates and subtracts all four spans to the screen starting at sx with clamping.
 void STACK_ARGS rt_tlatesubclamp4cols (int sx, int yl, int yh)
 {
+	if (DrawerQueue.IsRecording ())
+		return DrawerQueue.QueuePost4 (rt_tlatesubclamp4cols, sx, yl, yh);
+
 	rt_Translate4cols(dc_translation, yl, yh);
 	rt_subclamp4cols(sx, yl, yh);
 }
@@ -732,6 +794,9 @@ void STACK_ARGS rt_tlatesubclamp4cols (int sx, int yl, int yh)
 // Subtracts one span at hx from the screen at sx with clamping.
 void rt_revsubclamp1col (int hx, int sx, int yl, int yh)
 {
+	if (DrawerQueue.IsRecording ())
+		return DrawerQueue.QueuePost1 (rt_revsubclamp1col, hx, sx, yl, yh);
+
 	BYTE *colormap;
 	BYTE *source;
 	BYTE *dest;
@@ -765,8 +830,11 @@ void rt_revsubclamp1col (int hx, int sx, int yl, int yh)
 }
 
 // Subtracts all four spans from the screen starting at sx with clamping.
-void STACK_ARGS rt_revsubclamp4cols (int sx, int yl, int yh)
+void STACK_ARGS rt_revsubclamp4cols_c (int sx, int yl, int yh)
 {
+	if (DrawerQueue.IsRecording ())
+		return DrawerQueue.QueuePost4 (rt_revsubclamp4cols_c, sx, yl, yh);
+
 	BYTE *colormap;
 	BYTE *source;
 	BYTE *dest;
@@ -827,6 +895,9 @@ void STACK_ARGS rt_revsubclamp4cols (int sx, int yl, int yh)
 // Translates and subtracts one span at hx from the screen at sx with clamping.
 void rt_tlaterevsubclamp1col (int hx, int sx, int yl, int yh)
 {
+	if (DrawerQueue.IsRecording ())
+		return DrawerQueue.QueuePost1 (rt_tlaterevsubclamp1col, hx, sx, yl, yh);
+
 	rt_Translate1col(dc_translation, hx, yl, yh);
 	rt_revsubclamp1col(hx, sx, yl, yh);
 }
@@ -834,6 +905,9 @@ void rt_tlaterevsubclamp1col (int hx, int sx, int yl, int yh)
 // Translates and subtracts all four spans from the screen starting at sx with clamping.
 void STACK_ARGS rt_tlaterevsubclamp4cols (int sx, int yl, int yh)
 {
+	if (DrawerQueue.IsRecording ())
+		return DrawerQueue.QueuePost4 (rt_tlaterevsubclamp4cols, sx, yl, yh);
+
 	rt_Translate4cols(dc_translation, yl, yh);
 	rt_revsubclamp4cols(sx, yl, yh);
 }
@@ -0,0 +1,806 @@
+//-----------------------------------------------------------------------------
+//
+// Zandronum Source
+// Copyright (C) 2026 Zandronum Development Team
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 3. Neither the name of the Zandronum Development Team nor the names of its
+//    contributors may be used to endorse or promote products derived from this
+//    software without specific prior written permission.
+// 4. Redistributions in any form must be accompanied by information on how to
+//    obtain complete source code for the software and any accompanying
+//    software that uses the software. The source code must either be included
+//    in the distribution or be available for no more than the cost of
+//    distribution plus a nominal fee, and must be freely redistributable
+//    under reasonable conditions. For an executable file, complete source
+//    code means the source code for all modules it contains. It does not
+//    include source code for modules or files that typically accompany the
+//    major components of the operating system on which the executable file
+//    runs.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+//
+// Filename: r_drawt_simd.cpp
+//
+// Description: SSE2 and AVX2 versions of the blended post drawers and span drawers.
+//
+//-----------------------------------------------------------------------------
+
+
+#include <string.h>
+
+#include "doomtype.h"
+#include "doomdef.h"
+#include "r_defs.h"
+#include "r_draw.h"
+#include "r_main.h"
+#include "v_video.h"
+#include "r_thread.h"
+#include "c_dispatch.h"
+#include "m_random.h"
+#include "i_system.h"
+#include "x86.h"
+
+#ifdef R_DRAWER_SIMD
+
+#include <emmintrin.h>
+#include <immintrin.h>
+
+// The AVX2 drawers are only called when CPUID says the CPU has AVX2, so
+// the rest of the file does not need to be compiled for it.
+#ifdef __GNUC__
+#define AVX2_TARGET __attribute__((target("avx2")))
+#else
+#define AVX2_TARGET
+#endif
+
+//==========================================================================
+//
+// Blend operations
+//
+// Each one does exactly what the matching C drawer does to one pixel, on
+// four (SSE2) or eight (AVX2) pixels at once, and returns the RGB32k
+// indices of the results.
+//
+//==========================================================================
+
+struct FAddBlend
+{
+	static inline __m128i Blend (__m128i fg, __m128i bg)
+	{
+		__m128i a = _mm_or_si128 (_mm_add_epi32 (fg, bg), _mm_set1_epi32 (0x1f07c1f));
+		return _mm_and_si128 (a, _mm_srli_epi32 (a, 15));
+	}
+
+	AVX2_TARGET static inline __m256i Blend (__m256i fg, __m256i bg)
+	{
+		__m256i a = _mm256_or_si256 (_mm256_add_epi32 (fg, bg), _mm256_set1_epi32 (0x1f07c1f));
+		return _mm256_and_si256 (a, _mm256_srli_epi32 (a, 15));
+	}
+};
+
+struct FAddClampBlend
+{
+	static inline __m128i Blend (__m128i fg, __m128i bg)
+	{
+		__m128i a = _mm_add_epi32 (fg, bg);
+		__m128i b = _mm_and_si128 (a, _mm_set1_epi32 (0x40100400));
+		a = _mm_and_si128 (_mm_or_si128 (a, _mm_set1_epi32 (0x01f07c1f)), _mm_set1_epi32 (0x3fffffff));
+		b = _mm_sub_epi32 (b, _mm_srli_epi32 (b, 5));
+		a = _mm_or_si128 (a, b);
+		return _mm_and_si128 (a, _mm_srli_epi32 (a, 15));
+	}
+
+	AVX2_TARGET static inline __m256i Blend (__m256i fg, __m256i bg)
+	{
+		__m256i a = _mm256_add_epi32 (fg, bg);
+		__m256i b = _mm256_and_si256 (a, _mm256_set1_epi32 (0x40100400));
+		a = _mm256_and_si256 (_mm256_or_si256 (a, _mm256_set1_epi32 (0x01f07c1f)), _mm256_set1_epi32 (0x3fffffff));
+		b = _mm256_sub_epi32 (b, _mm256_srli_epi32 (b, 5));
+		a = _mm256_or_si256 (a, b);
+		return _mm256_and_si256 (a, _mm256_srli_epi32 (a, 15));
+	}
+};
+
+struct FSubClampBlend
+{
+	static inline __m128i Blend (__m128i fg, __m128i bg)
+	{
+		__m128i a = _mm_sub_epi32 (_mm_or_si128 (fg, _mm_set1_epi32 (0x40100400)), bg);
+		__m128i b = _mm_and_si128 (a, _mm_set1_epi32 (0x40100400));
+		b = _mm_sub_epi32 (b, _mm_srli_epi32 (b, 5));
+		a = _mm_or_si128 (_mm_and_si128 (a, b), _mm_set1_epi32 (0x01f07c1f));
+		return _mm_and_si128 (a, _mm_srli_epi32 (a, 15));
+	}
+
+	AVX2_TARGET static inline __m256i Blend (__m256i fg, __m256i bg)
+	{
+		__m256i a = _mm256_sub_epi32 (_mm256_or_si256 (fg, _mm256_set1_epi32 (0x40100400)), bg);
+		__m256i b = _mm256_and_si256 (a, _mm256_set1_epi32 (0x40100400));
+		b = _mm256_sub_epi32 (b, _mm256_srli_epi32 (b, 5));
+		a = _mm256_or_si256 (_mm256_and_si256 (a, b), _mm256_set1_epi32 (0x01f07c1f));
+		return _mm256_and_si256 (a, _mm256_srli_epi32 (a, 15));
+	}
+};
+
+struct FRevSubClampBlend
+{
+	static inline __m128i Blend (__m128i fg, __m128i bg)
+	{
+		return FSubClampBlend::Blend (bg, fg);
+	}
+
+	AVX2_TARGET static inline __m256i Blend (__m256i fg, __m256i bg)
+	{
+		return FSubClampBlend::Blend (bg, fg);
+	}
+};
+
+//==========================================================================
+//
+// StorePixels
+//
+// Writes four RGB32k lookups to dest.
+//
+//==========================================================================
+
+static inline void StorePixels (BYTE *dest, __m128i index)
+{
+	DWORD i[4];
+
+	_mm_storeu_si128 ((__m128i *)i, index);
+	dest[0] = RGB32k[0][0][i[0]];
+	dest[1] = RGB32k[0][0][i[1]];
+	dest[2] = RGB32k[0][0][i[2]];
+	dest[3] = RGB32k[0][0][i[3]];
+}
+
+//==========================================================================
+//
+// rt_Blend4cols_SSE2
+//
+// One row of the four spans per iteration. The table lookups are still
+// done one pixel at a time, but the blending is done on all four.
+//
+//==========================================================================
+
+template<class Op>
+static inline void rt_Blend4cols_SSE2 (int sx, int yl, int yh)
+{
+	int count = yh - yl;
+	if (count < 0)
+		return;
+	count++;
+
+	const DWORD *fg2rgb = dc_srcblend;
+	const DWORD *bg2rgb = dc_destblend;
+	const BYTE *colormap = dc_colormap;
+	const BYTE *source = &dc_temp[yl*4];
+	BYTE *dest = ylookup[yl] + sx + dc_destorg;
+	int pitch = dc_pitch;
+
+	do
+	{
+		__m128i fg = _mm_setr_epi32 (fg2rgb[colormap[source[0]]], fg2rgb[colormap[source[1]]],
+			fg2rgb[colormap[source[2]]], fg2rgb[colormap[source[3]]]);
+		__m128i bg = _mm_setr_epi32 (bg2rgb[dest[0]], bg2rgb[dest[1]], bg2rgb[dest[2]], bg2rgb[dest[3]]);
+
+		StorePixels (dest, Op::Blend (fg, bg));
+		source += 4;
+		dest += pitch;
+	} while (--count);
+}
+
+//==========================================================================
+//
+// rt_Blend4cols_AVX2
+//
+// Two rows per iteration, with the blend tables read by gathers. The
+// colormap is only 256 bytes, so it is still read one byte at a time
+// rather than risk a gather reading past its end.
+//
+//==========================================================================
+
+template<class Op>
+AVX2_TARGET static inline void rt_Blend4cols_AVX2 (int sx, int yl, int yh)
+{
+	int count = yh - yl;
+	if (count < 0)
+		return;
+	count++;
+
+	const DWORD *fg2rgb = dc_srcblend;
+	const DWORD *bg2rgb = dc_destblend;
+	const BYTE *colormap = dc_colormap;
+	const BYTE *source = &dc_temp[yl*4];
+	BYTE *dest = ylookup[yl] + sx + dc_destorg;
+	int pitch = dc_pitch;
+
+	for (; count >= 2; count -= 2)
+	{
+		DWORD row0, row1;
+		DWORD i[8];
+
+		memcpy (&row0, dest, 4);
+		memcpy (&row1, dest + pitch, 4);
+
+		__m256i fgindex = _mm256_setr_epi32 (colormap[source[0]], colormap[source[1]],
+			colormap[source[2]], colormap[source[3]], colormap[source[4]], colormap[source[5]],
+			colormap[source[6]], colormap[source[7]]);
+		__m256i bgindex = _mm256_cvtepu8_epi32 (_mm_setr_epi32 (row0, row1, 0, 0));
+		__m256i fg = _mm256_i32gather_epi32 ((const int *)fg2rgb, fgindex, 4);
+		__m256i bg = _mm256_i32gather_epi32 ((const int *)bg2rgb, bgindex, 4);
+
+		_mm256_storeu_si256 ((__m256i *)i, Op::Blend (fg, bg));
+		dest[0] = RGB32k[0][0][i[0]];
+		dest[1] = RGB32k[0][0][i[1]];
+		dest[2] = RGB32k[0][0][i[2]];
+		dest[3] = RGB32k[0][0][i[3]];
+		dest[pitch+0] = RGB32k[0][0][i[4]];
+		dest[pitch+1] = RGB32k[0][0][i[5]];
+		dest[pitch+2] = RGB32k[0][0][i[6]];
+		dest[pitch+3] = RGB32k[0][0][i[7]];
+
+		source += 8;
+		dest += pitch*2;
+	}
+	if (count != 0)
+	{
+		__m128i fg = _mm_setr_epi32 (fg2rgb[colormap[source[0]]], fg2rgb[colormap[source[1]]],
+			fg2rgb[colormap[source[2]]], fg2rgb[colormap[source[3]]]);
+		__m128i bg = _mm_setr_epi32 (bg2rgb[dest[0]], bg2rgb[dest[1]], bg2rgb[dest[2]], bg2rgb[dest[3]]);
+
+		StorePixels (dest, Op::Blend (fg, bg));
+	}
+}
+
+//==========================================================================
+//
+// rt_Shaded4cols
+//
+// Like the add drawers, except the colormap result picks the blend tables.
+//
+//==========================================================================
+
+static inline void rt_Shaded4cols_SSE2 (int sx, int yl, int yh)
+{
+	int count = yh - yl;
+	if (count < 0)
+		return;
+	count++;
+
+	const DWORD *fgstart = &Col2RGB8[0][dc_color];
+	const BYTE *colormap = dc_colormap;
+	const BYTE *source = &dc_temp[yl*4];
+	BYTE *dest = ylookup[yl] + sx + dc_destorg;
+	int pitch = dc_pitch;
+
+	do
+	{
+		DWORD v0 = colormap[source[0]];
+		DWORD v1 = colormap[source[1]];
+		DWORD v2 = colormap[source[2]];
+		DWORD v3 = colormap[source[3]];
+		__m128i fg = _mm_setr_epi32 (fgstart[v0<<8], fgstart[v1<<8], fgstart[v2<<8], fgstart[v3<<8]);
+		__m128i bg = _mm_setr_epi32 (Col2RGB8[64-v0][dest[0]], Col2RGB8[64-v1][dest[1]],
+			Col2RGB8[64-v2][dest[2]], Col2RGB8[64-v3][dest[3]]);
+
+		StorePixels (dest, FAddBlend::Blend (fg, bg));
+		source += 4;
+		dest += pitch;
+	} while (--count);
+}
+
+AVX2_TARGET static inline void rt_Shaded4cols_AVX2 (int sx, int yl, int yh)
+{
+	int count = yh - yl;
+	if (count < 0)
+		return;
+	count++;
+
+	const DWORD *fgstart = &Col2RGB8[0][dc_color];
+	const BYTE *colormap = dc_colormap;
+	const BYTE *source = &dc_temp[yl*4];
+	BYTE *dest = ylookup[yl] + sx + dc_destorg;
+	int pitch = dc_pitch;
+
+	for (; count >= 2; count -= 2)
+	{
+		DWORD row0, row1;
+		DWORD i[8];
+
+		memcpy (&row0, dest, 4);
+		memcpy (&row1, dest + pitch, 4);
+
+		__m256i val = _mm256_setr_epi32 (colormap[source[0]], colormap[source[1]],
+			colormap[source[2]], colormap[source[3]], colormap[source[4]], colormap[source[5]],
+			colormap[source[6]], colormap[source[7]]);
+		__m256i bgindex = _mm256_add_epi32 (_mm256_slli_epi32 (_mm256_sub_epi32 (_mm256_set1_epi32 (64), val), 8),
+			_mm256_cvtepu8_epi32 (_mm_setr_epi32 (row0, row1, 0, 0)));
+		__m256i fg = _mm256_i32gather_epi32 ((const int *)fgstart, _mm256_slli_epi32 (val, 8), 4);
+		__m256i bg = _mm256_i32gather_epi32 ((const int *)&Col2RGB8[0][0], bgindex, 4);
+
+		_mm256_storeu_si256 ((__m256i *)i, FAddBlend::Blend (fg, bg));
+		dest[0] = RGB32k[0][0][i[0]];
+		dest[1] = RGB32k[0][0][i[1]];
+		dest[2] = RGB32k[0][0][i[2]];
+		dest[3] = RGB32k[0][0][i[3]];
+		dest[pitch+0] = RGB32k[0][0][i[4]];
+		dest[pitch+1] = RGB32k[0][0][i[5]];
+		dest[pitch+2] = RGB32k[0][0][i[6]];
+		dest[pitch+3] = RGB32k[0][0][i[7]];
+
+		source += 8;
+		dest += pitch*2;
+	}
+	if (count != 0)
+	{
+		DWORD v0 = colormap[source[0]];
+		DWORD v1 = colormap[source[1]];
+		DWORD v2 = colormap[source[2]];
+		DWORD v3 = colormap[source[3]];
+		__m128i fg = _mm_setr_epi32 (fgstart[v0<<8], fgstart[v1<<8], fgstart[v2<<8], fgstart[v3<<8]);
+		__m128i bg = _mm_setr_epi32 (Col2RGB8[64-v0][dest[0]], Col2RGB8[64-v1][dest[1]],
+			Col2RGB8[64-v2][dest[2]], Col2RGB8[64-v3][dest[3]]);
+
+		StorePixels (dest, FAddBlend::Blend (fg, bg));
+	}
+}
+
+//==========================================================================
+//
+// R_DrawBlendSpan_SSE2
+//
+// Four pixels of the span per iteration. The texture coordinates are
+// stepped in all four lanes at once; whatever is left over at the end of
+// the span is done one pixel at a time.
+//
+//==========================================================================
+
+template<class Op>
+static inline void R_DrawBlendSpan_SSE2 ()
+{
+	const BYTE *source = ds_source;
+	const BYTE *colormap = ds_colormap;
+	const DWORD *fg2rgb = dc_srcblend;
+	const DWORD *bg2rgb = dc_destblend;
+	dsfixed_t xfrac = ds_xfrac;
+	dsfixed_t yfrac = ds_yfrac;
+	dsfixed_t xstep = ds_xstep;
+	dsfixed_t ystep = ds_ystep;
+	BYTE *dest = ylookup[ds_y] + ds_x1 + dc_destorg;
+	int count = ds_x2 - ds_x1 + 1;
+
+	BYTE yshift = 32 - ds_ybits;
+	BYTE xshift = yshift - ds_xbits;
+	int xmask = ((1 << ds_xbits) - 1) << ds_ybits;
+
+	if (count >= 4)
+	{
+		__m128i xf = _mm_setr_epi32 (xfrac, xfrac + xstep, xfrac + xstep*2, xfrac + xstep*3);
+		__m128i yf = _mm_setr_epi32 (yfrac, yfrac + ystep, yfrac + ystep*2, yfrac + ystep*3);
+		const __m128i xstep4 = _mm_set1_epi32 (xstep*4);
+		const __m128i ystep4 = _mm_set1_epi32 (ystep*4);
+		const __m128i xshiftv = _mm_cvtsi32_si128 (xshift);
+		const __m128i yshiftv = _mm_cvtsi32_si128 (yshift);
+		const __m128i xmaskv = _mm_set1_epi32 (xmask);
+
+		do
+		{
+			DWORD spot[4];
+
+			_mm_storeu_si128 ((__m128i *)spot, _mm_add_epi32 (
+				_mm_and_si128 (_mm_srl_epi32 (xf, xshiftv), xmaskv), _mm_srl_epi32 (yf, yshiftv)));
+
+			__m128i fg = _mm_setr_epi32 (fg2rgb[colormap[source[spot[0]]]], fg2rgb[colormap[source[spot[1]]]],
+				fg2rgb[colormap[source[spot[2]]]], fg2rgb[colormap[source[spot[3]]]]);
+			__m128i bg = _mm_setr_epi32 (bg2rgb[dest[0]], bg2rgb[dest[1]], bg2rgb[dest[2]], bg2rgb[dest[3]]);
+
+			StorePixels (dest, Op::Blend (fg, bg));
+			xf = _mm_add_epi32 (xf, xstep4);
+			yf = _mm_add_epi32 (yf, ystep4);
+			dest += 4;
+			count -= 4;
+		} while (count >= 4);
+
+		xfrac = _mm_cvtsi128_si32 (xf);
+		yfrac = _mm_cvtsi128_si32 (yf);
+	}
+
+	while (count-- > 0)
+	{
+		int spot = ((xfrac >> xshift) & xmask) + (yfrac >> yshift);
+		__m128i fg = _mm_cvtsi32_si128 (fg2rgb[colormap[source[spot]]]);
+		__m128i bg = _mm_cvtsi32_si128 (bg2rgb[*dest]);
+
+		*dest++ = RGB32k[0][0][_mm_cvtsi128_si32 (Op::Blend (fg, bg))];
+		xfrac += xstep;
+		yfrac += ystep;
+	}
+}
+
+//==========================================================================
+//
+// The drawers themselves
+//
+//==========================================================================
+
+void STACK_ARGS rt_shaded4cols_sse2 (int sx, int yl, int yh)
+{
+	if (DrawerQueue.IsRecording ())
+		return DrawerQueue.QueuePost4 (rt_shaded4cols_sse2, sx, yl, yh);
+
+	rt_Shaded4cols_SSE2 (sx, yl, yh);
+}
+
+void STACK_ARGS rt_add4cols_sse2 (int sx, int yl, int yh)
+{
+	if (DrawerQueue.IsRecording ())
+		return DrawerQueue.QueuePost4 (rt_add4cols_sse2, sx, yl, yh);
+
+	rt_Blend4cols_SSE2<FAddBlend> (sx, yl, yh);
+}
+
+void STACK_ARGS rt_addclamp4cols_sse2 (int sx, int yl, int yh)
+{
+	if (DrawerQueue.IsRecording ())
+		return DrawerQueue.QueuePost4 (rt_addclamp4cols_sse2, sx, yl, yh);
+
+	rt_Blend4cols_SSE2<FAddClampBlend> (sx, yl, yh);
+}
+
+void STACK_ARGS rt_subclamp4cols_sse2 (int sx, int yl, int yh)
+{
+	if (DrawerQueue.IsRecording ())
+		return DrawerQueue.QueuePost4 (rt_subclamp4cols_sse2, sx, yl, yh);
+
+	rt_Blend4cols_SSE2<FSubClampBlend> (sx, yl, yh);
+}
+
+void STACK_ARGS rt_revsubclamp4cols_sse2 (int sx, int yl, int yh)
+{
+	if (DrawerQueue.IsRecording ())
+		return DrawerQueue.QueuePost4 (rt_revsubclamp4cols_sse2, sx, yl, yh);
+
+	rt_Blend4cols_SSE2<FRevSubClampBlend> (sx, yl, yh);
+}
+
+AVX2_TARGET void STACK_ARGS rt_shaded4cols_avx2 (int sx, int yl, int yh)
+{
+	if (DrawerQueue.IsRecording ())
+		return DrawerQueue.QueuePost4 (rt_shaded4cols_avx2, sx, yl, yh);
+
+	rt_Shaded4cols_AVX2 (sx, yl, yh);
+}
+
+AVX2_TARGET void STACK_ARGS rt_add4cols_avx2 (int sx, int yl, int yh)
+{
+	if (DrawerQueue.IsRecording ())
+		return DrawerQueue.QueuePost4 (rt_add4cols_avx2, sx, yl, yh);
+
+	rt_Blend4cols_AVX2<FAddBlend> (sx, yl, yh);
+}
+
+AVX2_TARGET void STACK_ARGS rt_addclamp4cols_avx2 (int sx, int yl, int yh)
+{
+	if (DrawerQueue.IsRecording ())
+		return DrawerQueue.QueuePost4 (rt_addclamp4cols_avx2, sx, yl, yh);
+
+	rt_Blend4cols_AVX2<FAddClampBlend> (sx, yl, yh);
+}
+
+AVX2_TARGET void STACK_ARGS rt_subclamp4cols_avx2 (int sx, int yl, int yh)
+{
+	if (DrawerQueue.IsRecording ())
+		return DrawerQueue.QueuePost4 (rt_subclamp4cols_avx2, sx, yl, yh);
+
+	rt_Blend4cols_AVX2<FSubClampBlend> (sx, yl, yh);
+}
+
+AVX2_TARGET void STACK_ARGS rt_revsubclamp4cols_avx2 (int sx, int yl, int yh)
+{
+	if (DrawerQueue.IsRecording ())
+		return DrawerQueue.QueuePost4 (rt_revsubclamp4cols_avx2, sx, yl, yh);
+
+	rt_Blend4cols_AVX2<FRevSubClampBlend> (sx, yl, yh);
+}
+
+void R_DrawSpanTranslucentP_SSE2 (void)
+{
+	if (DrawerQueue.IsRecording ())
+		return DrawerQueue.QueueSpan (R_DrawSpanTranslucentP_SSE2);
+
+	R_DrawBlendSpan_SSE2<FAddBlend> ();
+}
+
+void R_DrawSpanAddClampP_SSE2 (void)
+{
+	if (DrawerQueue.IsRecording ())
+		return DrawerQueue.QueueSpan (R_DrawSpanAddClampP_SSE2);
+
+	R_DrawBlendSpan_SSE2<FAddClampBlend> ();
+}
+
+//==========================================================================
+//
+// CCMD drawercheck
+//
+// Runs every SIMD drawer in this file and the C drawer it replaces on the
+// same random source, colormap, blend tables and destination, and reports
+// every drawer whose output differs from the C drawer's.
+//
+// drawercheck [iterations] [seed]
+//
+//==========================================================================
+
+typedef void (STACK_ARGS *FPost4Drawer) (int sx, int yl, int yh);
+typedef void (*FSpanDrawer) (void);
+
+enum EDrawerCheckBlend
+{
+	CHECKBLEND_Shaded,	// colormap holds alpha levels, dc_color picks the color
+	CHECKBLEND_Add,		// Col2RGB8, both levels add up to at most 64
+	CHECKBLEND_Clamp,	// Col2RGB8_LessPrecision, or Col2RGB8_Inverse for the source
+};
+
+struct FPostDrawerCheck
+{
+	const char *Name;
+	EDrawerCheckBlend Blend;
+	FPost4Drawer C, SSE2, AVX2;
+};
+
+struct FSpanDrawerCheck
+{
+	const char *Name;
+	EDrawerCheckBlend Blend;
+	FSpanDrawer C, SSE2;
+};
+
+static const FPostDrawerCheck PostDrawerChecks[] =
+{
+	{ "rt_shaded4cols",		CHECKBLEND_Shaded,	rt_shaded4cols_c,		rt_shaded4cols_sse2,		rt_shaded4cols_avx2 },
+	{ "rt_add4cols",		CHECKBLEND_Add,		rt_add4cols_c,			rt_add4cols_sse2,			rt_add4cols_avx2 },
+	{ "rt_addclamp4cols",	CHECKBLEND_Clamp,	rt_addclamp4cols_c,		rt_addclamp4cols_sse2,		rt_addclamp4cols_avx2 },
+	{ "rt_subclamp4cols",	CHECKBLEND_Clamp,	rt_subclamp4cols_c,		rt_subclamp4cols_sse2,		rt_subclamp4cols_avx2 },
+	{ "rt_revsubclamp4cols",CHECKBLEND_Clamp,	rt_revsubclamp4cols_c,	rt_revsubclamp4cols_sse2,	rt_revsubclamp4cols_avx2 },
+};
+
+static const FSpanDrawerCheck SpanDrawerChecks[] =
+{
+	{ "R_DrawSpanTranslucent",	CHECKBLEND_Add,		R_DrawSpanTranslucentP_C,	R_DrawSpanTranslucentP_SSE2 },
+	{ "R_DrawSpanAddClamp",		CHECKBLEND_Clamp,	R_DrawSpanAddClampP_C,		R_DrawSpanAddClampP_SSE2 },
+};
+
+enum
+{
+	CHECK_WIDTH = 64,
+	CHECK_HEIGHT = 64,
+};
+
+static void DrawerCheckSetup (FRandom &rng, EDrawerCheckBlend blend, BYTE *colormap, BYTE *dest)
+{
+	for (int i = 0; i < 256; ++i)
+	{
+		colormap[i] = blend == CHECKBLEND_Shaded ? rng(65) : rng();
+	}
+	for (int i = 0; i < CHECK_WIDTH * CHECK_HEIGHT; ++i)
+	{
+		dest[i] = rng();
+	}
+
+	const int fglevel = rng(65);
+	const int bglevel = blend == CHECKBLEND_Add ? rng(65 - fglevel) : rng(65);
+
+	switch (blend)
+	{
+	case CHECKBLEND_Shaded:
+		dc_color = rng();
+		break;
+
+	case CHECKBLEND_Add:
+		dc_srcblend = Col2RGB8[fglevel];
+		dc_destblend = Col2RGB8[bglevel];
+		break;
+
+	case CHECKBLEND_Clamp:
+		dc_srcblend = (rng() & 1) ? Col2RGB8_Inverse[fglevel] : Col2RGB8_LessPrecision[fglevel];
+		dc_destblend = Col2RGB8_LessPrecision[bglevel];
+		break;
+	}
+}
+
+// Runs both drawers on copies of the same destination. Returns true if they match.
+template<class Draw>
+static bool DrawerCheckCompare (const BYTE *dest, BYTE *cdest, BYTE *simddest, Draw draw)
+{
+	memcpy (cdest, dest, CHECK_WIDTH * CHECK_HEIGHT);
+	memcpy (simddest, dest, CHECK_WIDTH * CHECK_HEIGHT);
+
+	dc_destorg = cdest;
+	draw (false);
+	dc_destorg = simddest;
+	draw (true);
+	return memcmp (cdest, simddest, CHECK_WIDTH * CHECK_HEIGHT) == 0;
+}
+
+struct FPostDrawerRun
+{
+	FPost4Drawer C, SIMD;
+	int sx, yl, yh;
+
+	void operator() (bool simd) const
+	{
+		(simd ? SIMD : C) (sx, yl, yh);
+	}
+};
+
+struct FSpanDrawerRun
+{
+	FSpanDrawer C, SIMD;
+
+	void operator() (bool simd) const
+	{
+		(simd ? SIMD : C) ();
+	}
+};
+
+CCMD (drawercheck)
+{
+	const int iterations = argv.argc() > 1 ? atoi (argv[1]) : 10000;
+	const DWORD seed = argv.argc() > 2 ? DWORD(strtoul (argv[2], NULL, 0)) : DWORD(I_MSTime ());
+
+	if (iterations <= 0)
+	{
+		Printf ("Usage: drawercheck [iterations] [seed]\n");
+		return;
+	}
+	if (Col2RGB8_LessPrecision[1] == NULL)
+	{
+		Printf ("drawercheck needs the palette's blend tables, which have not been built.\n");
+		return;
+	}
+
+	// Draw into our own buffers instead of the screen.
+	int oldylookup[CHECK_HEIGHT];
+	BYTE *const olddestorg = dc_destorg;
+	const int oldpitch = dc_pitch;
+	BYTE *const oldtemp = dc_temp;
+	lighttable_t *const oldcolormap = dc_colormap;
+	DWORD *const oldsrcblend = dc_srcblend;
+	DWORD *const olddestblend = dc_destblend;
+	const int oldcolor = dc_color;
+
+	memcpy (oldylookup, ylookup, sizeof(oldylookup));
+	for (int y = 0; y < CHECK_HEIGHT; ++y)
+	{
+		ylookup[y] = y * CHECK_WIDTH;
+	}
+	dc_pitch = CHECK_WIDTH;
+
+	TArray<BYTE> temp, source, colormap, dest, cdest, simddest;
+	temp.Resize (CHECK_HEIGHT * 4);
+	source.Resize (64 * 64);
+	colormap.Resize (256);
+	dest.Resize (CHECK_WIDTH * CHECK_HEIGHT);
+	cdest.Resize (CHECK_WIDTH * CHECK_HEIGHT);
+	simddest.Resize (CHECK_WIDTH * CHECK_HEIGHT);
+
+	FRandom rng;
+	rng.Init (seed);
+	dc_temp = &temp[0];
+	dc_colormap = &colormap[0];
+
+	int mismatches = 0, tested = 0;
+
+	for (size_t i = 0; i < countof(PostDrawerChecks); ++i)
+	{
+		const FPostDrawerCheck &check = PostDrawerChecks[i];
+
+		for (int avx2 = 0; avx2 < 2; ++avx2)
+		{
+			if (avx2 && !CPU.bAVX2)
+			{
+				continue;
+			}
+
+			FPostDrawerRun run = { check.C, avx2 ? check.AVX2 : check.SSE2 };
+			int failed = 0;
+
+			for (int j = 0; j < iterations; ++j)
+			{
+				DrawerCheckSetup (rng, check.Blend, &colormap[0], &dest[0]);
+				for (unsigned int k = 0; k < temp.Size(); ++k)
+				{
+					temp[k] = rng();
+				}
+				run.sx = rng(CHECK_WIDTH - 3);
+				run.yl = rng(CHECK_HEIGHT);
+				run.yh = run.yl + rng(CHECK_HEIGHT - run.yl);
+
+				if (!DrawerCheckCompare (&dest[0], &cdest[0], &simddest[0], run) && failed++ == 0)
+				{
+					Printf (TEXTCOLOR_RED "%s_%s differs from the C drawer (sx %d, yl %d, yh %d).\n",
+						check.Name, avx2 ? "avx2" : "sse2", run.sx, run.yl, run.yh);
+				}
+			}
+			mismatches += failed;
+			tested++;
+		}
+	}
+
+	for (size_t i = 0; i < countof(SpanDrawerChecks); ++i)
+	{
+		const FSpanDrawerCheck &check = SpanDrawerChecks[i];
+		FSpanDrawerRun run = { check.C, check.SSE2 };
+		int failed = 0;
+
+		ds_source = &source[0];
+		ds_colormap = &colormap[0];
+
+		for (int j = 0; j < iterations; ++j)
+		{
+			DrawerCheckSetup (rng, check.Blend, &colormap[0], &dest[0]);
+			for (unsigned int k = 0; k < source.Size(); ++k)
+			{
+				source[k] = rng();
+			}
+			ds_xbits = 1 + rng(6);
+			ds_ybits = 1 + rng(6);
+			ds_y = rng(CHECK_HEIGHT);
+			ds_x1 = rng(CHECK_WIDTH);
+			ds_x2 = ds_x1 + rng(CHECK_WIDTH - ds_x1);
+			ds_xfrac = rng.GenRand32();
+			ds_yfrac = rng.GenRand32();
+			ds_xstep = rng.GenRand32();
+			ds_ystep = rng.GenRand32();
+
+			if (!DrawerCheckCompare (&dest[0], &cdest[0], &simddest[0], run) && failed++ == 0)
+			{
+				Printf (TEXTCOLOR_RED "%s_SSE2 differs from the C drawer (x %d to %d, bits %d x %d).\n",
+					check.Name, ds_x1, ds_x2, ds_xbits, ds_ybits);
+			}
+		}
+		mismatches += failed;
+		tested++;
+	}
+
+	memcpy (ylookup, oldylookup, sizeof(oldylookup));
+	dc_destorg = olddestorg;
+	dc_pitch = oldpitch;
+	dc_temp = oldtemp;
+	dc_colormap = oldcolormap;
+	dc_srcblend = oldsrcblend;
+	dc_destblend = olddestblend;
+	dc_color = oldcolor;
+
+	if (mismatches > 0)
+	{
+		Printf (TEXTCOLOR_RED "%d of %d runs differed from the C drawers (seed %u).\n", mismatches, tested * iterations, seed);
+	}
+	else
+	{
+		Printf ("%d SIMD drawers matched the C drawers in %d runs each (seed %u).\n", tested, iterations, seed);
+	}
+}
+
+#endif
@@ -27,6 +27,7 @@
 
 #include <stdlib.h>
 #include <math.h>
+#include <algorithm>
 
 // [BB] network.h has to be included before stats.h under Linux.
 // The reason should be investigated.
@@ -63,6 +64,8 @@
 #include "farchive.h"
 // [BC] New #includes.
 #include "sv_commands.h"
+// [ZA] New #includes.
+#include "r_thread.h"
 
 
 // MACROS ------------------------------------------------------------------
@@ -793,6 +796,9 @@ void R_RenderActorView (AActor *actor, bool dontmaplines)
 	R_SetupBuffer ();
 	R_SetupFrame (actor);
 
+	// [ZA] Queue the drawers so they can run on several threads.
+	DrawerQueue.Begin (viewheight);
+
 	// Clear buffers.
 	R_ClearClipSegs (0, viewwidth);
 	R_ClearDrawSegs ();
@@ -875,6 +881,8 @@ void R_RenderActorView (AActor *actor, bool dontmaplines)
 
 		if (r_polymost)
 		{
+			// [ZA] Polymost draws to the screen directly.
+			DrawerQueue.Flush ();
 			RP_RenderBSPNode (nodes + numnodes - 1);
 			if (polyclipped)
 			{
@@ -883,6 +891,8 @@ void R_RenderActorView (AActor *actor, bool dontmaplines)
 			}
 		}
 	}
+	// [ZA] Draw everything that is still queued.
+	DrawerQueue.Finish ();
 	WallMirrors.Clear ();
 	interpolator.RestoreInterpolations ();
 	R_SetupBuffer ();
@@ -1011,6 +1021,76 @@ CCMD (clearwallcycles)
 	bestwallcycles = HUGE_VAL;
 }
 
+//==========================================================================
+//
+// CCMD benchrender
+//
+// [ZA] Renders the current view off-screen a number of times while turning
+// the camera through a full circle, and prints how long the frames took.
+//
+// benchrender [frames] [width] [height]
+//
+//==========================================================================
+
+CCMD (benchrender)
+{
+	if (gamestate != GS_LEVEL || players[consoleplayer].camera == NULL)
+	{
+		Printf ("You must be in a level to use benchrender.\n");
+		return;
+	}
+
+	int numframes = argv.argc() > 1 ? atoi (argv[1]) : 360;
+	int width = argv.argc() > 2 ? atoi (argv[2]) : SCREENWIDTH;
+	int height = argv.argc() > 3 ? atoi (argv[3]) : SCREENHEIGHT;
+
+	if (numframes <= 0 || width <= 0 || height <= 0 || width > MAXWIDTH || height > MAXHEIGHT)
+	{
+		Printf ("Usage: benchrender [frames] [width] [height]\n");
+		return;
+	}
+
+	AActor *viewpoint = players[consoleplayer].camera;
+	const angle_t savedangle = viewpoint->angle;
+	const bool savednointerpolate = r_NoInterpolate;
+	TArray<double> times (numframes);
+	cycle_t frametime;
+
+	DSimpleCanvas *canvas = new DSimpleCanvas (width, height);
+	r_NoInterpolate = true;
+	canvas->Lock (true);
+
+	for (int i = 0; i < numframes; ++i)
+	{
+		viewpoint->angle = savedangle + (angle_t)(((QWORD)i << 32) / numframes);
+
+		frametime.Reset ();
+		frametime.Clock ();
+		R_RenderViewToCanvas (viewpoint, canvas, 0, 0, width, height);
+		frametime.Unclock ();
+		times.Push (frametime.TimeMS ());
+	}
+
+	canvas->Unlock ();
+	delete canvas;
+	viewpoint->angle = savedangle;
+	r_NoInterpolate = savednointerpolate;
+
+	double total = 0;
+	for (unsigned int i = 0; i < times.Size (); ++i)
+	{
+		total += times[i];
+	}
+	std::sort (&times[0], &times[0] + times.Size ());
+
+	const double average = total / times.Size ();
+	Printf ("%d frames at %dx%d, %d drawer thread%s\n", numframes, width, height,
+		DrawerQueue.GetNumThreads (), DrawerQueue.GetNumThreads () == 1 ? "" : "s");
+	Printf ("avg %.2f ms  min %.2f ms  median %.2f ms  95%% %.2f ms  max %.2f ms  (%.1f fps)\n",
+		average, times[0], times[times.Size () / 2], times[times.Size () * 95 / 100],
+		times[times.Size () - 1], average > 0 ? 1000. / average : 0.);
+}
+
 #if 1
 // To use these, also uncomment the clock/unclock in wallscan
 static double bestscancycles = HUGE_VAL;
@@ -64,6 +64,8 @@
 #include "r_data/colormaps.h"
 // [BC] New #includes.
 #include "sv_commands.h"
+// [ZA] New #includes.
+#include "r_thread.h"
 
 #ifdef _MSC_VER
 #pragma warning(disable:4244)
@@ -491,7 +493,11 @@ void R_MapTiltedPlane (int y, int x1)
 
 void R_MapColoredPlane (int y, int x1)
 {
-	memset (ylookup[y] + x1 + dc_destorg, ds_color, spanend[y] - x1 + 1);
+	// [ZA] Go through R_FillSpan so the span can be queued.
+	ds_y = y;
+	ds_x1 = x1;
+	ds_x2 = spanend[y];
+	R_FillSpan ();
 }
 
 //==========================================================================
@@ -870,6 +876,9 @@ extern FTexture *rw_pic;
 // We need 4 skybufs because wallscan can draw up to 4 columns at a time.
 static BYTE skybuf[4][512];
 static DWORD lastskycol[4];
+// [ZA] Where each cached column lives. While the drawers are queued, this
+// is memory from the queue rather than skybuf, which gets reused too soon.
+static BYTE *lastskybuf[4] = { skybuf[0], skybuf[1], skybuf[2], skybuf[3] };
 static int skycolplace;
 
 // Get a column of sky when there is only one sky texture.
@@ -895,12 +904,13 @@ static const BYTE *R_GetTwoSkyColumns (FTexture *fronttex, int x)
 	{
 		if (lastskycol[i] == skycol)
 		{
-			return skybuf[i];
+			return lastskybuf[i];
 		}
 	}
 
 	lastskycol[skycolplace] = skycol;
-	BYTE *composite = skybuf[skycolplace];
+	BYTE *composite = DrawerQueue.IsRecording () ? DrawerQueue.AllocMemory (512) : skybuf[skycolplace];
+	lastskybuf[skycolplace] = composite;
 	skycolplace = (skycolplace + 1) & 3;
 
 	// The ordering of the following code has been tuned to allow VC++ to optimize
@@ -1644,6 +1654,10 @@ void R_DrawTiltedPlane (visplane_t *pl, fixed_t alpha, bool additive, bool maske
 		return;
 	}
 
+	// [ZA] The tilted span drawer keeps its state in globals the queue
+	// does not know about, so it still draws directly.
+	DrawerQueue.Flush ();
+
 	double vx = FIXED2FLOAT(viewx);
 	double vy = FIXED2FLOAT(viewy);
 	double vz = FIXED2FLOAT(viewz);
@@ -30,6 +30,10 @@ struct FRenderer
 	// precache one texture
 	virtual void PrecacheTexture(FTexture *tex, int cache) = 0;
 
+	// [ZA] True if PrecacheTexture builds the paletted pixels, so that the
+	// texture manager can do that ahead of it on several threads.
+	virtual bool PrecachesPixels() const { return false; }
+
 	// render 3D view
 	virtual void RenderView(player_t *player) = 0;
 
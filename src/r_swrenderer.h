@@ -10,6 +10,7 @@ struct FSoftwareRenderer : public FRenderer
 
 	// precache one texture
 	virtual void PrecacheTexture(FTexture *tex, int cache);
+	virtual bool PrecachesPixels() const { return true; }	// [ZA]
 
 	// render 3D view
 	virtual void RenderView(player_t *player);
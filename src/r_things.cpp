@@ -69,6 +69,8 @@
 #include "lastmanstanding.h"
 #include "network.h"
 #include "gamemode.h"
+// [ZA] New #includes.
+#include "r_thread.h"
 
 // [RH] A c-buffer. Used for keeping track of offscreen voxel spans.
 
@@ -2306,6 +2308,21 @@ void R_DrawParticle (vissprite_t *vis)
 		fg = fg2rgb[color];
 	}
 
+	// [ZA] While the drawers are queued, draw the particle one column at a
+	// time through the fill drawer so it is queued along with them.
+	if (DrawerQueue.IsRecording ())
+	{
+		dc_count = ycount;
+		dc_srccolor = fg;
+		dc_destblend = bg2rgb;
+		for (int x = x1; x < x1 + countbase; ++x)
+		{
+			dc_dest = ylookup[yl] + x + dc_destorg;
+			R_FillAddColumn ();
+		}
+		return;
+	}
+
 	spacing = RenderTarget->GetPitch() - countbase;
 	dest = ylookup[yl] + x1 + dc_destorg;
 
@@ -0,0 +1,603 @@
+//-----------------------------------------------------------------------------
+//
+// Zandronum Source
+// Copyright (C) 2026 Zandronum Development Team
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 3. Neither the name of the Zandronum Development Team nor the names of its
+//    contributors may be used to endorse or promote products derived from this
+//    software without specific prior written permission.
+// 4. Redistributions in any form must be accompanied by information on how to
+//    obtain complete source code for the software and any accompanying
+//    software that uses the software. The source code must either be included
+//    in the distribution or be available for no more than the cost of
+//    distribution plus a nominal fee, and must be freely redistributable
+//    under reasonable conditions. For an executable file, complete source
+//    code means the source code for all modules it contains. It does not
+//    include source code for modules or files that typically accompany the
+//    major components of the operating system on which the executable file
+//    runs.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+//
+// Filename: r_thread.cpp
+//
+// Description: Queues the software renderer's drawer calls and runs them on several threads.
+//
+//-----------------------------------------------------------------------------
+
+#include <limits.h>
+#include <string.h>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "doomtype.h"
+#include "c_cvars.h"
+#include "i_system.h"
+#include "templates.h"
+#include "r_draw.h"
+#include "r_thread.h"
+
+// The most threads the drawers will ever be split across.
+#define MAX_DRAWER_THREADS	16
+
+// Size of the blocks AllocMemory hands out memory from.
+#define DRAWER_MEMORY_BLOCK	(256*1024)
+
+CVAR (Int, r_drawerthreads, 0, CVAR_ARCHIVE|CVAR_GLOBALCONFIG)	// 0 = one per CPU core, 1 = no threads
+
+FDrawerCommandQueue DrawerQueue;
+
+#ifdef R_DRAWER_THREADS
+thread_local bool FDrawerCommandQueue::Executing;
+#endif
+
+struct FDrawerCommandQueue::FThreadData
+{
+	std::mutex Mutex;
+	std::condition_variable Wake;
+	std::condition_variable Done;
+	std::vector<std::thread> Workers;
+	unsigned int Generation;
+	int Pending;
+	bool Quit;
+
+	FThreadData () : Generation(0), Pending(0), Quit(false) {}
+};
+
+//==========================================================================
+//
+// ClipRows
+//
+// Clips count rows starting at y to the slice [y0, y1). Returns false if
+// none of them are left.
+//
+//==========================================================================
+
+static inline bool ClipRows (int y, int count, int y0, int y1, int &skip, int &left)
+{
+	int start = MAX (y, y0);
+	int end = MIN (y + count, y1);
+
+	if (end <= start)
+	{
+		return false;
+	}
+	skip = start - y;
+	left = end - start;
+	return true;
+}
+
+//==========================================================================
+//
+// FDrawerCommandQueue constructor/destructor
+//
+//==========================================================================
+
+FDrawerCommandQueue::FDrawerCommandQueue ()
+: MemoryBlock(0), MemoryUsed(0), Active(false), NumThreads(1), Height(0), Threads(NULL)
+{
+}
+
+FDrawerCommandQueue::~FDrawerCommandQueue ()
+{
+	StopThreads ();
+	for (unsigned int i = 0; i < MemoryBlocks.Size(); ++i)
+	{
+		delete[] MemoryBlocks[i];
+	}
+}
+
+//==========================================================================
+//
+// FDrawerCommandQueue :: Begin
+//
+// Starts queueing drawer calls for a view that is height rows tall.
+//
+//==========================================================================
+
+void FDrawerCommandQueue::Begin (int height)
+{
+	if (Active)
+	{
+		Finish ();
+	}
+
+#ifdef R_DRAWER_THREADS
+	int threads = r_drawerthreads;
+	if (threads <= 0)
+	{
+		threads = (int)std::thread::hardware_concurrency ();
+	}
+	threads = clamp (threads, 1, MAX_DRAWER_THREADS);
+
+	if (threads != NumThreads)
+	{
+		StopThreads ();
+		NumThreads = threads;
+	}
+	if (NumThreads > 1 && Threads == NULL)
+	{
+		StartThreads (NumThreads - 1);
+	}
+
+	Commands.Clear ();
+	MemoryBlock = 0;
+	MemoryUsed = 0;
+	Height = height;
+	Active = (NumThreads > 1);
+#endif
+}
+
+//==========================================================================
+//
+// FDrawerCommandQueue :: Finish
+//
+// Draws everything that was queued and stops queueing.
+//
+//==========================================================================
+
+void FDrawerCommandQueue::Finish ()
+{
+	if (!Active)
+	{
+		return;
+	}
+	Flush ();
+	Active = false;
+	MemoryBlock = 0;
+	MemoryUsed = 0;
+}
+
+//==========================================================================
+//
+// FDrawerCommandQueue :: Flush
+//
+// Draws everything that was queued so far and waits for it to finish, so
+// the caller can draw to the screen directly. The main thread takes the
+// first slice itself.
+//
+//==========================================================================
+
+void FDrawerCommandQueue::Flush ()
+{
+	if (Commands.Size() == 0)
+	{
+		return;
+	}
+
+#ifdef R_DRAWER_THREADS
+	// Running commands overwrites this thread's drawer globals, which the
+	// renderer is still using.
+	FDrawerState saved;
+	saved.Save ();
+	Executing = true;
+
+	if (Threads != NULL)
+	{
+		{
+			std::lock_guard<std::mutex> lock (Threads->Mutex);
+			Threads->Generation++;
+			Threads->Pending = (int)Threads->Workers.size();
+		}
+		Threads->Wake.notify_all ();
+	}
+
+	RunSlice (0);
+
+	if (Threads != NULL)
+	{
+		std::unique_lock<std::mutex> lock (Threads->Mutex);
+		Threads->Done.wait (lock, [this] { return Threads->Pending == 0; });
+	}
+
+	Executing = false;
+	saved.Restore ();
+#endif
+
+	Commands.Clear ();
+}
+
+//==========================================================================
+//
+// FDrawerCommandQueue :: AllocMemory
+//
+// For data the queued drawers read that would otherwise be overwritten
+// before they run.
+//
+//==========================================================================
+
+BYTE *FDrawerCommandQueue::AllocMemory (size_t size)
+{
+	size = (size + 15) & ~size_t(15);
+	assert (size <= DRAWER_MEMORY_BLOCK);
+
+	while (MemoryBlock < MemoryBlocks.Size())
+	{
+		if (MemoryUsed + size <= DRAWER_MEMORY_BLOCK)
+		{
+			BYTE *mem = MemoryBlocks[MemoryBlock] + MemoryUsed;
+			MemoryUsed += size;
+			return mem;
+		}
+		MemoryBlock++;
+		MemoryUsed = 0;
+	}
+	MemoryBlocks.Push (new BYTE[DRAWER_MEMORY_BLOCK]);
+	MemoryUsed = size;
+	return MemoryBlocks[MemoryBlock];
+}
+
+//==========================================================================
+//
+// FDrawerCommandQueue :: AddCommand
+//
+//==========================================================================
+
+FDrawerCommand &FDrawerCommandQueue::AddCommand (int kind)
+{
+	FDrawerCommand &cmd = Commands[Commands.Reserve (1)];
+	cmd.Kind = kind;
+	cmd.State.Save ();
+	return cmd;
+}
+
+//==========================================================================
+//
+// FDrawerCommandQueue :: Queue*
+//
+// Records one drawer call. Anything the drawer would have left behind for
+// the caller (the frac of a single column, vplce for four of them) is
+// worked out here, since the drawer has not actually run yet.
+//
+//==========================================================================
+
+void FDrawerCommandQueue::QueueColumn (void (*func) ())
+{
+	if (dc_count > 0)
+	{
+		AddCommand (DRAWER_Column).Func.Void = func;
+	}
+}
+
+void FDrawerCommandQueue::QueueFuzz (void (*func) ())
+{
+	AddCommand (DRAWER_Fuzz).Func.Void = func;
+}
+
+DWORD FDrawerCommandQueue::QueueLine1 (DWORD (STACK_ARGS *func) ())
+{
+	AddCommand (DRAWER_Line1).Func.Line1 = func;
+	return DWORD(dc_texturefrac) + DWORD(dc_iscale) * dc_count;
+}
+
+fixed_t FDrawerCommandQueue::QueueLine1 (fixed_t (*func) ())
+{
+	AddCommand (DRAWER_TLine1).Func.TLine1 = func;
+	return fixed_t(DWORD(dc_texturefrac) + DWORD(dc_iscale) * dc_count);
+}
+
+void FDrawerCommandQueue::QueueLine4 (void (STACK_ARGS *func) ())
+{
+	AddCommand (DRAWER_Line4).Func.Void = func;
+	for (int i = 0; i < 4; ++i)
+	{
+		vplce[i] += vince[i] * dc_count;
+	}
+}
+
+void FDrawerCommandQueue::QueueSpan (void (*func) ())
+{
+	AddCommand (DRAWER_Span).Func.Void = func;
+}
+
+void FDrawerCommandQueue::QueuePost1 (void (*func) (int, int, int, int), int hx, int sx, int yl, int yh)
+{
+	if (yh < yl)
+	{
+		return;
+	}
+	size_t size = (yh - yl + 1) * 4;
+	BYTE *copy = AllocMemory (size);
+	memcpy (copy, &dc_temp[yl*4], size);
+
+	FDrawerCommand &cmd = AddCommand (DRAWER_Post1);
+	cmd.Func.Post1 = func;
+	cmd.Args[0] = hx;
+	cmd.Args[1] = sx;
+	cmd.Args[2] = yl;
+	cmd.Args[3] = yh;
+	cmd.Dest = copy;
+}
+
+void FDrawerCommandQueue::QueuePost4 (void (STACK_ARGS *func) (int, int, int), int sx, int yl, int yh)
+{
+	if (yh < yl)
+	{
+		return;
+	}
+	size_t size = (yh - yl + 1) * 4;
+	BYTE *copy = AllocMemory (size);
+	memcpy (copy, &dc_temp[yl*4], size);
+
+	FDrawerCommand &cmd = AddCommand (DRAWER_Post4);
+	cmd.Func.Post4 = func;
+	cmd.Args[0] = 0;
+	cmd.Args[1] = sx;
+	cmd.Args[2] = yl;
+	cmd.Args[3] = yh;
+	cmd.Dest = copy;
+}
+
+void FDrawerCommandQueue::QueueSlab (void (STACK_ARGS *func) (int, fixed_t, int, fixed_t, const BYTE *, BYTE *),
+	int dx, fixed_t v, int dy, fixed_t vi, const BYTE *vptr, BYTE *p)
+{
+	if (dy <= 0)
+	{
+		return;
+	}
+	FDrawerCommand &cmd = AddCommand (DRAWER_Slab);
+	cmd.Func.Slab = func;
+	cmd.Args[0] = dx;
+	cmd.Args[1] = v;
+	cmd.Args[2] = dy;
+	cmd.Args[3] = vi;
+	cmd.Data = vptr;
+	cmd.Dest = p;
+}
+
+//==========================================================================
+//
+// FDrawerCommandQueue :: RunSlice
+//
+// Runs every queued command, but only draws the rows of the given slice.
+// Slices are horizontal bands of the view, so no two threads ever write
+// the same pixel. (The fuzz drawer reads the rows next to the one it
+// draws, which may belong to another slice. It only ever reads noise,
+// though, so it does not matter what it gets.)
+//
+//==========================================================================
+
+void FDrawerCommandQueue::RunSlice (int slice)
+{
+#ifdef R_DRAWER_THREADS
+	const int y0 = (slice == 0) ? INT_MIN : slice * Height / NumThreads;
+	const int y1 = (slice == NumThreads - 1) ? INT_MAX : (slice + 1) * Height / NumThreads;
+	int skip, count;
+
+	for (unsigned int i = 0; i < Commands.Size(); ++i)
+	{
+		const FDrawerCommand &cmd = Commands[i];
+		const FDrawerState &state = cmd.State;
+
+		switch (cmd.Kind)
+		{
+		case DRAWER_Column:
+		case DRAWER_Line1:
+		case DRAWER_TLine1:
+		case DRAWER_Line4:
+			if (!ClipRows (int((state.Dest - state.DestOrg) / state.Pitch), state.Count, y0, y1, skip, count))
+			{
+				break;
+			}
+			state.Restore ();
+			dc_dest += skip * dc_pitch;
+			dc_texturefrac = fixed_t(DWORD(dc_texturefrac) + DWORD(dc_iscale) * skip);
+			dc_count = count;
+
+			if (cmd.Kind == DRAWER_Column)
+			{
+				cmd.Func.Void ();
+			}
+			else if (cmd.Kind == DRAWER_Line1)
+			{
+				cmd.Func.Line1 ();
+			}
+			else if (cmd.Kind == DRAWER_TLine1)
+			{
+				cmd.Func.TLine1 ();
+			}
+			else
+			{
+				for (int j = 0; j < 4; ++j)
+				{
+					vplce[j] += vince[j] * skip;
+				}
+				cmd.Func.Void ();
+			}
+			break;
+
+		case DRAWER_Fuzz:
+			if (ClipRows (state.YL, state.YH - state.YL + 1, y0, y1, skip, count))
+			{
+				state.Restore ();
+				dc_yl += skip;
+				dc_yh = dc_yl + count - 1;
+				fuzzpos = (fuzzpos + skip) % FUZZTABLE;
+				cmd.Func.Void ();
+			}
+			break;
+
+		case DRAWER_Span:
+			if (state.SpanY >= y0 && state.SpanY < y1)
+			{
+				state.Restore ();
+				cmd.Func.Void ();
+			}
+			break;
+
+		case DRAWER_Post1:
+		case DRAWER_Post4:
+			if (ClipRows (cmd.Args[2], cmd.Args[3] - cmd.Args[2] + 1, y0, y1, skip, count))
+			{
+				state.Restore ();
+				// The copy only holds the rows that were queued, so it
+				// starts at row yl of dc_temp.
+				dc_temp = cmd.Dest - cmd.Args[2] * 4;
+
+				const int yl = cmd.Args[2] + skip;
+				if (cmd.Kind == DRAWER_Post1)
+				{
+					cmd.Func.Post1 (cmd.Args[0], cmd.Args[1], yl, yl + count - 1);
+				}
+				else
+				{
+					cmd.Func.Post4 (cmd.Args[1], yl, yl + count - 1);
+				}
+			}
+			break;
+
+		case DRAWER_Slab:
+			if (ClipRows (int((cmd.Dest - state.DestOrg) / state.Pitch), cmd.Args[2], y0, y1, skip, count))
+			{
+				state.Restore ();
+				cmd.Func.Slab (cmd.Args[0], fixed_t(DWORD(cmd.Args[1]) + DWORD(cmd.Args[3]) * skip), count, cmd.Args[3],
+					cmd.Data, cmd.Dest + skip * dc_pitch);
+			}
+			break;
+		}
+	}
+#endif
+}
+
+//==========================================================================
+//
+// FDrawerCommandQueue :: WorkerThread
+//
+//==========================================================================
+
+void FDrawerCommandQueue::WorkerThread (int slice)
+{
+#ifdef R_DRAWER_THREADS
+	Executing = true;
+
+	unsigned int generation;
+	{
+		std::lock_guard<std::mutex> lock (Threads->Mutex);
+		generation = Threads->Generation;
+	}
+
+	for (;;)
+	{
+		{
+			std::unique_lock<std::mutex> lock (Threads->Mutex);
+			Threads->Wake.wait (lock, [&] { return Threads->Quit || Threads->Generation != generation; });
+			if (Threads->Quit)
+			{
+				return;
+			}
+			generation = Threads->Generation;
+		}
+
+		RunSlice (slice);
+
+		{
+			std::lock_guard<std::mutex> lock (Threads->Mutex);
+			if (--Threads->Pending == 0)
+			{
+				Threads->Done.notify_one ();
+			}
+		}
+	}
+#endif
+}
+
+//==========================================================================
+//
+// FDrawerCommandQueue :: StartThreads
+//
+//==========================================================================
+
+void FDrawerCommandQueue::StartThreads (int count)
+{
+	static bool registered;
+
+	if (!registered)
+	{
+		registered = true;
+		atterm (StopAllThreads);
+	}
+
+	Threads = new FThreadData;
+
+	// Hold the lock so that no worker can see a generation change before
+	// all of them exist.
+	std::lock_guard<std::mutex> lock (Threads->Mutex);
+	for (int i = 1; i <= count; ++i)
+	{
+		Threads->Workers.push_back (std::thread (&FDrawerCommandQueue::WorkerThread, this, i));
+	}
+}
+
+//==========================================================================
+//
+// FDrawerCommandQueue :: StopThreads
+//
+//==========================================================================
+
+void FDrawerCommandQueue::StopThreads ()
+{
+	if (Threads == NULL)
+	{
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock (Threads->Mutex);
+		Threads->Quit = true;
+	}
+	Threads->Wake.notify_all ();
+	for (size_t i = 0; i < Threads->Workers.size(); ++i)
+	{
+		Threads->Workers[i].join ();
+	}
+	delete Threads;
+	Threads = NULL;
+}
+
+void FDrawerCommandQueue::StopAllThreads ()
+{
+	DrawerQueue.Finish ();
+	DrawerQueue.StopThreads ();
+}
@@ -0,0 +1,225 @@
+//-----------------------------------------------------------------------------
+//
+// Zandronum Source
+// Copyright (C) 2026 Zandronum Development Team
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 3. Neither the name of the Zandronum Development Team nor the names of its
+//    contributors may be used to endorse or promote products derived from this
+//    software without specific prior written permission.
+// 4. Redistributions in any form must be accompanied by information on how to
+//    obtain complete source code for the software and any accompanying
+//    software that uses the software. The source code must either be included
+//    in the distribution or be available for no more than the cost of
+//    distribution plus a nominal fee, and must be freely redistributable
+//    under reasonable conditions. For an executable file, complete source
+//    code means the source code for all modules it contains. It does not
+//    include source code for modules or files that typically accompany the
+//    major components of the operating system on which the executable file
+//    runs.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+//
+// Filename: r_thread.h
+//
+// Description: Queues the software renderer's drawer calls and runs them on several threads.
+//
+//-----------------------------------------------------------------------------
+
+#ifndef __R_THREAD_H__
+#define __R_THREAD_H__
+
+#include "doomtype.h"
+#include "tarray.h"
+#include "m_fixed.h"
+#include "r_draw.h"
+
+//==========================================================================
+//
+// A snapshot of every global the drawers read. Each queued command carries
+// one, and the thread that runs the command loads it into its own copy of
+// the drawer globals first, so the drawers themselves never have to know
+// that they are being run from a queue.
+//
+// Save and Restore live in r_draw.cpp, since some of this is private to it.
+//
+//==========================================================================
+
+struct FDrawerState
+{
+	BYTE			*DestOrg;
+	BYTE			*Dest;
+	const BYTE		*Source;
+	lighttable_t	*Colormap;
+	BYTE			*Translation;
+	DWORD			*SrcBlend;
+	DWORD			*DestBlend;
+	BYTE			*Temp;			// dc_temp, which Post commands replace with their own copy
+	int				Pitch;
+	int				X, YL, YH;
+	int				Count;
+	fixed_t			IScale;
+	fixed_t			TextureMid;
+	fixed_t			TextureFrac;
+	int				Color;
+	DWORD			SrcColor;
+
+	DWORD			VPlce[4];
+	DWORD			VInce[4];
+	BYTE			*PalookupOffse[4];
+	const BYTE		*BufPlce[4];
+
+	const BYTE		*SpanSource;
+	lighttable_t	*SpanColormap;
+	int				SpanColor;
+	int				SpanY, SpanX1, SpanX2;
+	dsfixed_t		SpanXFrac, SpanYFrac;
+	dsfixed_t		SpanXStep, SpanYStep;
+	int				SpanXBits, SpanYBits;
+
+	const BYTE		*SlabColormap;
+	int				VLineBits;
+	int				MVLineBits;
+	int				TMVLineBits;
+	int				FuzzPos;
+
+	void Save ();
+	void Restore () const;
+};
+
+//==========================================================================
+//
+// One recorded drawer call.
+//
+//==========================================================================
+
+enum EDrawerCommand
+{
+	DRAWER_Column,		// void (), draws dc_count rows from dc_dest
+	DRAWER_Fuzz,		// void (), draws dc_yl to dc_yh at dc_x
+	DRAWER_Line1,		// DWORD (), like DRAWER_Column but returns the final frac
+	DRAWER_TLine1,		// fixed_t (), same as above
+	DRAWER_Line4,		// void (), four columns from dc_dest using vplce and vince
+	DRAWER_Span,		// void (), draws row ds_y
+	DRAWER_Post1,		// rt_*1col: one column of dc_temp to the screen
+	DRAWER_Post4,		// rt_*4cols: four columns of dc_temp to the screen
+	DRAWER_Slab,		// voxel slab
+};
+
+struct FDrawerCommand
+{
+	int Kind;
+	union
+	{
+		void (STACK_ARGS *Void) ();
+		DWORD (STACK_ARGS *Line1) ();
+		fixed_t (*TLine1) ();
+		void (*Post1) (int hx, int sx, int yl, int yh);
+		void (STACK_ARGS *Post4) (int sx, int yl, int yh);
+		void (STACK_ARGS *Slab) (int dx, fixed_t v, int dy, fixed_t vi, const BYTE *vptr, BYTE *p);
+	} Func;
+	int Args[4];
+	const BYTE *Data;		// Slab: the voxel column
+	BYTE *Dest;				// Slab: the screen; Post: the copy of dc_temp
+	FDrawerState State;
+};
+
+//==========================================================================
+//
+// FDrawerCommandQueue
+//
+// While the 3D view is being rendered, the C drawers do not touch the
+// screen. They call one of the Queue methods instead, which records the
+// call. When the view is finished (or something has to draw directly to
+// the screen) the queue is flushed: each drawer thread runs every command,
+// clipped to its own horizontal slice of the view.
+//
+// The drawer globals have to be thread-local for this, which the assembly
+// drawers cannot cope with, so builds that use them always draw directly.
+//
+//==========================================================================
+
+class FDrawerCommandQueue
+{
+public:
+	FDrawerCommandQueue ();
+	~FDrawerCommandQueue ();
+
+	void Begin (int height);
+	void Finish ();
+	void Flush ();
+
+	// True if drawer calls on this thread should be queued.
+	bool IsRecording () const
+	{
+#ifdef R_DRAWER_THREADS
+		return Active && !Executing;
+#else
+		return false;
+#endif
+	}
+
+	int GetNumThreads () const { return NumThreads; }
+
+	// Memory that stays valid until the queue is finished.
+	BYTE *AllocMemory (size_t size);
+
+	void QueueColumn (void (*func) ());
+	void QueueFuzz (void (*func) ());
+	DWORD QueueLine1 (DWORD (STACK_ARGS *func) ());
+	fixed_t QueueLine1 (fixed_t (*func) ());
+	void QueueLine4 (void (STACK_ARGS *func) ());
+	void QueueSpan (void (*func) ());
+	void QueuePost1 (void (*func) (int, int, int, int), int hx, int sx, int yl, int yh);
+	void QueuePost4 (void (STACK_ARGS *func) (int, int, int), int sx, int yl, int yh);
+	void QueueSlab (void (STACK_ARGS *func) (int, fixed_t, int, fixed_t, const BYTE *, BYTE *),
+		int dx, fixed_t v, int dy, fixed_t vi, const BYTE *vptr, BYTE *p);
+
+private:
+	FDrawerCommand &AddCommand (int kind);
+	void RunSlice (int slice);
+	void WorkerThread (int slice);
+	void StartThreads (int count);
+	void StopThreads ();
+
+	static void StopAllThreads ();
+
+	TArray<FDrawerCommand> Commands;
+	TArray<BYTE *> MemoryBlocks;
+	unsigned int MemoryBlock;
+	size_t MemoryUsed;
+
+	bool Active;
+	int NumThreads;
+	int Height;
+
+	struct FThreadData;
+	FThreadData *Threads;
+
+#ifdef R_DRAWER_THREADS
+	static thread_local bool Executing;
+#endif
+};
+
+extern FDrawerCommandQueue DrawerQueue;
+
+#endif
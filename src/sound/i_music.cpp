@@ -72,6 +72,10 @@ extern void ChildSigHandler (int signum);
 #include "templates.h"
 #include "stats.h"
 #include "timidity/timidity.h"
+// [ZA] New #includes.
+#include "cmdlib.h"
+#include "oplsynth/opl.h"
+#include "v_text.h"
 
 #define GZIP_ID1		31
 #define GZIP_ID2		139
@@ -97,6 +101,8 @@ extern int MUSHeaderSearch(const BYTE *head, int len);
 
 EXTERN_CVAR (Int, snd_samplerate)
 EXTERN_CVAR (Int, snd_mididevice)
+EXTERN_CVAR (Int, opl_core)		// [ZA]
+EXTERN_CVAR (Bool, opl_batched)	// [ZA]
 
 static bool MusicDown = true;
 
@@ -831,6 +837,245 @@ UNSAFE_CCMD (writewave)
 	}
 }
 
+//==========================================================================
+//
+// [ZA] ReadMusicFileOrLump
+//
+// Loads a file from disk or, failing that, a music lump, for the benchmark
+// commands below.
+//
+//==========================================================================
+
+static bool ReadMusicFileOrLump (const char *name, TArray<BYTE> &data)
+{
+	data.Clear ();
+	if (FileExists (name))
+	{
+		FILE *f = fopen (name, "rb");
+		if (f != NULL)
+		{
+			fseek (f, 0, SEEK_END);
+			data.Resize (ftell (f));
+			fseek (f, 0, SEEK_SET);
+			if (data.Size() == 0 || fread (&data[0], 1, data.Size(), f) != data.Size())
+			{
+				data.Clear ();
+			}
+			fclose (f);
+		}
+	}
+	else
+	{
+		int lump = Wads.CheckNumForFullName (name, true, ns_music);
+		if (lump >= 0)
+		{
+			data.Resize (Wads.LumpLength (lump));
+			Wads.ReadLump (lump, &data[0]);
+		}
+	}
+	return data.Size() != 0;
+}
+
+//==========================================================================
+//
+// [ZA] CCMD timiditybench
+//
+// Renders each MIDI file or music lump through the internal TiMidity to
+// <name>.wav in the current directory and reports how much faster than
+// realtime the synthesizer ran, along with how many voices it mixed for
+// every millisecond of wall time.
+//
+//==========================================================================
+
+UNSAFE_CCMD (timiditybench)
+{
+	if (argv.argc() < 2)
+	{
+		Printf ("Usage: timiditybench <midi file or lump> [...]\n");
+		return;
+	}
+
+	double totaltime = 0, totalaudio = 0, totalvoicems = 0;
+	int songs = 0;
+
+	for (int i = 1; i < argv.argc(); ++i)
+	{
+		TArray<BYTE> data;
+
+		if (!ReadMusicFileOrLump (argv[i], data))
+		{
+			Printf ("%s: could not read file or lump.\n", argv[i]);
+			continue;
+		}
+
+		MusInfo *song = I_RegisterSong (NULL, &data[0], -1, data.Size(), MDEV_GUS);
+		if (song == NULL || !song->IsMIDI())
+		{
+			Printf ("%s: not a MIDI song.\n", argv[i]);
+			delete song;
+			continue;
+		}
+
+		FString outname = ExtractFileBase (argv[i]) + ".wav";
+		MusInfo *dumper = song->GetWaveDumper (outname, 0);
+		if (dumper == NULL)
+		{
+			Printf ("%s: cannot be rendered with TiMidity.\n", argv[i]);
+			delete song;
+			continue;
+		}
+
+		cycle_t rendertime;
+		TimidityWaveWriterMIDIDevice::RenderedSamples = 0;
+		TimidityWaveWriterMIDIDevice::RenderedVoiceSamples = 0;
+		rendertime.Reset ();
+		rendertime.Clock ();
+		dumper->Play (false, 0);
+		delete dumper;
+		rendertime.Unclock ();
+		delete song;
+
+		// Audio length and voice time are both in milliseconds, so dividing
+		// by the wall time gives the realtime factor and voices per ms.
+		const double ms = rendertime.TimeMS ();
+		const double rate = TimidityWaveWriterMIDIDevice::RenderedRate;
+		const QWORD samples = TimidityWaveWriterMIDIDevice::RenderedSamples;
+		const QWORD voices = TimidityWaveWriterMIDIDevice::RenderedVoiceSamples;
+		const double audio = rate > 0 ? samples * 1000. / rate : 0;
+		const double voicems = rate > 0 ? voices * 1000. / rate : 0;
+
+		Printf ("%s: %.1f s of audio in %.1f ms, %.1fx realtime, %.1f voices/ms, %.1f voices avg\n",
+			outname.GetChars(), audio / 1000, ms, ms > 0 ? audio / ms : 0.,
+			ms > 0 ? voicems / ms : 0., samples > 0 ? double(voices) / samples : 0.);
+
+		totaltime += ms;
+		totalaudio += audio;
+		totalvoicems += rate > 0 ? voices * 1000. / rate : 0;
+		++songs;
+	}
+
+	if (songs > 1 && totaltime > 0)
+	{
+		Printf ("Total: %d songs, %.1f s of audio in %.1f ms, %.1fx realtime, %.1f voices/ms\n",
+			songs, totalaudio / 1000, totaltime, totalaudio / totaltime, totalvoicems / totaltime);
+	}
+}
+
+//==========================================================================
+//
+// [ZA] CCMD oplbench
+//
+// Plays each raw OPL capture (as written by writeopl) through the YM3812
+// core twice, once a voice at a time and once batched, and reports how
+// long each took and whether their output matched bit for bit.
+//
+//==========================================================================
+
+static bool RenderOPLCapture (TArray<BYTE> &data, bool batched, TArray<float> &out, double &ms)
+{
+	// The chips are created by the song, and they take their mode from the cvar.
+	const bool oldbatched = opl_batched;
+	opl_batched = batched;
+	OPLmusicFile *music = new OPLmusicFile (NULL, &data[0], data.Size());
+	opl_batched = oldbatched;
+
+	if (!music->IsValid ())
+	{
+		delete music;
+		return false;
+	}
+
+	// Render in the same chunks OPLMUSSong's stream asks for.
+	const int chunk = int(OPL_SAMPLE_RATE / 14);
+	cycle_t rendertime;
+	bool more = true;
+
+	music->SetLooping (false);
+	music->Restart ();
+	out.Clear ();
+	rendertime.Reset ();
+	while (more)
+	{
+		unsigned int pos = out.Reserve (chunk);
+		rendertime.Clock ();
+		more = music->ServiceStream (&out[pos], chunk * sizeof(float));
+		rendertime.Unclock ();
+	}
+	ms = rendertime.TimeMS ();
+	delete music;
+	return true;
+}
+
+UNSAFE_CCMD (oplbench)
+{
+	if (argv.argc() < 2)
+	{
+		Printf ("Usage: oplbench <OPL capture file or lump> [...]\n");
+		return;
+	}
+	if (opl_core != 0)
+	{
+		Printf ("oplbench compares the modes of the YM3812 core, so opl_core must be 0.\n");
+		return;
+	}
+
+	double totalsingle = 0, totalbatched = 0, totalaudio = 0;
+	int songs = 0, mismatches = 0;
+
+	for (int i = 1; i < argv.argc(); ++i)
+	{
+		TArray<BYTE> data;
+		TArray<float> single, batched;
+		double singlems, batchedms;
+
+		if (!ReadMusicFileOrLump (argv[i], data))
+		{
+			Printf ("%s: could not read file or lump.\n", argv[i]);
+			continue;
+		}
+		if (!RenderOPLCapture (data, false, single, singlems) || !RenderOPLCapture (data, true, batched, batchedms))
+		{
+			Printf ("%s: not a raw OPL capture.\n", argv[i]);
+			continue;
+		}
+
+		const double audio = single.Size() * 1000. / OPL_SAMPLE_RATE;
+		Printf ("%s: %.1f s of audio, %.1f ms a voice at a time, %.1f ms batched, %.2fx\n",
+			argv[i], audio / 1000, singlems, batchedms, batchedms > 0 ? singlems / batchedms : 0.);
+
+		// Both renders must be identical down to the last bit.
+		if (single.Size() != batched.Size())
+		{
+			Printf (TEXTCOLOR_RED "%s: batched output has %u samples instead of %u.\n", argv[i], batched.Size(), single.Size());
+			++mismatches;
+		}
+		else for (unsigned int j = 0; j < single.Size(); ++j)
+		{
+			if (memcmp (&single[j], &batched[j], sizeof(float)) != 0)
+			{
+				Printf (TEXTCOLOR_RED "%s: batched output differs at sample %u (%g instead of %g).\n", argv[i], j, batched[j], single[j]);
+				++mismatches;
+				break;
+			}
+		}
+
+		totalsingle += singlems;
+		totalbatched += batchedms;
+		totalaudio += audio;
+		++songs;
+	}
+
+	if (songs > 1 && totalbatched > 0)
+	{
+		Printf ("Total: %d songs, %.1f s of audio, %.1f ms a voice at a time, %.1f ms batched, %.2fx\n",
+			songs, totalaudio / 1000, totalsingle, totalbatched, totalsingle / totalbatched);
+	}
+	if (songs > 0)
+	{
+		Printf ("%d of %d songs rendered identically.\n", songs - mismatches, songs);
+	}
+}
+
 //==========================================================================
 //
 // CCMD writemidi
@@ -24,6 +24,11 @@
 #include "i_sound.h"
 #include "i_music.h"
 #include "s_sound.h"
+// [ZA] New #includes.
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 
 void I_InitMusicWin32 ();
 void I_ShutdownMusicWin32 ();
@@ -221,6 +226,24 @@ protected:
 
 // Base class for software synthesizer MIDI output devices ------------------
 
+// [ZA] Requests from the game thread that must not run while the render
+// thread is synthesizing.
+enum ESynthCommand
+{
+	SYNCMD_Tempo,
+	SYNCMD_TimeDiv,
+	SYNCMD_SettingInt,
+	SYNCMD_SettingNum,
+};
+
+struct FSynthCommand
+{
+	ESynthCommand Type;
+	const char *Setting;	// Must be a string literal; it is used after the call returns.
+	int IntVal;
+	double NumVal;
+};
+
 class SoftSynthMIDIDevice : public MIDIDevice
 {
 public:
@@ -262,6 +285,33 @@ protected:
 	virtual void HandleEvent(int status, int parm1, int parm2) = 0;
 	virtual void HandleLongEvent(const BYTE *data, int len) = 0;
 	virtual void ComputeOutput(float *buffer, int len) = 0;
+
+	// [ZA] Render-ahead. A dedicated thread calls ServiceStream to fill a
+	// single-producer/single-consumer ring, so the sound backend's callback
+	// only has to copy samples out of it.
+	enum { MAX_SYNTH_COMMANDS = 64 };
+
+	std::thread RenderThread;
+	std::mutex RenderMutex;
+	std::condition_variable RenderWake;
+	std::atomic<bool> RenderQuit;
+	std::atomic<bool> RenderEnded;
+	std::atomic<unsigned int> RenderReadPos, RenderWritePos;
+	TArray<float> RenderRing;
+	unsigned int RenderChunk;		// Floats synthesized at a time
+	int ChunkBytes;
+	bool RenderAhead;
+
+	FSynthCommand Commands[MAX_SYNTH_COMMANDS];
+	std::atomic<unsigned int> CommandReadPos, CommandWritePos;
+
+	void StartRenderThread();
+	void StopRenderThread();
+	void RenderLoop();
+	bool ReadRendered(void *buff, int numbytes);
+	bool QueueCommand(ESynthCommand type, const char *setting, int intval, double numval);
+	void RunCommands();
+	virtual void ExecuteCommand(const FSynthCommand &cmd);
 };
 
 // OPL implementation of a MIDI output device -------------------------------
@@ -327,6 +377,12 @@ public:
 	int Resume();
 	void Stop();
 
+	// [ZA] What the wave writers rendered since these were last reset.
+	// Used by timiditybench.
+	static QWORD RenderedSamples;
+	static QWORD RenderedVoiceSamples;
+	static float RenderedRate;
+
 protected:
 	FILE *File;
 };
@@ -572,6 +572,11 @@ int FluidSynthMIDIDevice::LoadPatchSets(const char *patches)
 
 void FluidSynthMIDIDevice::FluidSettingInt(const char *setting, int value)
 {
+	// [ZA] Don't change the synth under the render thread's feet.
+	if (QueueCommand(SYNCMD_SettingInt, setting, value, 0))
+	{
+		return;
+	}
 	if (FluidSynth == NULL || FluidSettings == NULL)
 	{
 		return;
@@ -624,6 +629,10 @@ void FluidSynthMIDIDevice::FluidSettingInt(const char *setting, int value)
 
 void FluidSynthMIDIDevice::FluidSettingNum(const char *setting, double value)
 {
+	if (QueueCommand(SYNCMD_SettingNum, setting, 0, value))
+	{
+		return;
+	}
 	if (FluidSettings != NULL)
 	{
 		if (0 == fluid_settings_setnum(FluidSettings, setting, value))
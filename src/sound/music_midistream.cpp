@@ -315,9 +315,9 @@ void MIDIStreamer::Play(bool looping, int subsong)
 		}
 		else if (devtype == MDEV_GUS)
 		{
-#ifdef USE_TIMIDITY
+			// [ZA] The wave writer is always built, so don't hide it behind
+			// USE_TIMIDITY, which nothing defines. timiditybench needs it.
 			MIDI = new TimidityWaveWriterMIDIDevice(DumpFilename, 0);
-#endif
 		}
 	}
 	else
@@ -21,6 +21,8 @@ CUSTOM_CVAR (Int, opl_numchips, 2, CVAR_ARCHIVE|CVAR_GLOBALCONFIG)
 }
 
 CVAR(Int, opl_core, 0, CVAR_ARCHIVE|CVAR_GLOBALCONFIG)
+// [ZA] Render all YM3812 voices together. The output is identical either way.
+CVAR(Bool, opl_batched, true, CVAR_ARCHIVE|CVAR_GLOBALCONFIG)
 
 OPLMUSSong::OPLMUSSong (FILE *file, BYTE *musiccache, int len)
 {
@@ -55,10 +55,18 @@
 
 // PRIVATE DATA DEFINITIONS ------------------------------------------------
 
+// [ZA] The device whose render thread this is, if any.
+static thread_local SoftSynthMIDIDevice *RenderingDevice;
+
 // PUBLIC DATA DEFINITIONS -------------------------------------------------
 
 CVAR(Bool, synth_watch, false, 0)
 
+// [ZA] How many milliseconds of audio software synths render ahead of the
+// sound backend on their own thread. 0 synthesizes inside the stream
+// callback like before.
+CVAR(Int, snd_midirenderahead, 100, CVAR_ARCHIVE|CVAR_GLOBALCONFIG)
+
 // CODE --------------------------------------------------------------------
 
 //==========================================================================
@@ -75,6 +83,13 @@ SoftSynthMIDIDevice::SoftSynthMIDIDevice()
 	Events = NULL;
 	Started = false;
 	SampleRate = GSnd != NULL ? (int)GSnd->GetOutputRate() : 44100;
+	RenderQuit = false;
+	RenderEnded = false;
+	RenderReadPos = RenderWritePos = 0;
+	RenderChunk = 0;
+	ChunkBytes = 0;
+	RenderAhead = false;
+	CommandReadPos = CommandWritePos = 0;
 }
 
 //==========================================================================
@@ -106,6 +121,7 @@ int SoftSynthMIDIDevice::OpenStream(int chunks, int flags, void (*callback)(unsi
 	{
 		return 2;
 	}
+	ChunkBytes = chunksize;
 
 	Callback = callback;
 	CallbackData = userdata;
@@ -123,6 +139,7 @@ int SoftSynthMIDIDevice::OpenStream(int chunks, int flags, void (*callback)(unsi
 
 void SoftSynthMIDIDevice::Close()
 {
+	StopRenderThread();
 	if (Stream != NULL)
 	{
 		delete Stream;
@@ -161,8 +178,11 @@ int SoftSynthMIDIDevice::GetTechnology() const
 
 int SoftSynthMIDIDevice::SetTempo(int tempo)
 {
-	Tempo = tempo;
-	CalcTickRate();
+	if (!QueueCommand(SYNCMD_Tempo, NULL, tempo, 0))
+	{
+		Tempo = tempo;
+		CalcTickRate();
+	}
 	return 0;
 }
 
@@ -174,8 +194,11 @@ int SoftSynthMIDIDevice::SetTempo(int tempo)
 
 int SoftSynthMIDIDevice::SetTimeDiv(int timediv)
 {
-	Division = timediv;
-	CalcTickRate();
+	if (!QueueCommand(SYNCMD_TimeDiv, NULL, timediv, 0))
+	{
+		Division = timediv;
+		CalcTickRate();
+	}
 	return 0;
 }
 
@@ -203,11 +226,13 @@ int SoftSynthMIDIDevice::Resume()
 {
 	if (!Started)
 	{
+		StartRenderThread();
 		if (Stream->Play(true, 1))
 		{
 			Started = true;
 			return 0;
 		}
+		StopRenderThread();
 		return 1;
 	}
 	return 0;
@@ -226,6 +251,7 @@ void SoftSynthMIDIDevice::Stop()
 		Stream->Stop();
 		Started = false;
 	}
+	StopRenderThread();
 }
 
 //==========================================================================
@@ -449,5 +475,234 @@ bool SoftSynthMIDIDevice::ServiceStream (void *buff, int numbytes)
 bool SoftSynthMIDIDevice::FillStream(SoundStream *stream, void *buff, int len, void *userdata)
 {
 	SoftSynthMIDIDevice *device = (SoftSynthMIDIDevice *)userdata;
+	if (device->RenderAhead)
+	{
+		return device->ReadRendered(buff, len);
+	}
 	return device->ServiceStream(buff, len);
 }
+
+//==========================================================================
+//
+// [ZA] SoftSynthMIDIDevice :: StartRenderThread
+//
+// Sizes the ring for snd_midirenderahead and starts synthesizing into it.
+//
+//==========================================================================
+
+void SoftSynthMIDIDevice::StartRenderThread()
+{
+	if (RenderAhead || snd_midirenderahead <= 0 || ChunkBytes <= 0)
+	{
+		return;
+	}
+
+	RenderChunk = ChunkBytes / sizeof(float);
+
+	// Always leave room for at least two chunks, and round up to a power of
+	// two so positions can wrap with a mask.
+	unsigned int want = MAX<unsigned int>(RenderChunk * 2,
+		unsigned(SampleRate / 1000. * MIN<int>(snd_midirenderahead, 1000) * 2));
+	unsigned int size = 1;
+	while (size < want)
+	{
+		size <<= 1;
+	}
+	RenderRing.Resize(size);
+
+	RenderQuit = false;
+	RenderEnded = false;
+	RenderReadPos = RenderWritePos = 0;
+	RenderAhead = true;
+	RenderThread = std::thread([this]() { RenderLoop(); });
+}
+
+//==========================================================================
+//
+// [ZA] SoftSynthMIDIDevice :: StopRenderThread
+//
+// Must be called before the stream or the synth goes away, since the
+// thread calls back into both.
+//
+//==========================================================================
+
+void SoftSynthMIDIDevice::StopRenderThread()
+{
+	if (!RenderAhead)
+	{
+		return;
+	}
+	RenderQuit = true;
+	RenderWake.notify_one();
+	RenderThread.join();
+	RenderAhead = false;
+
+	// Anything still queued would be lost with the thread, so do it here.
+	RunCommands();
+	RenderReadPos = RenderWritePos = 0;
+}
+
+//==========================================================================
+//
+// [ZA] SoftSynthMIDIDevice :: RenderLoop
+//
+// The producer side of the ring. Synthesizes one stream chunk at a time
+// whenever there is room for it.
+//
+//==========================================================================
+
+void SoftSynthMIDIDevice::RenderLoop()
+{
+	TArray<float> block(RenderChunk);
+	const unsigned int size = RenderRing.Size();
+	const unsigned int mask = size - 1;
+
+	block.Resize(RenderChunk);
+	RenderingDevice = this;
+	while (!RenderQuit)
+	{
+		RunCommands();
+
+		unsigned int write = RenderWritePos.load(std::memory_order_relaxed);
+		unsigned int read = RenderReadPos.load(std::memory_order_acquire);
+
+		if (RenderEnded || size - (write - read) < RenderChunk)
+		{
+			std::unique_lock<std::mutex> lock(RenderMutex);
+			RenderWake.wait_for(lock, std::chrono::milliseconds(5));
+			continue;
+		}
+
+		bool more = ServiceStream(&block[0], RenderChunk * sizeof(float));
+
+		unsigned int start = write & mask;
+		unsigned int first = MIN(RenderChunk, size - start);
+		memcpy(&RenderRing[start], &block[0], first * sizeof(float));
+		memcpy(&RenderRing[0], &block[first], (RenderChunk - first) * sizeof(float));
+		RenderWritePos.store(write + RenderChunk, std::memory_order_release);
+
+		if (!more)
+		{
+			RenderEnded.store(true, std::memory_order_release);
+		}
+	}
+}
+
+//==========================================================================
+//
+// [ZA] SoftSynthMIDIDevice :: ReadRendered
+//
+// The consumer side of the ring, called from the stream callback. Never
+// waits: if the render thread fell behind, the rest is silence. Returns
+// false once the song has ended and everything was played.
+//
+//==========================================================================
+
+bool SoftSynthMIDIDevice::ReadRendered(void *buff, int numbytes)
+{
+	float *samples = (float *)buff;
+	const unsigned int size = RenderRing.Size();
+	const unsigned int mask = size - 1;
+	unsigned int want = numbytes / sizeof(float);
+
+	bool ended = RenderEnded.load(std::memory_order_acquire);
+	unsigned int read = RenderReadPos.load(std::memory_order_relaxed);
+	unsigned int write = RenderWritePos.load(std::memory_order_acquire);
+	unsigned int avail = MIN(want, write - read);
+
+	unsigned int start = read & mask;
+	unsigned int first = MIN(avail, size - start);
+	memcpy(samples, &RenderRing[start], first * sizeof(float));
+	memcpy(samples + first, &RenderRing[0], (avail - first) * sizeof(float));
+	if (avail < want)
+	{
+		memset(samples + avail, 0, (want - avail) * sizeof(float));
+	}
+	RenderReadPos.store(read + avail, std::memory_order_release);
+	RenderWake.notify_one();
+
+	return !ended || read + avail != write;
+}
+
+//==========================================================================
+//
+// [ZA] SoftSynthMIDIDevice :: QueueCommand
+//
+// Hands a state change to the render thread so that it happens between
+// two chunks instead of in the middle of one. Returns false if the caller
+// should just apply it directly: either nothing is rendering ahead, or
+// this is the render thread itself.
+//
+//==========================================================================
+
+bool SoftSynthMIDIDevice::QueueCommand(ESynthCommand type, const char *setting, int intval, double numval)
+{
+	if (!RenderAhead || RenderingDevice == this)
+	{
+		return false;
+	}
+
+	unsigned int write = CommandWritePos.load(std::memory_order_relaxed);
+	while (write - CommandReadPos.load(std::memory_order_acquire) >= MAX_SYNTH_COMMANDS)
+	{
+		RenderWake.notify_one();
+		std::this_thread::yield();
+	}
+
+	FSynthCommand &cmd = Commands[write % MAX_SYNTH_COMMANDS];
+	cmd.Type = type;
+	cmd.Setting = setting;
+	cmd.IntVal = intval;
+	cmd.NumVal = numval;
+	CommandWritePos.store(write + 1, std::memory_order_release);
+	RenderWake.notify_one();
+	return true;
+}
+
+//==========================================================================
+//
+// [ZA] SoftSynthMIDIDevice :: RunCommands
+//
+//==========================================================================
+
+void SoftSynthMIDIDevice::RunCommands()
+{
+	unsigned int read = CommandReadPos.load(std::memory_order_relaxed);
+	unsigned int write = CommandWritePos.load(std::memory_order_acquire);
+
+	for (; read != write; ++read)
+	{
+		ExecuteCommand(Commands[read % MAX_SYNTH_COMMANDS]);
+		CommandReadPos.store(read + 1, std::memory_order_release);
+	}
+}
+
+//==========================================================================
+//
+// [ZA] SoftSynthMIDIDevice :: ExecuteCommand
+//
+// Runs on the render thread, so the setters apply the change directly.
+//
+//==========================================================================
+
+void SoftSynthMIDIDevice::ExecuteCommand(const FSynthCommand &cmd)
+{
+	switch (cmd.Type)
+	{
+	case SYNCMD_Tempo:
+		SetTempo(cmd.IntVal);
+		break;
+
+	case SYNCMD_TimeDiv:
+		SetTimeDiv(cmd.IntVal);
+		break;
+
+	case SYNCMD_SettingInt:
+		FluidSettingInt(cmd.Setting, cmd.IntVal);
+		break;
+
+	case SYNCMD_SettingNum:
+		FluidSettingNum(cmd.Setting, cmd.NumVal);
+		break;
+	}
+}
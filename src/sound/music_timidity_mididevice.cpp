@@ -238,6 +238,11 @@ FString TimidityMIDIDevice::GetStats()
 	return out;
 }
 
+// [ZA]
+QWORD TimidityWaveWriterMIDIDevice::RenderedSamples;
+QWORD TimidityWaveWriterMIDIDevice::RenderedVoiceSamples;
+float TimidityWaveWriterMIDIDevice::RenderedRate;
+
 //==========================================================================
 //
 // TimidityWaveWriterMIDIDevice Constructor
@@ -338,8 +343,13 @@ int TimidityWaveWriterMIDIDevice::Resume()
 {
 	float writebuffer[4096];
 
+	RenderedRate = Renderer->rate;
 	while (ServiceStream(writebuffer, sizeof(writebuffer)))
 	{
+		// [ZA] Keep count for timiditybench.
+		RenderedSamples += sizeof(writebuffer) / (2 * sizeof(float));
+		RenderedVoiceSamples += Renderer->mixed_voice_samples;
+		Renderer->mixed_voice_samples = 0;
 		if (fwrite(writebuffer, sizeof(writebuffer), 1, File) != 1)
 		{
 			Printf("Could not write entire wave file: %s\n", strerror(errno));
@@ -93,6 +93,19 @@ CVAR (Bool, sv_showwarnings, false, CVAR_GLOBALCONFIG|CVAR_ARCHIVE)
 EXTERN_CVAR( Float, sv_aircontrol )
 EXTERN_CVAR( Bool, sv_unlimited_pickup )
 
+//*****************************************************************************
+//	VARIABLES
+
+// [ZA] VoIP frames received during this tic, and the frames each client still needs to
+// be sent. They're relayed all at once by SERVERCOMMANDS_FlushVoIPAudioPackets.
+static TArray<ServerCommands::VoIPAudioFrame> g_VoIPFrames;
+static TArray<unsigned int> g_VoIPFrameQueue[MAXPLAYERS];
+
+// [ZA] How much farther than sv_maxproximityrolloffdist a listener must be before they
+// stop receiving a player's voice. The client's positions lag behind the server's a bit,
+// so this keeps people at the edge of the range from dropping out.
+static const double VOIP_PROXIMITY_CULL_MARGIN = 256.0;
+
 //*****************************************************************************
 //	FUNCTIONS
 
@@ -1302,6 +1315,40 @@ void SERVERCOMMANDS_PrivateSay( ULONG ulSender, ULONG ulReceiver, const char *ps
 	}
 }
 
+//*****************************************************************************
+//
+// [ZA] Checks if a listener is certainly too far away from a player to hear their voice.
+// This mirrors the client's own check for whether a VoIP channel is played in 3D: if
+// it isn't, the voice can be heard from anywhere. The rolloff is linear and silent
+// past sv_maxproximityrolloffdist, so nothing audible is ever left out.
+static bool IsOutOfVoiceChatRange( const ULONG player, const ULONG listener )
+{
+	if (( sv_proximityvoicechat == false ) || ( gamestate != GS_LEVEL ))
+		return false;
+
+	const AActor *talker = players[player].mo;
+
+	if (( players[player].bSpectating ) || ( talker == nullptr ))
+		return false;
+
+	// [ZA] The listener hears through the eyes of whoever they're spying on.
+	const ULONG displayPlayer = SERVER_GetClient( listener )->ulDisplayPlayer;
+	const AActor *eyes = players[listener].mo;
+
+	if (( displayPlayer < MAXPLAYERS ) && ( playeringame[displayPlayer] ) && ( players[displayPlayer].mo != nullptr ))
+		eyes = players[displayPlayer].mo;
+
+	if (( eyes == nullptr ) || ( eyes == talker ))
+		return false;
+
+	const double range = sv_maxproximityrolloffdist + VOIP_PROXIMITY_CULL_MARGIN;
+	const double dx = FIXED2DBL( talker->x ) - FIXED2DBL( eyes->x );
+	const double dy = FIXED2DBL( talker->y ) - FIXED2DBL( eyes->y );
+	const double dz = FIXED2DBL( talker->z ) - FIXED2DBL( eyes->z );
+
+	return ( dx * dx + dy * dy + dz * dz > range * range );
+}
+
 //*****************************************************************************
 //
 void SERVERCOMMANDS_PlayerVoIPAudioPacket( ULONG player, unsigned int frame, unsigned char *data, unsigned int length, ULONG playerExtra, ServerCommandFlags flags )
@@ -1313,11 +1360,8 @@ void SERVERCOMMANDS_PlayerVoIPAudioPacket( ULONG player, unsigned int frame, uns
 	const bool forbidVoiceChatToPlayers = GAMEMODE_IsClientForbiddenToChatToPlayers( player, true );
 	const int transmitFilter = players[player].userinfo.GetVoiceTransmitFilter( );
 
-	BufferParameter audio( data, length );
-	ServerCommands::PlayerVoIPAudioPacket command;
-	command.SetPlayerNumber( player );
-	command.SetFrame( frame );
-	command.SetAudio( audio );
+	// [ZA] The frame is only stored once, no matter how many clients it's relayed to.
+	int frameIndex = -1;
 
 	for ( ClientIterator it( playerExtra, flags ); it.notAtEnd( ); ++it )
 	{
@@ -1355,10 +1399,79 @@ void SERVERCOMMANDS_PlayerVoIPAudioPacket( ULONG player, unsigned int frame, uns
 		if ( SERVER_GetPlayerIgnoreTic( *it, SERVER_GetClient( player )->Address, true ) != 0 )
 			continue;
 
-		command.sendCommandToClients( *it, SVCF_ONLYTHISCLIENT );
+		// [ZA] Don't broadcast to anyone who's too far away to hear this player anyway.
+		if ( IsOutOfVoiceChatRange( player, *it ))
+			continue;
+
+		if ( frameIndex == -1 )
+		{
+			ServerCommands::VoIPAudioFrame audioFrame;
+			audioFrame.playerNumber = player;
+			audioFrame.frame = frame;
+			audioFrame.audio = BufferParameter( data, length );
+
+			frameIndex = g_VoIPFrames.Push( audioFrame );
+		}
+
+		g_VoIPFrameQueue[*it].Push( frameIndex );
 	}
 }
 
+//*****************************************************************************
+//
+// [ZA] Relays the VoIP frames that were received during this tic. If a client has
+// to receive more than one frame, they're all packed into as few commands as possible.
+void SERVERCOMMANDS_FlushVoIPAudioPackets( void )
+{
+	for ( unsigned int client = 0; client < MAXPLAYERS; client++ )
+	{
+		TArray<unsigned int> &queue = g_VoIPFrameQueue[client];
+
+		if (( queue.Size( ) == 0 ) || ( SERVER_IsValidClient( client ) == false ))
+		{
+			queue.Clear( );
+			continue;
+		}
+
+		if ( queue.Size( ) == 1 )
+		{
+			const ServerCommands::VoIPAudioFrame &audioFrame = g_VoIPFrames[queue[0]];
+
+			ServerCommands::PlayerVoIPAudioPacket command;
+			command.SetPlayerNumber( audioFrame.playerNumber );
+			command.SetFrame( audioFrame.frame );
+			command.SetAudio( audioFrame.audio );
+			command.sendCommandToClients( client, SVCF_ONLYTHISCLIENT );
+		}
+		else
+		{
+			ServerCommands::PlayerVoIPAudioFrames command;
+
+			for ( unsigned int i = 0; i < queue.Size( ); i++ )
+			{
+				command.PushToFrames( g_VoIPFrames[queue[i]] );
+
+				// [ZA] If this frame won't fit into a single packet, send out what we
+				// already have and then start another command with this frame.
+				if (( i > 0 ) && ( static_cast<unsigned>( command.BuildNetCommand( ).calcSize( ) + PACKET_HEADER_SIZE ) >= SERVER_GetMaxPacketSize( )))
+				{
+					ServerCommands::VoIPAudioFrame audioFrame;
+					command.PopFromFrames( audioFrame );
+					command.sendCommandToClients( client, SVCF_ONLYTHISCLIENT );
+					command.ClearFrames( );
+					command.PushToFrames( audioFrame );
+				}
+			}
+
+			command.sendCommandToClients( client, SVCF_ONLYTHISCLIENT );
+		}
+
+		queue.Clear( );
+	}
+
+	g_VoIPFrames.Clear( );
+}
+
 //*****************************************************************************
 //
 void SERVERCOMMANDS_PlayerTaunt( ULONG ulPlayer, ULONG ulPlayerExtra, ServerCommandFlags flags )
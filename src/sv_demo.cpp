@@ -0,0 +1,476 @@
+//-----------------------------------------------------------------------------
+//
+// Zandronum Source
+// Copyright (C) 2026 Zandronum Development Team
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 3. Neither the name of the Zandronum Development Team nor the names of its
+//    contributors may be used to endorse or promote products derived from this
+//    software without specific prior written permission.
+// 4. Redistributions in any form must be accompanied by information on how to
+//    obtain complete source code for the software and any accompanying
+//    software that uses the software. The source code must either be included
+//    in the distribution or be available for no more than the cost of
+//    distribution plus a nominal fee, and must be freely redistributable
+//    under reasonable conditions. For an executable file, complete source
+//    code means the source code for all modules it contains. It does not
+//    include source code for modules or files that typically accompany the
+//    major components of the operating system on which the executable file
+//    runs.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+//
+// Filename: sv_demo.cpp
+//
+// Description: Records everything the server sends to its clients into a demo that can be played back like a client demo.
+//
+//-----------------------------------------------------------------------------
+
+#include <time.h>
+#include "c_dispatch.h"
+#include "chunkfile.h"
+#include "cl_demo.h"
+#include "cmdlib.h"
+#include "deathmatch.h"
+#include "doomstat.h"
+#include "g_level.h"
+#include "gamemode.h"
+#include "m_misc.h"
+#include "network.h"
+#include "sv_demo.h"
+#include "sv_main.h"
+#include "network/netcommand.h"
+#include "network/servercommands.h"
+
+//*****************************************************************************
+//	VARIABLES
+
+// Are we recording a demo right now?
+static	bool			g_bRecording = false;
+
+// Was the demo started by sv_demoautorecord?
+static	bool			g_bAutoRecorded = false;
+
+// Is the snapshot of the current level still missing in the demo? Nothing that
+// happens before it can be played back.
+static	bool			g_bSnapshotPending = false;
+
+// Is the snapshot being written right now?
+static	bool			g_bWritingSnapshot = false;
+
+// The player slot that playback uses as its console player. It's chosen among
+// the slots that new clients take last, so that it doesn't collide with anyone.
+static	ULONG			g_ulDemoPlayer = MAXPLAYERS - 1;
+
+// Name of the demo we're recording.
+static	FString			g_DemoName;
+
+// The data collected since the last chunk was handed to the writer.
+static	BYTE			*g_pbDemoBuffer = NULL;
+static	LONG			g_lMaxDemoLength = 0;
+static	BYTESTREAM_s	g_ByteStream;
+
+// Size of everything that was handed to the writer so far.
+static	LONG			g_lDemoBufferOffset = 0;
+
+// Compresses the chunks and writes them to the disk in the background, so that
+// recording doesn't cost the server any time waiting for the disk.
+static	FChunkWriter	g_DemoWriter;
+
+// How many tics were recorded.
+static	unsigned int	g_TicsRecorded = 0;
+
+// A chunk is handed to the writer once at least that much data was collected.
+static	const LONG		DEMO_CHUNK_SIZE = 0x10000;
+
+EXTERN_CVAR( Int, demo_compression )
+
+// Should the server record a demo of every level it plays?
+CVAR( Bool, sv_demoautorecord, false, CVAR_ARCHIVE|CVAR_NOSETBYACS )
+
+// Where automatically recorded demos are put.
+CVAR( String, sv_demopath, "", CVAR_ARCHIVE|CVAR_NOSETBYACS )
+
+//*****************************************************************************
+//	PROTOTYPES
+
+static	void	serverdemo_CheckDemoBuffer( ULONG ulSize );
+static	void	serverdemo_FlushChunk( void );
+static	void	serverdemo_WriteTiccmd( const ticcmd_t &cmd );
+static	void	serverdemo_WriteSnapshot( void );
+static	bool	serverdemo_FindDemoPlayer( void );
+
+//*****************************************************************************
+//	FUNCTIONS
+
+void SERVERDEMO_BeginRecording( const char *pszDemoName )
+{
+	if (( pszDemoName == NULL ) || g_bRecording )
+		return;
+
+	if ( serverdemo_FindDemoPlayer( ) == false )
+	{
+		Printf( "Can't record a demo, there is no free player slot for playback to use.\n" );
+		return;
+	}
+
+	g_DemoName = pszDemoName;
+	FixPathSeperator( g_DemoName );
+	DefaultExtension( g_DemoName, ".cld" );
+
+	if ( g_DemoWriter.Open( g_DemoName.GetChars( )) == false )
+	{
+		Printf( "Couldn't open \"%s\" for recording.\n", g_DemoName.GetChars( ));
+		return;
+	}
+
+	g_bRecording = true;
+	g_bAutoRecorded = false;
+	g_lMaxDemoLength = 0x20000;
+	g_pbDemoBuffer = (BYTE *)M_Malloc( g_lMaxDemoLength );
+	g_lDemoBufferOffset = 0;
+	g_ByteStream.pbStream = g_pbDemoBuffer;
+	g_ByteStream.pbStreamEnd = g_pbDemoBuffer + g_lMaxDemoLength;
+	g_TicsRecorded = 0;
+
+	// Same header as a client demo. There is no userinfo, the demo doesn't belong to a player.
+	CLIENTDEMO_WriteDemoHeader( g_DemoWriter, &g_ByteStream );
+	g_ByteStream.WriteByte( CLD_BODYSTART );
+
+	// Playback needs to know what the level looks like before it can do anything
+	// with the commands. Outside of a level we have to wait for the next one.
+	g_bSnapshotPending = true;
+	if ( gamestate == GS_LEVEL )
+		serverdemo_WriteSnapshot( );
+
+	Printf( "Recording demo \"%s\".\n", g_DemoName.GetChars( ));
+}
+
+//*****************************************************************************
+//
+void SERVERDEMO_FinishRecording( void )
+{
+	BYTESTREAM_s	ByteStream;
+	BYTE			abTrailer[8];
+
+	if ( g_bRecording == false )
+		return;
+
+	// The index is empty, so playback seeks by starting over.
+	serverdemo_CheckDemoBuffer( 5 );
+	g_ByteStream.WriteByte( CLD_DEMOEND );
+	const LONG lKeyframeIndexOffset = g_lDemoBufferOffset + static_cast<LONG>( g_ByteStream.pbStream - g_pbDemoBuffer );
+	g_ByteStream.WriteLong( 0 );
+
+	const LONG lDemoLength = g_lDemoBufferOffset + static_cast<LONG>( g_ByteStream.pbStream - g_pbDemoBuffer );
+	serverdemo_FlushChunk( );
+
+	ByteStream.pbStream = abTrailer;
+	ByteStream.pbStreamEnd = abTrailer + sizeof( abTrailer );
+	ByteStream.WriteLong( lDemoLength );
+	ByteStream.WriteLong( lKeyframeIndexOffset );
+	g_DemoWriter.WriteChunk( abTrailer, sizeof( abTrailer ), CHUNK_TRAILER );
+	g_DemoWriter.Close( );
+
+	M_Free( g_pbDemoBuffer );
+	g_pbDemoBuffer = NULL;
+	g_lDemoBufferOffset = 0;
+	g_bRecording = false;
+	g_bSnapshotPending = false;
+
+	if ( g_DemoWriter.HasFailed( ))
+		Printf( "Failed to write demo \"%s\"!\n", g_DemoName.GetChars( ));
+	else
+		Printf( "Demo \"%s\" successfully recorded (%u tics).\n", g_DemoName.GetChars( ), g_TicsRecorded );
+}
+
+//*****************************************************************************
+//
+bool SERVERDEMO_IsRecording( void )
+{
+	return ( g_bRecording );
+}
+
+//*****************************************************************************
+//
+// Commands to the recorder only come in while it writes the snapshot.
+//
+bool SERVERDEMO_IsRecordingClient( ULONG ulClient )
+{
+	return (( ulClient == SERVERDEMO_RECORDER ) && g_bWritingSnapshot );
+}
+
+//*****************************************************************************
+//
+// Called by NetCommand::sendCommandToClients once for every command, no matter
+// to how many clients it goes.
+//
+void SERVERDEMO_RecordCommand( const BYTE *pbData, ULONG ulSize, ULONG ulPlayerExtra, ServerCommandFlags flags )
+{
+	if (( g_bRecording == false ) || ( ulSize == 0 ))
+		return;
+
+	if ( flags & SVCF_ONLYTHISCLIENT )
+	{
+		if ( SERVERDEMO_IsRecordingClient( ulPlayerExtra ) == false )
+			return;
+	}
+	// Until the snapshot is in the demo, only the snapshot itself may be written.
+	else if ( g_bSnapshotPending && ( g_bWritingSnapshot == false ))
+		return;
+
+	// Commands that exist in two versions, depending on the connection type of the client,
+	// are recorded like the client with the best connection would receive them.
+	if ( flags & SVCF_ONLY_CONNECTIONTYPE_0 )
+		return;
+
+	switch ( pbData[0] )
+	{
+	// The new level is announced through its snapshot instead, and
+	// playback doesn't answer the server anyway.
+	case SVC_MAPNEW:
+	case SVC_MAPAUTHENTICATE:
+
+		return;
+	case SVC_MAPEXIT:
+
+		// Nothing until the next level is of any use.
+		g_bSnapshotPending = true;
+		break;
+	}
+
+	serverdemo_CheckDemoBuffer( ulSize );
+	g_ByteStream.WriteBuffer( pbData, ulSize );
+}
+
+//*****************************************************************************
+//
+// Called at the end of every tic, after the commands of this tic were sent.
+//
+void SERVERDEMO_Tick( void )
+{
+	if (( g_bRecording == false ) || g_bSnapshotPending )
+		return;
+
+	// Store what the players did in this tic, for anyone who wants to look at that later.
+	for ( ULONG ulIdx = 0; ulIdx < MAXPLAYERS; ulIdx++ )
+	{
+		if (( playeringame[ulIdx] == false ) || players[ulIdx].bSpectating )
+			continue;
+
+		serverdemo_CheckDemoBuffer( 15 );
+		g_ByteStream.WriteByte( CLD_PLAYERTICCMD );
+		g_ByteStream.WriteByte( ulIdx );
+		serverdemo_WriteTiccmd( players[ulIdx].cmd );
+	}
+
+	// Playback advances by one tic with every CLD_TICCMD. The demo player doesn't move.
+	ticcmd_t	emptyCmd;
+	memset( &emptyCmd, 0, sizeof( emptyCmd ));
+	serverdemo_CheckDemoBuffer( 14 );
+	g_ByteStream.WriteByte( CLD_TICCMD );
+	serverdemo_WriteTiccmd( emptyCmd );
+	g_TicsRecorded++;
+
+	if (( g_ByteStream.pbStream - g_pbDemoBuffer ) >= DEMO_CHUNK_SIZE )
+		serverdemo_FlushChunk( );
+}
+
+//*****************************************************************************
+//
+// Called after the server loaded a new level.
+//
+void SERVERDEMO_NewLevel( void )
+{
+	// One demo per level when recording automatically.
+	if ( sv_demoautorecord )
+	{
+		if ( g_bRecording && g_bAutoRecorded )
+			SERVERDEMO_FinishRecording( );
+
+		if ( g_bRecording == false )
+		{
+			char		szDate[32];
+			FString		demoName;
+			time_t		clock;
+
+			time( &clock );
+			strftime( szDate, sizeof( szDate ), "%Y%m%d-%H%M%S", localtime( &clock ));
+
+			demoName = *sv_demopath;
+			if (( demoName.Len( ) > 0 ) && ( demoName[demoName.Len( ) - 1] != '/' ) && ( demoName[demoName.Len( ) - 1] != '\\' ))
+				demoName += '/';
+			demoName.AppendFormat( "%s_%s", szDate, level.mapname );
+
+			SERVERDEMO_BeginRecording( demoName.GetChars( ));
+			g_bAutoRecorded = g_bRecording;
+			return;
+		}
+	}
+
+	if ( g_bRecording )
+		serverdemo_WriteSnapshot( );
+}
+
+//*****************************************************************************
+//*****************************************************************************
+//
+static void serverdemo_CheckDemoBuffer( ULONG ulSize )
+{
+	if (( g_ByteStream.pbStream + ulSize ) > g_ByteStream.pbStreamEnd )
+	{
+		const LONG lPosition = static_cast<LONG>( g_ByteStream.pbStream - g_pbDemoBuffer );
+
+		// Give us another 128KB of memory, or more if needed.
+		g_lMaxDemoLength += MAX<LONG>( 0x20000, ulSize );
+		g_pbDemoBuffer = (BYTE *)M_Realloc( g_pbDemoBuffer, g_lMaxDemoLength );
+		g_ByteStream.pbStream = g_pbDemoBuffer + lPosition;
+		g_ByteStream.pbStreamEnd = g_pbDemoBuffer + g_lMaxDemoLength;
+	}
+}
+
+//*****************************************************************************
+//
+static void serverdemo_FlushChunk( void )
+{
+	const LONG lSize = static_cast<LONG>( g_ByteStream.pbStream - g_pbDemoBuffer );
+
+	if ( lSize == 0 )
+		return;
+
+	g_DemoWriter.WriteChunk( g_pbDemoBuffer, lSize, static_cast<EChunkCompression>( *demo_compression ));
+	g_lDemoBufferOffset += lSize;
+	g_ByteStream.pbStream = g_pbDemoBuffer;
+}
+
+//*****************************************************************************
+//
+static void serverdemo_WriteTiccmd( const ticcmd_t &cmd )
+{
+	g_ByteStream.WriteShort( cmd.ucmd.yaw );
+	g_ByteStream.WriteShort( cmd.ucmd.roll );
+	g_ByteStream.WriteShort( cmd.ucmd.pitch );
+	g_ByteStream.WriteByte( cmd.ucmd.buttons );
+	g_ByteStream.WriteShort( cmd.ucmd.upmove );
+	g_ByteStream.WriteShort( cmd.ucmd.forwardmove );
+	g_ByteStream.WriteShort( cmd.ucmd.sidemove );
+}
+
+//*****************************************************************************
+//
+// Writes what a client that connects right now would receive, so that playback
+// can start here.
+//
+static void serverdemo_WriteSnapshot( void )
+{
+	g_bWritingSnapshot = true;
+
+	SERVERCOMMANDS_MapLoad( SERVERDEMO_RECORDER, SVCF_ONLYTHISCLIENT );
+	ServerCommands::BeginSnapshot().sendCommandToClients( SERVERDEMO_RECORDER, SVCF_ONLYTHISCLIENT );
+
+	ServerCommands::SetConsolePlayer consolePlayer;
+	consolePlayer.SetPlayerNumber( g_ulDemoPlayer );
+	consolePlayer.sendCommandToClients( SERVERDEMO_RECORDER, SVCF_ONLYTHISCLIENT );
+
+	SERVERCOMMANDS_SetGameDMFlags( SERVERDEMO_RECORDER, SVCF_ONLYTHISCLIENT );
+	SERVERCOMMANDS_SetGameSkill( SERVERDEMO_RECORDER, SVCF_ONLYTHISCLIENT );
+	SERVERCOMMANDS_SetGameMode( SERVERDEMO_RECORDER, SVCF_ONLYTHISCLIENT );
+	SERVERCOMMANDS_SetGameModeLimits( SERVERDEMO_RECORDER, SVCF_ONLYTHISCLIENT );
+	if ( lastmanstanding || teamlms )
+		SERVERCOMMANDS_SetLMSAllowedWeapons( SERVERDEMO_RECORDER, SVCF_ONLYTHISCLIENT );
+	SERVERCOMMANDS_SetLMSSpectatorSettings( SERVERDEMO_RECORDER, SVCF_ONLYTHISCLIENT );
+	if ( GAMEMODE_GetCurrentFlags() & GMF_USETEAMITEM )
+		SERVERCOMMANDS_SetSimpleCTFSTMode( SERVERDEMO_RECORDER, SVCF_ONLYTHISCLIENT );
+	SERVERCOMMANDS_SetMapMusic( SERVER_GetMapMusic( ), SERVER_GetMapMusicOrder( ), SERVERDEMO_RECORDER, SVCF_ONLYTHISCLIENT );
+
+	SERVER_UpdateLines( SERVERDEMO_RECORDER );
+	SERVER_UpdateSides( SERVERDEMO_RECORDER );
+	SERVER_UpdateSectors( SERVERDEMO_RECORDER );
+	SERVER_UpdateMovers( SERVERDEMO_RECORDER );
+	SERVER_SendFullUpdate( SERVERDEMO_RECORDER );
+
+	ServerCommands::EndSnapshot().sendCommandToClients( SERVERDEMO_RECORDER, SVCF_ONLYTHISCLIENT );
+
+	g_bWritingSnapshot = false;
+	g_bSnapshotPending = false;
+
+	// Playback doesn't have a player of its own, so it has to look through the free spectator.
+	serverdemo_CheckDemoBuffer( 2 );
+	g_ByteStream.WriteByte( CLD_LOCALCOMMAND );
+	g_ByteStream.WriteByte( CLD_LCMD_FREESPECTATE );
+}
+
+//*****************************************************************************
+//
+// Playback uses the highest player slot that no one uses as its console player.
+// New clients get the lowest free slot, so they only end up there on a full server.
+//
+static bool serverdemo_FindDemoPlayer( void )
+{
+	for ( LONG lIdx = MAXPLAYERS - 1; lIdx >= 0; lIdx-- )
+	{
+		if (( playeringame[lIdx] == false ) && ( SERVER_GetClient( lIdx )->State == CLS_FREE ))
+		{
+			g_ulDemoPlayer = lIdx;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+//*****************************************************************************
+//	CONSOLE COMMANDS
+
+CCMD( sv_recorddemo )
+{
+	if ( NETWORK_GetState( ) != NETSTATE_SERVER )
+	{
+		Printf( "Only the server can record a server demo. Use \"record\" on a client.\n" );
+		return;
+	}
+
+	if ( argv.argc( ) < 2 )
+	{
+		Printf( "Usage: sv_recorddemo <demo name>\n" );
+		return;
+	}
+
+	if ( g_bRecording )
+	{
+		Printf( "Already recording \"%s\". Use sv_stopdemo first.\n", g_DemoName.GetChars( ));
+		return;
+	}
+
+	SERVERDEMO_BeginRecording( argv[1] );
+}
+
+CCMD( sv_stopdemo )
+{
+	if ( g_bRecording == false )
+	{
+		Printf( "Not recording a demo.\n" );
+		return;
+	}
+
+	SERVERDEMO_FinishRecording( );
+}
@@ -107,6 +107,7 @@
 #include "survival.h"
 #include "sv_commands.h"
 #include "sv_save.h"
+#include "sv_demo.h"
 #include "sv_rcon.h"
 #include "gamemode.h"
 #include "domination.h"
@@ -122,6 +123,8 @@
 #include "p_conversation.h"
 #include "p_enemy.h"
 #include "network/packetarchive.h"
+#include "network/nettraffic.h"
+#include "sv_schedule.h"
 #include "p_lnspec.h"
 #include "unlagged.h"
 #include "scoreboard.h"
@@ -631,6 +634,9 @@ void SERVER_Destruct( void )
 		g_aClients[ulIdx].SavedPackets.Free();
 	}
 
+	// [ZA] Don't leave a demo without its end.
+	SERVERDEMO_FinishRecording( );
+
 #ifdef CREATE_PACKET_LOG
 	if ( PacketLogFile )
 		fclose( PacketLogFile );
@@ -733,6 +739,9 @@ void SERVER_Tick( void )
 	{
 		//DObject::BeginFrame ();
 
+		// [ZA] Measure how much of the tic the game and the network take.
+		SERVERSCHEDULE_BeginTic( );
+
 		// Recieve packets.
 		SERVER_GetPackets( );
 
@@ -773,7 +782,8 @@ void SERVER_Tick( void )
 		// Update the scoreboard if we have a new second to display.
 		if ( timelimit && (( level.time % TICRATE ) == 0 ) && ( level.time != oldTime ))
 		{
-			SERVERCONSOLE_UpdateScoreboard( );
+			// [ZA] This can wait until there's time for it.
+			SERVERSCHEDULE_Request( SVTASK_SCOREBOARD );
 			oldTime = level.time;
 		}
 
@@ -806,9 +816,18 @@ void SERVER_Tick( void )
 		// Send out player's true position, etc.
 		SERVER_WriteCommands( );
 
+		// [ZA] Relay the VoIP frames received during this tic, bundled per client.
+		SERVERCOMMANDS_FlushVoIPAudioPackets( );
+
 		// Check everyone's PacketBuffer for anything that needs to be sent.
 		SERVER_SendOutPackets( );
 
+		// [ZA] Everything of this tic was sent, so the demo can move on to the next one.
+		SERVERDEMO_Tick( );
+
+		// [ZA] Advance the per-command and per-client traffic history.
+		NETTRAFFIC_Tick( );
+
 		// [BB] Send out sheduled packets, respecting sv_maxpacketspertick.
 		for ( unsigned int i = 0; i < MAXPLAYERS; i++ )
 		{
@@ -818,17 +837,11 @@ void SERVER_Tick( void )
 			SERVER_GetClient ( i )->SavedPackets.Tick ( );
 		}
 
-		// Potentially send an update to the master server.
-		SERVER_MASTER_Tick( );
-
-		// Time out any old RCON sessions.
-		SERVER_RCON_Tick( );
-
-		// Broadcast the server signal so it can be detected on a LAN.
-		SERVER_MASTER_Broadcast( );
-
-		// Potentially re-parse the banfile.
-		SERVERBAN_Tick( );
+		// [ZA] Potentially send an update to the master server, time out any old
+		// RCON sessions, broadcast the server signal so it can be detected on a LAN,
+		// potentially re-parse the banfile and update the server console. All of
+		// this is put off to a later tic if this one already took too long.
+		SERVERSCHEDULE_RunTasks( );
 
 		// Print stats and get out.
 		FStat::PrintStat( );
@@ -882,7 +895,8 @@ void SERVER_Tick( void )
 			g_lCurrentInboundDataTransfer = 0;
 
 			// Update the form.
-			SERVERCONSOLE_UpdateStatistics( );
+			// [ZA] This can wait until there's time for it.
+			SERVERSCHEDULE_Request( SVTASK_STATISTICS );
 		}
 
 		//DObject::EndFrame ();
@@ -977,7 +991,8 @@ void SERVER_SendClientPacket( ULONG ulClient, bool bReliable )
 	pClient->UnreliablePacketBuffer.WriteTo ( TempBuffer.ByteStream );
 
 	// Finally, send the packet, and clear the buffer.
-	NETWORK_LaunchPacket( &TempBuffer, pClient->Address );
+	const LONG lEncodedSize = NETWORK_LaunchPacket( &TempBuffer, pClient->Address );
+	NETTRAFFIC_AddPacketTraffic( ulClient, NETTRAFFIC_UNRELIABLE, TempBuffer.CalcSize( ), lEncodedSize );
 	pClient->UnreliablePacketBuffer.Clear();
 }
 
@@ -2666,14 +2681,18 @@ void SERVER_SendFullUpdate( ULONG ulClient )
 			SERVERCOMMANDS_SetPlayerAccountName( ulIdx, ulClient, SVCF_ONLYTHISCLIENT );
 	}
 
-	// Server may have already picked a team for the incoming player. If so, tell him!
-	if (( GAMEMODE_GetCurrentFlags() & GMF_PLAYERSONTEAMS ) && players[ulClient].bOnTeam )
-		SERVERCOMMANDS_SetPlayerTeam( ulClient, ulClient, SVCF_ONLYTHISCLIENT );
+	// [ZA] A server demo that's being recorded has no player of its own.
+	if ( ulClient < MAXPLAYERS )
+	{
+		// Server may have already picked a team for the incoming player. If so, tell him!
+		if (( GAMEMODE_GetCurrentFlags() & GMF_PLAYERSONTEAMS ) && players[ulClient].bOnTeam )
+			SERVERCOMMANDS_SetPlayerTeam( ulClient, ulClient, SVCF_ONLYTHISCLIENT );
 
-	// [AK] In case this player's already dead, let them know how much time they
-	// have left until they can respawn again.
-	if ( players[ulClient].playerstate == PST_DEAD )
-		SERVERCOMMANDS_SetLocalPlayerRespawnDelayTime( ulClient );
+		// [AK] In case this player's already dead, let them know how much time they
+		// have left until they can respawn again.
+		if ( players[ulClient].playerstate == PST_DEAD )
+			SERVERCOMMANDS_SetLocalPlayerRespawnDelayTime( ulClient );
+	}
 
 	// [BB] This game mode uses teams, so inform the incoming player about the scores/wins/frags of the teams.
 	if ( GAMEMODE_GetCurrentFlags() & GMF_PLAYERSONTEAMS )
@@ -2973,7 +2992,8 @@ void SERVER_SendFullUpdate( ULONG ulClient )
 	// [BB] Let the client know that the full update is completed.
 	SERVERCOMMANDS_FullUpdateCompleted( ulClient );
 	// [BB] The client will let us know that it received the update.
-	SERVER_GetClient ( ulClient )->bFullUpdateIncomplete = true;
+	if ( SERVER_GetClient ( ulClient ) != NULL )
+		SERVER_GetClient ( ulClient )->bFullUpdateIncomplete = true;
 
 	// [AK] Tell the client everything they need to know about custom player values.
 	// This must be done after the client received the full update.
@@ -2987,19 +3007,19 @@ void SERVER_SendFullUpdate( ULONG ulClient )
 			const PlayerValue DefaultVal = pair->Value.GetDefaultValue( );
 
 			// [AK] First, tell them to reset everyone's values to default.
-			SERVERCOMMANDS_ResetCustomPlayerValue( pair->Value, MAXPLAYERS, g_lCurrentClient, SVCF_ONLYTHISCLIENT );
+			SERVERCOMMANDS_ResetCustomPlayerValue( pair->Value, MAXPLAYERS, ulClient, SVCF_ONLYTHISCLIENT );
 
 			for ( ULONG ulIdx = 0; ulIdx < MAXPLAYERS; ulIdx++ )
 			{
 				// [AK] Ignore the client themselves, or invalid players.
-				if (( ulIdx == static_cast<ULONG>( g_lCurrentClient )) || ( PLAYER_IsValidPlayer( ulIdx ) == false ))
+				if (( ulIdx == ulClient ) || ( PLAYER_IsValidPlayer( ulIdx ) == false ))
 					continue;
 
 				// [AK] Don't bother sending out values that are already equal to the default value.
 				if ( pair->Value.GetValue( ulIdx ) == DefaultVal )
 					continue;
 
-				SERVERCOMMANDS_SetCustomPlayerValue( pair->Value, ulIdx, g_lCurrentClient, SVCF_ONLYTHISCLIENT );
+				SERVERCOMMANDS_SetCustomPlayerValue( pair->Value, ulIdx, ulClient, SVCF_ONLYTHISCLIENT );
 			}
 		}
 	}
@@ -3424,7 +3444,8 @@ void SERVER_UpdateSectors( ULONG ulClient )
 	TThinkerIterator<DPhased>		PhasedIterator;
 	DPhased							*pPhased;
 
-	if ( SERVER_IsValidClient( ulClient ) == false )
+	// [ZA] Also update the server demo recorder while it writes its snapshot.
+	if (( SERVER_IsValidClient( ulClient ) == false ) && ( SERVERDEMO_IsRecordingClient( ulClient ) == false ))
 		return;
 
 	// [BB] Set all existing sector links.
@@ -3628,7 +3649,7 @@ void SERVER_UpdateLines( ULONG ulClient )
 {
 	ULONG		ulLine;
 
-	if ( SERVER_IsValidClient( ulClient ) == false )
+	if (( SERVER_IsValidClient( ulClient ) == false ) && ( SERVERDEMO_IsRecordingClient( ulClient ) == false ))
 		return;
 
 	for ( ulLine = 0; ulLine < (ULONG)numlines; ulLine++ )
@@ -3674,7 +3695,7 @@ void SERVER_UpdateSides( ULONG ulClient )
 {
 	ULONG		ulSide;
 
-	if ( SERVER_IsValidClient( ulClient ) == false )
+	if (( SERVER_IsValidClient( ulClient ) == false ) && ( SERVERDEMO_IsRecordingClient( ulClient ) == false ))
 		return;
 
 	for ( ulSide = 0; ulSide < (ULONG)numsides; ulSide++ )
@@ -3693,7 +3714,7 @@ void SERVER_UpdateActorProperties( AActor *pActor, ULONG ulClient )
 	if ( !pActor )
 		return;
 
-	if ( SERVER_IsValidClient( ulClient ) == false )
+	if (( SERVER_IsValidClient( ulClient ) == false ) && ( SERVERDEMO_IsRecordingClient( ulClient ) == false ))
 		return;
 
 	// Update the actor's speed if it's changed.
@@ -3816,6 +3837,9 @@ void SERVER_LoadNewLevel( const char *pszMapName )
 		if ( SERVER_GetClient( ulIdx )->State == CLS_AUTHENTICATED )
 			SERVER_GetClient( ulIdx )->State = CLS_AUTHENTICATED_BUT_OUTDATED_MAP;
 	}
+
+	// [ZA] The demo needs a snapshot of the new level.
+	SERVERDEMO_NewLevel( );
 }
 
 //*****************************************************************************
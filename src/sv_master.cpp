@@ -106,6 +106,10 @@ static	LONG				g_lStoredQueryIPHead;
 static	LONG				g_lStoredQueryIPTail;
 static	TArray<int>			g_OptionalWadIndices;
 
+// [ZA] The gametics of the last master server update and LAN broadcast.
+static	LONG				g_lLastMasterUpdateTic = -1;
+static	LONG				g_lLastBroadcastTic = -1;
+
 extern	NETADDRESS_s		g_LocalAddress;
 
 FString g_VersionWithOS;
@@ -602,9 +606,12 @@ void SERVER_MASTER_Tick( void )
 	}
 
 	// Send an update to the master server every 30 seconds.
-	if ( gametic % ( TICRATE * 30 ))
+	// [ZA] This may run a few tics late, so don't require an exact multiple.
+	if (( g_lLastMasterUpdateTic != -1 ) && ( gametic - g_lLastMasterUpdateTic < TICRATE * 30 ))
 		return;
 
+	g_lLastMasterUpdateTic = gametic;
+
 	// User doesn't wish to update the master server.
 	if ( sv_updatemaster == false )
 		return;
@@ -641,9 +648,12 @@ void SERVER_MASTER_Tick( void )
 void SERVER_MASTER_Broadcast( void )
 {
 	// Send an update to the master server every second.
-	if ( gametic % TICRATE )
+	// [ZA] This may run a few tics late, so don't require an exact multiple.
+	if (( g_lLastBroadcastTic != -1 ) && ( gametic - g_lLastBroadcastTic < TICRATE ))
 		return;
 
+	g_lLastBroadcastTic = gametic;
+
 	// User doesn't wish to broadcast this server.
 	if (( sv_broadcast == false ) || ( Args->CheckParm( "-nobroadcast" )))
 		return;
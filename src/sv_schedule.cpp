@@ -0,0 +1,317 @@
+//-----------------------------------------------------------------------------
+//
+// Zandronum Source
+// Copyright (C) 2026 Zandronum Development Team
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 3. Neither the name of the Zandronum Development Team nor the names of its
+//    contributors may be used to endorse or promote products derived from this
+//    software without specific prior written permission.
+// 4. Redistributions in any form must be accompanied by information on how to
+//    obtain complete source code for the software and any accompanying
+//    software that uses the software. The source code must either be included
+//    in the distribution or be available for no more than the cost of
+//    distribution plus a nominal fee, and must be freely redistributable
+//    under reasonable conditions. For an executable file, complete source
+//    code means the source code for all modules it contains. It does not
+//    include source code for modules or files that typically accompany the
+//    major components of the operating system on which the executable file
+//    runs.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+//
+// Filename: sv_schedule.cpp
+//
+// Description: Runs deferrable server maintenance in the time left over after each tic's game and network work.
+//
+//-----------------------------------------------------------------------------
+
+#include "c_cvars.h"
+#include "c_dispatch.h"
+#include "doomstat.h"
+#include "network.h"
+#include "stats.h"
+#include "sv_ban.h"
+#include "sv_main.h"
+#include "sv_rcon.h"
+#include "sv_schedule.h"
+#include "templates.h"
+
+//*****************************************************************************
+//	DEFINES
+
+#define	NUM_LATENCY_BUCKETS		8
+#define	NUM_TIME_BUCKETS		9
+
+//*****************************************************************************
+//	VARIABLES
+
+struct ServerTask
+{
+	const char		*pszName;
+	void			(*pFunction)( void );
+
+	// Is the task due every tic, or only when it's requested?
+	bool			bEveryTic;
+
+	// Is the task waiting to be run, and since when?
+	bool			bPending;
+	int				DueTic;
+
+	// Statistics since the last reset.
+	unsigned int	NumRuns;
+	unsigned int	NumMerged;	// Times the task became due again while it was still waiting.
+	unsigned int	NumForced;	// Runs past the budget, because the task waited too long.
+	double			TotalMS;
+	double			MaxMS;
+	unsigned int	Latency[NUM_LATENCY_BUCKETS];
+	unsigned int	RunTime[NUM_TIME_BUCKETS];
+};
+
+void	SERVERCONSOLE_UpdateScoreboard( void );
+void	SERVERCONSOLE_UpdateStatistics( void );
+
+// Indexed by SVTASK_e.
+static	ServerTask		g_Tasks[NUM_SVTASKS] =
+{
+	{ "master",		SERVER_MASTER_Tick,					true },
+	{ "broadcast",	SERVER_MASTER_Broadcast,			true },
+	{ "rcon",		SERVER_RCON_Tick,					true },
+	{ "bans",		SERVERBAN_Tick,						true },
+	{ "scoreboard",	SERVERCONSOLE_UpdateScoreboard,		false },
+	{ "statistics",	SERVERCONSOLE_UpdateStatistics,		false },
+};
+
+// Upper bounds of the latency buckets, in tics.
+static	const int		g_LatencyBuckets[NUM_LATENCY_BUCKETS - 1] = { 0, 1, 2, 4, 8, 16, TICRATE };
+
+// Upper bounds of the time buckets, in milliseconds.
+static	const double	g_TimeBuckets[NUM_TIME_BUCKETS - 1] = { 0.05, 0.1, 0.25, 0.5, 1, 2.5, 5, 10 };
+
+// Time spent on the current tic so far.
+static	cycle_t			g_TicCycles;
+
+// How long the game and network part of each tic took.
+static	unsigned int	g_NumTics = 0;
+static	unsigned int	g_NumTicsOverBudget = 0;
+static	unsigned int	g_TicTime[NUM_TIME_BUCKETS];
+
+// How many milliseconds of a tic the server may spend before it puts off maintenance.
+// A tic is about 28.6 ms. 0 runs every task as soon as it's due.
+CVAR( Float, sv_ticbudget, 20.0f, CVAR_ARCHIVE|CVAR_NOSETBYACS )
+
+// Tasks that waited this many tics run even if the tic is over budget.
+CVAR( Int, sv_maxtaskdelay, TICRATE, CVAR_ARCHIVE|CVAR_NOSETBYACS )
+
+//*****************************************************************************
+//	FUNCTIONS
+
+static double serverschedule_GetElapsedMS( void )
+{
+	g_TicCycles.Unclock( );
+	const double elapsed = g_TicCycles.TimeMS( );
+	g_TicCycles.Clock( );
+	return ( elapsed );
+}
+
+//*****************************************************************************
+//
+static unsigned int serverschedule_GetTimeBucket( const double MS )
+{
+	unsigned int i = 0;
+
+	while (( i < NUM_TIME_BUCKETS - 1 ) && ( MS > g_TimeBuckets[i] ))
+		i++;
+
+	return ( i );
+}
+
+//*****************************************************************************
+//
+static unsigned int serverschedule_GetLatencyBucket( const int Tics )
+{
+	unsigned int i = 0;
+
+	while (( i < NUM_LATENCY_BUCKETS - 1 ) && ( Tics > g_LatencyBuckets[i] ))
+		i++;
+
+	return ( i );
+}
+
+//*****************************************************************************
+//
+static ServerTask *serverschedule_FindOldestTask( void )
+{
+	ServerTask *pOldest = NULL;
+
+	for ( unsigned int i = 0; i < NUM_SVTASKS; i++ )
+	{
+		if ( g_Tasks[i].bPending && (( pOldest == NULL ) || ( g_Tasks[i].DueTic < pOldest->DueTic )))
+			pOldest = &g_Tasks[i];
+	}
+
+	return ( pOldest );
+}
+
+//*****************************************************************************
+//
+void SERVERSCHEDULE_BeginTic( void )
+{
+	g_TicCycles.Reset( );
+	g_TicCycles.Clock( );
+}
+
+//*****************************************************************************
+//
+void SERVERSCHEDULE_Request( SVTASK_e Task )
+{
+	if (( Task < 0 ) || ( Task >= NUM_SVTASKS ))
+		return;
+
+	ServerTask &task = g_Tasks[Task];
+
+	// A task that is still waiting is run only once.
+	if ( task.bPending )
+	{
+		task.NumMerged++;
+		return;
+	}
+
+	task.bPending = true;
+	task.DueTic = gametic;
+}
+
+//*****************************************************************************
+//
+// Called after the game and network work of a tic is done. Runs the waiting
+// tasks, the ones that waited longest first, as long as the tic is within
+// sv_ticbudget. The rest waits for a later tic.
+//
+void SERVERSCHEDULE_RunTasks( void )
+{
+	const double budget = sv_ticbudget;
+	const double coreMS = serverschedule_GetElapsedMS( );
+
+	g_NumTics++;
+	g_TicTime[serverschedule_GetTimeBucket( coreMS )]++;
+	if (( budget > 0 ) && ( coreMS > budget ))
+		g_NumTicsOverBudget++;
+
+	for ( unsigned int i = 0; i < NUM_SVTASKS; i++ )
+	{
+		if ( g_Tasks[i].bEveryTic )
+			SERVERSCHEDULE_Request( static_cast<SVTASK_e>( i ));
+	}
+
+	ServerTask *pTask;
+	while (( pTask = serverschedule_FindOldestTask( )) != NULL )
+	{
+		const int waited = gametic - pTask->DueTic;
+		const double startMS = serverschedule_GetElapsedMS( );
+		bool bForced = false;
+
+		if (( budget > 0 ) && ( startMS >= budget ))
+		{
+			// Everything else waited for a shorter time.
+			if ( waited < sv_maxtaskdelay )
+				break;
+
+			bForced = true;
+		}
+
+		pTask->bPending = false;
+		pTask->pFunction( );
+
+		const double runMS = serverschedule_GetElapsedMS( ) - startMS;
+		pTask->NumRuns++;
+		pTask->TotalMS += runMS;
+		pTask->MaxMS = MAX( pTask->MaxMS, runMS );
+		pTask->Latency[serverschedule_GetLatencyBucket( waited )]++;
+		pTask->RunTime[serverschedule_GetTimeBucket( runMS )]++;
+		if ( bForced )
+			pTask->NumForced++;
+	}
+
+	g_TicCycles.Unclock( );
+}
+
+//*****************************************************************************
+//
+static void serverschedule_PrintTimeHistogram( const unsigned int *pulBuckets )
+{
+	FString line = "  ";
+
+	for ( unsigned int i = 0; i < NUM_TIME_BUCKETS; i++ )
+	{
+		if ( i < NUM_TIME_BUCKETS - 1 )
+			line.AppendFormat( "<=%gms: %u ", g_TimeBuckets[i], pulBuckets[i] );
+		else
+			line.AppendFormat( ">%gms: %u", g_TimeBuckets[i - 1], pulBuckets[i] );
+	}
+
+	Printf( "%s\n", line.GetChars( ));
+}
+
+//*****************************************************************************
+//	CONSOLE COMMANDS
+
+CCMD( sv_taskstats )
+{
+	if (( argv.argc( ) > 1 ) && ( stricmp( argv[1], "reset" ) == 0 ))
+	{
+		for ( unsigned int i = 0; i < NUM_SVTASKS; i++ )
+		{
+			ServerTask &task = g_Tasks[i];
+			task.NumRuns = task.NumMerged = task.NumForced = 0;
+			task.TotalMS = task.MaxMS = 0;
+			memset( task.Latency, 0, sizeof( task.Latency ));
+			memset( task.RunTime, 0, sizeof( task.RunTime ));
+		}
+
+		g_NumTics = g_NumTicsOverBudget = 0;
+		memset( g_TicTime, 0, sizeof( g_TicTime ));
+		return;
+	}
+
+	Printf( "%u tics, %u of them over the budget of %g ms before maintenance.\n", g_NumTics, g_NumTicsOverBudget, static_cast<double>( sv_ticbudget ));
+	Printf( "Game and network time per tic:\n" );
+	serverschedule_PrintTimeHistogram( g_TicTime );
+
+	for ( unsigned int i = 0; i < NUM_SVTASKS; i++ )
+	{
+		const ServerTask &task = g_Tasks[i];
+
+		Printf( "%s: %u runs, %u merged, %u forced, %.3f ms average, %.3f ms max%s\n", task.pszName, task.NumRuns, task.NumMerged,
+			task.NumForced, task.NumRuns ? task.TotalMS / task.NumRuns : 0., task.MaxMS, task.bPending ? ", waiting" : "" );
+
+		FString line = "  latency:";
+		for ( unsigned int j = 0; j < NUM_LATENCY_BUCKETS; j++ )
+		{
+			if ( j < NUM_LATENCY_BUCKETS - 1 )
+				line.AppendFormat( " <=%d: %u", g_LatencyBuckets[j], task.Latency[j] );
+			else
+				line.AppendFormat( " >%d: %u", g_LatencyBuckets[j - 1], task.Latency[j] );
+		}
+		Printf( "%s tics\n", line.GetChars( ));
+		serverschedule_PrintTimeHistogram( task.RunTime );
+	}
+}
@@ -159,6 +159,7 @@ public:
 	const BYTE *GetColumn (unsigned int column, const Span **spans_out);
 	const BYTE *GetPixels ();
 	void Unload ();
+	bool CanPrecacheConcurrently (TArray<FTexture *> &parts) { return true; }	// [ZA]
 	FTextureFormat GetFormat ();
 
 protected:
@@ -54,6 +54,7 @@ public:
 	const BYTE *GetColumn (unsigned int column, const Span **spans_out);
 	const BYTE *GetPixels ();
 	void Unload ();
+	bool CanPrecacheConcurrently (TArray<FTexture *> &parts) { return true; }	// [ZA]
 
 protected:
 	BYTE *Pixels;
@@ -165,6 +165,7 @@ public:
 	int GetSourceLump() { return DefinitionLump; }
 	FTexture *GetRedirect(bool wantwarped);
 	FTexture *GetRawTexture();
+	bool CanPrecacheConcurrently (TArray<FTexture *> &parts);	// [ZA]
 
 protected:
 	BYTE *Pixels;
@@ -383,6 +384,35 @@ const BYTE *FMultiPatchTexture::GetPixels ()
 	return Pixels;
 }
 
+//==========================================================================
+//
+// [ZA] FMultiPatchTexture :: CanPrecacheConcurrently
+//
+// Compositing only reads the parts' pixels, unless a part is translucent.
+// Then the whole texture is built in true color, which reads the patch
+// lumps again and has to stay on the main thread.
+//
+//==========================================================================
+
+bool FMultiPatchTexture::CanPrecacheConcurrently (TArray<FTexture *> &parts)
+{
+	for (int i = 0; i < NumParts; ++i)
+	{
+		if (Parts[i].op != OP_COPY)
+		{
+			return false;
+		}
+	}
+	for (int i = 0; i < NumParts; ++i)
+	{
+		if (!Parts[i].Texture->bHasCanvas)
+		{
+			parts.Push (Parts[i].Texture);
+		}
+	}
+	return true;
+}
+
 //==========================================================================
 //
 // FMultiPatchTexture :: GetColumn
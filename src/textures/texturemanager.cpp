@@ -1242,6 +1242,14 @@ void FTextureManager::PrecacheLevel (void)
 	memset (hitlist, 0, cnt);
 
 	screen->GetHitlist(hitlist);
+
+	// [ZA] Build as much as possible on worker threads first. The loop below
+	// then only has to deal with whatever could not be done there.
+	if (Renderer->PrecachesPixels())
+	{
+		PrecacheConcurrently (hitlist);
+	}
+
 	for (int i = cnt - 1; i >= 0; i--)
 	{
 		Renderer->PrecacheTexture(ByIndex(i), hitlist[i]);
@@ -0,0 +1,326 @@
+//-----------------------------------------------------------------------------
+//
+// Zandronum Source
+// Copyright (C) 2026 Zandronum Development Team
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 3. Neither the name of the Zandronum Development Team nor the names of its
+//    contributors may be used to endorse or promote products derived from this
+//    software without specific prior written permission.
+// 4. Redistributions in any form must be accompanied by information on how to
+//    obtain complete source code for the software and any accompanying
+//    software that uses the software. The source code must either be included
+//    in the distribution or be available for no more than the cost of
+//    distribution plus a nominal fee, and must be freely redistributable
+//    under reasonable conditions. For an executable file, complete source
+//    code means the source code for all modules it contains. It does not
+//    include source code for modules or files that typically accompany the
+//    major components of the operating system on which the executable file
+//    runs.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+//
+// Filename: textureprecache.cpp
+//
+// Description: Builds the textures a level needs on worker threads before it starts.
+//
+//-----------------------------------------------------------------------------
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "doomtype.h"
+#include "c_cvars.h"
+#include "i_system.h"
+#include "templates.h"
+#include "stats.h"
+#include "w_wad.h"
+#include "textures/textures.h"
+
+// The most threads the precache will ever use.
+#define MAX_PRECACHE_THREADS	16
+
+// How often the main thread reports progress on long precaches, in ms.
+#define PRECACHE_PROGRESS_INTERVAL	1000
+
+CVAR (Int, r_precachethreads, 0, CVAR_ARCHIVE|CVAR_GLOBALCONFIG)	// 0 = one per CPU core, 1 = no threads
+
+//==========================================================================
+//
+// One texture to build, and whether the renderer wants its spans too.
+//
+//==========================================================================
+
+struct FPrecacheJob
+{
+	FTexture *Texture;
+	bool Spans;
+};
+
+//==========================================================================
+//
+// What the last precache did, for the precache stat.
+//
+//==========================================================================
+
+static struct FPrecacheStats
+{
+	int Threads;
+	unsigned int Lumps;
+	unsigned int Textures;
+	unsigned int Composites;
+	unsigned int Serial;
+	double LumpTime;
+	double TextureTime;
+	double CompositeTime;
+} PrecacheStats;
+
+//==========================================================================
+//
+// QueuePrecacheJob
+//
+// Adds a texture to jobs, unless it is already there. If it is, it is only
+// made to build its spans if this caller needs them.
+//
+//==========================================================================
+
+static void QueuePrecacheJob (TArray<FPrecacheJob> &jobs, TMap<FTexture *, unsigned int> &queued, FTexture *tex, bool spans)
+{
+	unsigned int *index = queued.CheckKey (tex);
+
+	if (index != NULL)
+	{
+		jobs[*index].Spans |= spans;
+	}
+	else
+	{
+		FPrecacheJob job = { tex, spans };
+		queued[tex] = jobs.Push (job);
+	}
+}
+
+//==========================================================================
+//
+// RunPrecacheJobs
+//
+// Builds every texture in jobs, split across the given number of threads.
+// The main thread takes part as well, and reports progress when this takes
+// long enough for the player to wonder what is going on.
+//
+//==========================================================================
+
+static double RunPrecacheJobs (const TArray<FPrecacheJob> &jobs, int numthreads, const char *what)
+{
+	std::atomic<unsigned int> next (0);
+	std::atomic<unsigned int> done (0);
+	std::vector<std::thread> workers;
+	cycle_t time;
+
+	auto runjob = [&jobs, &done] (unsigned int i)
+	{
+		if (jobs[i].Spans)
+		{
+			const FTexture::Span *spans;
+			jobs[i].Texture->GetColumn (0, &spans);
+		}
+		else
+		{
+			jobs[i].Texture->GetPixels ();
+		}
+		++done;
+	};
+
+	time.Reset ();
+	time.Clock ();
+
+	numthreads = MIN<int> (numthreads, jobs.Size());
+	for (int i = 1; i < numthreads; ++i)
+	{
+		workers.push_back (std::thread ([&jobs, &next, &runjob] ()
+		{
+			unsigned int job;
+			while ((job = next++) < jobs.Size())
+			{
+				runjob (job);
+			}
+		}));
+	}
+
+	unsigned int lastreport = I_MSTime ();
+	unsigned int i;
+	while ((i = next++) < jobs.Size())
+	{
+		runjob (i);
+
+		unsigned int now = I_MSTime ();
+		if (now - lastreport >= PRECACHE_PROGRESS_INTERVAL)
+		{
+			Printf ("Precaching %s: %u of %u\n", what, done.load (), jobs.Size());
+			lastreport = now;
+		}
+	}
+
+	for (unsigned int j = 0; j < workers.size(); ++j)
+	{
+		workers[j].join ();
+	}
+
+	time.Unclock ();
+	return time.TimeMS ();
+}
+
+//==========================================================================
+//
+// FTextureManager :: PrecacheConcurrently
+//
+// Builds the paletted pixels (and spans, if hitlist asks for them) of the
+// level's textures on several threads. This happens in two rounds: first
+// every texture that is decoded straight from its own lump, including the
+// patches of multipatch textures, then the multipatch textures themselves,
+// which only copy those patches. Everything else is left to the regular
+// one-at-a-time precache that follows.
+//
+// The worker threads must not share the wad files' FILE handles, so the
+// lumps they need are read in advance and pinned in memory.
+//
+//==========================================================================
+
+void FTextureManager::PrecacheConcurrently (const BYTE *hitlist)
+{
+	int numthreads = r_precachethreads;
+	if (numthreads <= 0)
+	{
+		numthreads = (int)std::thread::hardware_concurrency ();
+	}
+	numthreads = clamp (numthreads, 1, MAX_PRECACHE_THREADS);
+
+	memset (&PrecacheStats, 0, sizeof(PrecacheStats));
+	PrecacheStats.Threads = numthreads;
+	if (numthreads <= 1)
+	{
+		return;
+	}
+
+	TArray<FPrecacheJob> textures, composites;
+	TMap<FTexture *, unsigned int> queued;
+	TArray<FTexture *> parts, subparts;
+
+	for (int i = NumTextures() - 1; i >= 0; i--)
+	{
+		FTexture *tex = ByIndex (i);
+		if (hitlist[i] == 0 || tex == NULL)
+		{
+			continue;
+		}
+
+		parts.Clear ();
+		bool concurrent = tex->CanPrecacheConcurrently (parts);
+
+		// Parts are built in the first round, so they must not have parts of their own.
+		for (unsigned int j = 0; concurrent && j < parts.Size(); ++j)
+		{
+			subparts.Clear ();
+			concurrent = parts[j]->CanPrecacheConcurrently (subparts) && subparts.Size() == 0;
+		}
+		if (!concurrent)
+		{
+			PrecacheStats.Serial++;
+			continue;
+		}
+
+		if (parts.Size() == 0)
+		{
+			QueuePrecacheJob (textures, queued, tex, !!(hitlist[i] & 1));
+		}
+		else
+		{
+			// A part may be used through a redirect, so it needs its spans as well.
+			for (unsigned int j = 0; j < parts.Size(); ++j)
+			{
+				QueuePrecacheJob (textures, queued, parts[j], true);
+			}
+			FPrecacheJob job = { tex, !!(hitlist[i] & 1) };
+			composites.Push (job);
+		}
+	}
+
+	if (textures.Size() == 0)
+	{
+		return;
+	}
+
+	// Read in everything the first round decodes.
+	TMap<int, int> pins;
+	cycle_t lumptime;
+
+	lumptime.Reset ();
+	lumptime.Clock ();
+	for (unsigned int i = 0; i < textures.Size(); ++i)
+	{
+		int lump = textures[i].Texture->SourceLump;
+		if (lump >= 0 && pins.CheckKey (lump) == NULL)
+		{
+			pins[lump] = Wads.PinLump (lump);
+		}
+	}
+	lumptime.Unclock ();
+
+	PrecacheStats.TextureTime = RunPrecacheJobs (textures, numthreads, "textures");
+	if (composites.Size() > 0)
+	{
+		PrecacheStats.CompositeTime = RunPrecacheJobs (composites, numthreads, "composite textures");
+	}
+
+	TMap<int, int>::Iterator it (pins);
+	TMap<int, int>::Pair *pair;
+	while (it.NextPair (pair))
+	{
+		Wads.UnpinLump (pair->Key, pair->Value);
+	}
+
+	PrecacheStats.Lumps = pins.CountUsed ();
+	PrecacheStats.Textures = textures.Size ();
+	PrecacheStats.Composites = composites.Size ();
+	PrecacheStats.LumpTime = lumptime.TimeMS ();
+
+	DPrintf ("Precached %u textures and %u composites on %d threads in %.1f ms\n",
+		PrecacheStats.Textures, PrecacheStats.Composites, numthreads,
+		PrecacheStats.LumpTime + PrecacheStats.TextureTime + PrecacheStats.CompositeTime);
+}
+
+//==========================================================================
+//
+// STAT precache
+//
+//==========================================================================
+
+ADD_STAT (precache)
+{
+	FString out;
+
+	out.Format ("%d threads: %u lumps read in %.1f ms, %u textures in %.1f ms, %u composites in %.1f ms, %u on the main thread",
+		PrecacheStats.Threads, PrecacheStats.Lumps, PrecacheStats.LumpTime,
+		PrecacheStats.Textures, PrecacheStats.TextureTime,
+		PrecacheStats.Composites, PrecacheStats.CompositeTime, PrecacheStats.Serial);
+	return out;
+}
@@ -242,6 +242,10 @@ public:
 	virtual FTexture *GetRawTexture();		// for FMultiPatchTexture to override
 	FTextureID GetID() const { return id; }
 
+	// [ZA] True if GetPixels and GetColumn can run on a precache worker thread.
+	// Any other textures they read are added to parts and must be built first.
+	virtual bool CanPrecacheConcurrently (TArray<FTexture *> &parts) { return false; }
+
 	virtual void Unload () = 0;
 
 	// Returns the native pixel format for this image
@@ -473,6 +477,7 @@ public:
 
 	int NumTextures () const { return (int)Textures.Size(); }
 	void PrecacheLevel (void);
+	void PrecacheConcurrently (const BYTE *hitlist);	// [ZA]
 
 	void WriteTexture (FArchive &arc, int picnum);
 	int ReadTexture (FArchive &arc);
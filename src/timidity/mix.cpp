@@ -29,6 +29,11 @@
 #include "templates.h"
 #include "c_cvars.h"
 
+// [ZA] New #includes.
+#ifdef TIMIDITY_SSE2
+#include <emmintrin.h>
+#endif
+
 EXTERN_CVAR(Bool, midi_timiditylike)
 
 namespace Timidity
@@ -458,13 +463,82 @@ static int update_signal(Voice *v)
 	return 0;
 }
 
+/* [ZA] Inner mixing loops. The amplitude is constant for the whole span,
+   so these can do four samples at a time. Every output sample gets the same
+   single multiply-add as the scalar loop, so the result does not change. */
+static inline void mix_stereo_span(const sample_t *&sp, float *&lp, final_volume_t left, final_volume_t right, int count)
+{
+#ifdef TIMIDITY_SSE2
+	const __m128 vol = _mm_setr_ps(left, right, left, right);
+	for (; count >= 4; count -= 4)
+	{
+		__m128 s = _mm_loadu_ps(sp);
+		_mm_storeu_ps(lp, _mm_add_ps(_mm_loadu_ps(lp), _mm_mul_ps(_mm_unpacklo_ps(s, s), vol)));
+		_mm_storeu_ps(lp + 4, _mm_add_ps(_mm_loadu_ps(lp + 4), _mm_mul_ps(_mm_unpackhi_ps(s, s), vol)));
+		sp += 4;
+		lp += 8;
+	}
+#endif
+	while (count--)
+	{
+		sample_t s = *sp++;
+		lp[0] += left * s;
+		lp[1] += right * s;
+		lp += 2;
+	}
+}
+
+/* Mixes into every other float of lp, i.e. only one side of a stereo buffer. */
+static inline void mix_single_span(const sample_t *&sp, float *&lp, final_volume_t amp, int count)
+{
+#ifdef TIMIDITY_SSE2
+	const __m128 vol = _mm_set1_ps(amp);
+	const __m128 mask = _mm_castsi128_ps(_mm_setr_epi32(-1, 0, -1, 0));
+	// The last float loaded belongs to the other channel and may lie past the
+	// end of the buffer, so always leave at least one sample for the tail.
+	for (; count > 4; count -= 4)
+	{
+		__m128 s = _mm_loadu_ps(sp);
+		__m128 d0 = _mm_loadu_ps(lp);
+		__m128 d1 = _mm_loadu_ps(lp + 4);
+		__m128 m0 = _mm_add_ps(d0, _mm_mul_ps(_mm_unpacklo_ps(s, s), vol));
+		__m128 m1 = _mm_add_ps(d1, _mm_mul_ps(_mm_unpackhi_ps(s, s), vol));
+		_mm_storeu_ps(lp, _mm_or_ps(_mm_and_ps(mask, m0), _mm_andnot_ps(mask, d0)));
+		_mm_storeu_ps(lp + 4, _mm_or_ps(_mm_and_ps(mask, m1), _mm_andnot_ps(mask, d1)));
+		sp += 4;
+		lp += 8;
+	}
+#endif
+	while (count--)
+	{
+		lp[0] += *sp++ * amp;
+		lp += 2;
+	}
+}
+
+static inline void mix_mono_span(const sample_t *&sp, float *&lp, final_volume_t amp, int count)
+{
+#ifdef TIMIDITY_SSE2
+	const __m128 vol = _mm_set1_ps(amp);
+	for (; count >= 4; count -= 4)
+	{
+		_mm_storeu_ps(lp, _mm_add_ps(_mm_loadu_ps(lp), _mm_mul_ps(_mm_loadu_ps(sp), vol)));
+		sp += 4;
+		lp += 4;
+	}
+#endif
+	while (count--)
+	{
+		*lp++ += *sp++ * amp;
+	}
+}
+
 static void mix_mystery_signal(SDWORD control_ratio, const sample_t *sp, float *lp, Voice *v, int count)
 {
 	final_volume_t 
 		left = v->left_mix, 
 		right = v->right_mix;
 	int cc;
-	sample_t s;
 
 	if (!(cc = v->control_counter))
 	{
@@ -481,13 +555,7 @@ static void mix_mystery_signal(SDWORD control_ratio, const sample_t *sp, float *
 		if (cc < count)
 		{
 			count -= cc;
-			while (cc--)
-			{
-				s = *sp++;
-				lp[0] += left * s;
-				lp[1] += right * s;
-				lp += 2;
-			}
+			mix_stereo_span(sp, lp, left, right, cc);
 			cc = control_ratio;
 			if (update_signal(v))
 				return;	/* Envelope ran out */
@@ -497,13 +565,7 @@ static void mix_mystery_signal(SDWORD control_ratio, const sample_t *sp, float *
 		else
 		{
 			v->control_counter = cc - count;
-			while (count--)
-			{
-				s = *sp++;
-				lp[0] += left * s;
-				lp[1] += right * s;
-				lp += 2;
-			}
+			mix_stereo_span(sp, lp, left, right, count);
 			return;
 		}
 	}
@@ -527,11 +589,7 @@ static void mix_single_signal(SDWORD control_ratio, const sample_t *sp, float *l
 		if (cc < count)
 		{
 			count -= cc;
-			while (cc--)
-			{
-				lp[0] += *sp++ * amp;
-				lp += 2;
-			}
+			mix_single_span(sp, lp, amp, cc);
 			cc = control_ratio;
 			if (update_signal(v))
 				return;	/* Envelope ran out */
@@ -540,11 +598,7 @@ static void mix_single_signal(SDWORD control_ratio, const sample_t *sp, float *l
 		else
 		{
 			v->control_counter = cc - count;
-			while (count--)
-			{
-				lp[0] += *sp++ * amp;
-				lp += 2;
-			}
+			mix_single_span(sp, lp, amp, count);
 			return;
 		}
 	}
@@ -579,10 +633,7 @@ static void mix_mono_signal(SDWORD control_ratio, const sample_t *sp, float *lp,
 		if (cc < count)
 		{
 			count -= cc;
-			while (cc--)
-			{
-				*lp++ += *sp++ * left;
-			}
+			mix_mono_span(sp, lp, left, cc);
 			cc = control_ratio;
 			if (update_signal(v))
 				return;	/* Envelope ran out */
@@ -591,10 +642,7 @@ static void mix_mono_signal(SDWORD control_ratio, const sample_t *sp, float *lp,
 		else
 		{
 			v->control_counter = cc - count;
-			while (count--)
-			{
-				*lp++ += *sp++ * left;
-			}
+			mix_mono_span(sp, lp, left, count);
 			return;
 		}
 	}
@@ -605,24 +653,13 @@ static void mix_mystery(SDWORD control_ratio, const sample_t *sp, float *lp, Voi
 	final_volume_t 
 		left = v->left_mix, 
 		right = v->right_mix;
-	sample_t s;
 
-	while (count--)
-	{
-		s = *sp++;
-		lp[0] += s * left;
-		lp[1] += s * right;
-		lp += 2;
-	}
+	mix_stereo_span(sp, lp, left, right, count);
 }
 
 static void mix_single(const sample_t *sp, float *lp, final_volume_t amp, int count)
 {
-	while (count--)
-	{
-		lp[0] += *sp++ * amp;
-		lp += 2;
-	}
+	mix_single_span(sp, lp, amp, count);
 }
 
 static void mix_single_left(const sample_t *sp, float *lp, Voice *v, int count)
@@ -639,10 +676,7 @@ static void mix_mono(const sample_t *sp, float *lp, Voice *v, int count)
 	final_volume_t 
 		left = v->left_mix;
 
-	while (count--)
-	{
-		*lp++ += *sp++ * left;
-	}
+	mix_mono_span(sp, lp, left, count);
 }
 
 /* Ramp a note out in c samples */
@@ -28,6 +28,11 @@
 #include "timidity.h"
 #include "c_cvars.h"
 
+// [ZA] New #includes.
+#ifdef TIMIDITY_SSE2
+#include <emmintrin.h>
+#endif
+
 EXTERN_CVAR(Bool, midi_timiditylike)
 
 namespace Timidity
@@ -41,6 +46,40 @@ namespace Timidity
 #define FINALINTERP if (ofs == le) *dest++ = src[ofs >> FRACTION_BITS];
 /* So it isn't interpolation. At least it's final. */
 
+/* [ZA] Resamples count samples with a fixed increment and returns the new
+   offset. The SSE2 path produces exactly the same output as RESAMPLATION. */
+static inline int resample_span(sample_t *&dest, const sample_t *src, int ofs, int incr, int count)
+{
+#ifdef TIMIDITY_SSE2
+	if (count >= 4)
+	{
+		const __m128i step = _mm_set1_epi32(incr * 4);
+		const __m128i fracmask = _mm_set1_epi32(FRACTION_MASK);
+		const __m128 fracscale = _mm_set1_ps(1.f / (1 << FRACTION_BITS));
+		__m128i vofs = _mm_setr_epi32(ofs, ofs + incr, ofs + incr * 2, ofs + incr * 3);
+		int o[4];
+
+		for (; count >= 4; count -= 4)
+		{
+			_mm_storeu_si128((__m128i *)o, _mm_srai_epi32(vofs, FRACTION_BITS));
+			__m128 s0 = _mm_setr_ps(src[o[0]], src[o[1]], src[o[2]], src[o[3]]);
+			__m128 s1 = _mm_setr_ps(src[o[0] + 1], src[o[1] + 1], src[o[2] + 1], src[o[3] + 1]);
+			__m128 frac = _mm_cvtepi32_ps(_mm_and_si128(vofs, fracmask));
+			_mm_storeu_ps(dest, _mm_add_ps(s0, _mm_mul_ps(_mm_mul_ps(_mm_sub_ps(s1, s0), frac), fracscale)));
+			dest += 4;
+			vofs = _mm_add_epi32(vofs, step);
+		}
+		ofs = _mm_cvtsi128_si32(vofs);
+	}
+#endif
+	while (count--)
+	{
+		RESAMPLATION;
+		ofs += incr;
+	}
+	return ofs;
+}
+
 /*************** resampling with fixed increment *****************/
 
 static sample_t *rs_plain(sample_t *resample_buffer, Voice *v, int *countptr)
@@ -75,11 +114,7 @@ static sample_t *rs_plain(sample_t *resample_buffer, Voice *v, int *countptr)
 		count -= i;
 	}
 
-	while (i--) 
-	{
-		RESAMPLATION;
-		ofs += incr;
-	}
+	ofs = resample_span(dest, src, ofs, incr, i);
 
 	if (ofs >= le) 
 	{
@@ -124,11 +159,7 @@ static sample_t *rs_loop(sample_t *resample_buffer, Voice *vp, int count)
 		{
 			count -= i;
 		}
-		while (i--) 
-		{
-			RESAMPLATION;
-			ofs += incr;
-		}
+		ofs = resample_span(dest, src, ofs, incr, i);
 	}
 
 	vp->sample_offset=ofs; /* Update offset */
@@ -168,11 +199,7 @@ static sample_t *rs_bidir(sample_t *resample_buffer, Voice *vp, int count)
 		{
 			count -= i;
 		}
-		while (i--) 
-		{
-			RESAMPLATION;
-			ofs += incr;
-		}
+		ofs = resample_span(dest, src, ofs, incr, i);
 	}
 
 	/* Then do the bidirectional looping */
@@ -190,11 +217,7 @@ static sample_t *rs_bidir(sample_t *resample_buffer, Voice *vp, int count)
 		{
 			count -= i;
 		}
-		while (i--) 
-		{
-			RESAMPLATION;
-			ofs += incr;
-		}
+		ofs = resample_span(dest, src, ofs, incr, i);
 		if (ofs >= le) 
 		{
 			/* fold the overshoot back in */
@@ -363,11 +386,7 @@ static sample_t *rs_vib_loop(sample_t *resample_buffer, float rate, Voice *vp, i
 			cc -= i;
 		}
 		count -= i;
-		while (i--) 
-		{
-			RESAMPLATION;
-			ofs += incr;
-		}
+		ofs = resample_span(dest, src, ofs, incr, i);
 		if (vibflag) 
 		{
 			cc = vp->vibrato_control_ratio;
@@ -421,11 +440,7 @@ static sample_t *rs_vib_bidir(sample_t *resample_buffer, float rate, Voice *vp,
 			cc -= i;
 		}
 		count -= i;
-		while (i--) 
-		{
-			RESAMPLATION;
-			ofs += incr;
-		}
+		ofs = resample_span(dest, src, ofs, incr, i);
 		if (vibflag) 
 		{
 			cc = vp->vibrato_control_ratio;
@@ -454,11 +469,7 @@ static sample_t *rs_vib_bidir(sample_t *resample_buffer, float rate, Voice *vp,
 			cc -= i;
 		}
 		count -= i;
-		while (i--) 
-		{
-			RESAMPLATION;
-			ofs += incr;
-		}
+		ofs = resample_span(dest, src, ofs, incr, i);
 		if (vibflag) 
 		{
 			cc = vp->vibrato_control_ratio;
@@ -699,6 +699,7 @@ Renderer::Renderer(float sample_rate)
 
 	lost_notes = 0;
 	cut_notes = 0;
+	mixed_voice_samples = 0;
 
 	default_instrument = NULL;
 	default_program = DEFAULT_PROGRAM;
@@ -741,6 +742,7 @@ void Renderer::ComputeOutput(float *buffer, int count)
 	{
 		if (v->status & VOICE_RUNNING)
 		{
+			mixed_voice_samples += count;
 			mix_voice(this, buffer, v, count);
 		}
 	}
@@ -98,6 +98,12 @@ typedef float sample_t;
 typedef float final_volume_t;
 #define FINAL_VOLUME(v)				(v)
 
+// [ZA] SSE2 is always available on x64, so the resampler and mixer can
+// process four samples at a time there.
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define TIMIDITY_SSE2
+#endif
+
 #define FSCALE(a,b)					((a) * (float)(1<<(b)))
 #define FSCALENEG(a,b)				((a) * (1.0L / (float)(1<<(b))))
 
@@ -646,6 +652,7 @@ struct Renderer
 	int adjust_panning_immediately;
 	int voices;
 	int lost_notes, cut_notes;
+	QWORD mixed_voice_samples;	// [ZA] Running voices times samples, for benchmarking.
 
 	Renderer(float sample_rate);
 	~Renderer();
@@ -1195,6 +1195,57 @@ FWadLump *FWadCollection::ReopenLumpNum (int lump)
 	return new FWadLump(LumpInfo[lump].lump, true);
 }
 
+//==========================================================================
+//
+// [ZA] PinLump
+//
+// Caches the lump and freezes its reference count at -1, the value used
+// for lumps that always stay in memory. FWadLumps opened on it then read
+// from the cache and never touch the reference count or the shared file,
+// which makes them safe to use from several threads.
+//
+//==========================================================================
+
+int FWadCollection::PinLump (int lump)
+{
+	if ((unsigned)lump >= (unsigned)LumpInfo.Size())
+	{
+		return 0;
+	}
+
+	FResourceLump *res = LumpInfo[lump].lump;
+	if (res->LumpSize <= 0)
+	{
+		return 0;
+	}
+	res->CacheLump ();
+	int refs = res->RefCount;
+	res->RefCount = -1;
+	return refs;
+}
+
+//==========================================================================
+//
+// [ZA] UnpinLump
+//
+//==========================================================================
+
+void FWadCollection::UnpinLump (int lump, int pin)
+{
+	if ((unsigned)lump >= (unsigned)LumpInfo.Size())
+	{
+		return;
+	}
+
+	FResourceLump *res = LumpInfo[lump].lump;
+	if (res->LumpSize <= 0)
+	{
+		return;
+	}
+	res->RefCount = pin;
+	res->ReleaseCache ();
+}
+
 //==========================================================================
 //
 // GetFileReader
@@ -1520,9 +1571,11 @@ FWadLump & FWadLump::operator= (const FWadLump &copy)
 FWadLump::FWadLump(FResourceLump *lump, bool alwayscache)
 : FileReader()
 {
-	FileReader *f = lump->GetReader();
+	// [ZA] A lump that is already cached is read from memory. Don't even ask for
+	// its reader then, since that seeks the shared file. See PinLump.
+	FileReader *f = (lump->Cache == NULL && !alwayscache) ? lump->GetReader() : NULL;
 
-	if (f != NULL && f->GetFile() != NULL && !alwayscache)
+	if (f != NULL && f->GetFile() != NULL)
 	{
 		// Uncompressed lump in a file
 		File = f->GetFile();
@@ -180,6 +180,12 @@ public:
 	FWadLump OpenLumpNum (int lump);
 	FWadLump OpenLumpName (const char *name) { return OpenLumpNum (GetNumForName (name)); }
 	FWadLump *ReopenLumpNum (int lump);	// Opens a new, independent FILE
+
+	// [ZA] Keeps a lump in memory, so that several threads can read it at once
+	// through OpenLumpNum and ReadLump, until it is unpinned again. PinLump
+	// returns what has to be passed back to UnpinLump.
+	int PinLump (int lump);
+	void UnpinLump (int lump, int pin);
 	
 	FileReader * GetFileReader(int wadnum);	// Gets a FileReader object to the entire WAD
 
@@ -35,16 +35,45 @@ void DumpCPUInfo(const CPUInfo *cpu)
 						 "xchgl\t%%ebx, %1\n\t" \
 		: "=a" ((output)[0]), "=r" ((output)[1]), "=c" ((output)[2]), "=d" ((output)[3]) \
 		: "a" (func));
+#define __cpuidex(output, func, subfunc) \
+	__asm__ __volatile__("xchgl\t%%ebx, %1\n\t" \
+						 "cpuid\n\t" \
+						 "xchgl\t%%ebx, %1\n\t" \
+		: "=a" ((output)[0]), "=r" ((output)[1]), "=c" ((output)[2]), "=d" ((output)[3]) \
+		: "a" (func), "c" (subfunc));
 #else
 #define __cpuid(output, func) __asm__ __volatile__("cpuid" : "=a" ((output)[0]),\
 	"=b" ((output)[1]), "=c" ((output)[2]), "=d" ((output)[3]) : "a" (func));
+#define __cpuidex(output, func, subfunc) __asm__ __volatile__("cpuid" : "=a" ((output)[0]),\
+	"=b" ((output)[1]), "=c" ((output)[2]), "=d" ((output)[3]) : "a" (func), "c" (subfunc));
 #endif
 #endif
 
+//==========================================================================
+//
+// GetXCR0
+//
+// [ZA] Returns which register sets the OS saves on a context switch.
+// Only call this if CPUID says OSXSAVE is supported.
+//
+//==========================================================================
+
+static QWORD GetXCR0()
+{
+#ifdef _MSC_VER
+	return _xgetbv(0);
+#else
+	DWORD eax, edx;
+	__asm__ __volatile__("xgetbv" : "=a" (eax), "=d" (edx) : "c" (0));
+	return ((QWORD)edx << 32) | eax;
+#endif
+}
+
 void CheckCPUID(CPUInfo *cpu)
 {
 	int foo[4];
 	unsigned int maxext;
+	unsigned int maxbasic;
 
 	memset(cpu, 0, sizeof(*cpu));
 
@@ -96,6 +125,7 @@ haveid:
 
 	// Get vendor ID
 	__cpuid(foo, 0);
+	maxbasic = (unsigned int)foo[0];
 	cpu->dwVendorID[0] = foo[1];
 	cpu->dwVendorID[1] = foo[3];
 	cpu->dwVendorID[2] = foo[2];
@@ -112,6 +142,19 @@ haveid:
 	cpu->FeatureFlags[1] = foo[2];	// Store extended feature flags
 	cpu->FeatureFlags[2] = foo[3];	// Store feature flags
 
+	// [ZA] AVX is only usable if the OS saves the YMM registers, which
+	// XCR0 bits 1 and 2 tell us.
+	if ((foo[2] & (1 << 27)) && (foo[2] & (1 << 28)) && (GetXCR0() & 6) == 6)
+	{
+		cpu->bAVX = true;
+		if (maxbasic >= 7)
+		{
+			int ext[4];
+			__cpuidex(ext, 7, 0);
+			cpu->bAVX2 = (ext[1] & (1 << 5)) != 0;
+		}
+	}
+
 	// If CLFLUSH instruction is supported, get the real cache line size.
 	if (foo[3] & (1 << 19))
 	{
@@ -221,6 +264,8 @@ void DumpCPUInfo(const CPUInfo *cpu)
 		if (cpu->bSSSE3)		Printf(" SSSE3");
 		if (cpu->bSSE41)		Printf(" SSE4.1");
 		if (cpu->bSSE42)		Printf(" SSE4.2");
+		if (cpu->bAVX)			Printf(" AVX");
+		if (cpu->bAVX2)			Printf(" AVX2");
 		if (cpu->b3DNow)		Printf(" 3DNow!");
 		if (cpu->b3DNowPlus)	Printf(" 3DNow!+");
 		Printf ("\n");
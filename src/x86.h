@@ -3,7 +3,7 @@
 
 #include "basictypes.h"
 
-struct CPUInfo	// 92 bytes
+struct CPUInfo	// 96 bytes
 {
 	union
 	{
@@ -97,6 +97,10 @@ struct CPUInfo	// 92 bytes
 		};
 		uint32 AMD_DataL1Info;
 	};
+
+	// [ZA] Only set when the OS also saves the AVX registers.
+	BYTE bAVX;
+	BYTE bAVX2;
 };
 
 